@@ -0,0 +1,39 @@
+#!/bin/sh
+# Replays each bench/*.txt input sequence through wiirtc-sim, collects the per-sequence
+# JSON into one results.json and fails if any sequence breaks bench/thresholds.txt.
+#
+# Usage: run.sh <output directory>   (run from host/, after building wiirtc-sim)
+
+OUT=${1:-build/bench}
+mkdir -p "$OUT"
+
+status=0
+first=1
+printf '[\n' > "$OUT/results.json"
+
+for seq in bench/*.txt; do
+	name=$(basename "$seq" .txt)
+	case "$name" in thresholds | memory-budget) continue ;; esac
+
+	./wiirtc-sim --script "$seq" --name "$name" --json "$OUT/$name.json" \
+		--thresholds bench/thresholds.txt > "$OUT/$name.screen" 2> "$OUT/$name.log"
+	rc=$?
+
+	if [ $rc -eq 0 ]; then
+		echo "PASS $name"
+	else
+		echo "FAIL $name (exit $rc)"
+		grep '^\[' "$OUT/$name.log"
+		status=1
+	fi
+
+	if [ -f "$OUT/$name.json" ]; then
+		[ $first -eq 1 ] || printf ',\n' >> "$OUT/results.json"
+		cat "$OUT/$name.json" >> "$OUT/results.json"
+		first=0
+	fi
+done
+
+printf ']\n' >> "$OUT/results.json"
+echo "Results in $OUT/results.json"
+exit $status
@@ -0,0 +1,18 @@
+#ifndef __FAT_H__
+#define __FAT_H__
+
+/* Host stand-in for libfat. "sd:/" paths are redirected to a host directory by sim/sd.c */
+
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+bool fatInitDefault(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
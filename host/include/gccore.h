@@ -0,0 +1,21 @@
+#ifndef __GCCORE_H__
+#define __GCCORE_H__
+
+/* Host stand-in for libogc's gccore.h, covering what wiirtc uses */
+
+#include <gctypes.h>
+#include <gcutil.h>
+
+#include <ogc/cond.h>
+#include <ogc/consol.h>
+#include <ogc/es.h>
+#include <ogc/ipc.h>
+#include <ogc/isfs.h>
+#include <ogc/lwp.h>
+#include <ogc/lwp_watchdog.h>
+#include <ogc/mutex.h>
+#include <ogc/pad.h>
+#include <ogc/system.h>
+#include <ogc/video.h>
+
+#endif
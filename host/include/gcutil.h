@@ -0,0 +1,9 @@
+#ifndef __GCUTIL_H__
+#define __GCUTIL_H__
+
+/* Host stand-in for libogc's gcutil.h */
+
+#define ATTRIBUTE_ALIGN(v) __attribute__((aligned(v)))
+#define ATTRIBUTE_PACKED __attribute__((packed))
+
+#endif
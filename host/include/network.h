@@ -0,0 +1,75 @@
+#ifndef __NETWORK_H__
+#define __NETWORK_H__
+
+/* Host stand-in for libogc's network.h, covering the UDP calls wiirtc uses. The simulated
+   network behind them is in sim/net.c. Like the console, addresses and ports are kept in
+   network order, which is the only order there is on the Wii, so htons and friends do nothing. */
+
+#include <gctypes.h>
+
+#define AF_INET 2
+#define PF_INET AF_INET
+#define SOCK_DGRAM 2
+#define IPPROTO_UDP 17
+#define INADDR_ANY 0
+
+#define POLLIN 0x0001
+
+#define htons(x) (x)
+#define ntohs(x) (x)
+#define htonl(x) (x)
+#define ntohl(x) (x)
+
+typedef u32 socklen_t;
+
+struct in_addr {
+	u32 s_addr;
+};
+
+struct sockaddr_in {
+	u8 sin_len;
+	u8 sin_family;
+	u16 sin_port;
+	struct in_addr sin_addr;
+	s8 sin_zero[8];
+};
+
+struct sockaddr {
+	u8 sa_len;
+	u8 sa_family;
+	u8 sa_data[14];
+};
+
+struct hostent {
+	char *h_name;
+	char **h_aliases;
+	u16 h_addrtype;
+	u16 h_length;
+	char **h_addr_list;
+};
+
+struct pollsd {
+	s32 socket;
+	u32 events;
+	u32 revents;
+};
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+s32 net_init(void);
+void net_deinit(void);
+struct hostent *net_gethostbyname(const char *addrString);
+s32 inet_aton(const char *cp, struct in_addr *addr);
+s32 net_socket(u32 domain, u32 type, u32 protocol);
+s32 net_close(s32 s);
+s32 net_sendto(s32 s, const void *data, s32 len, u32 flags, struct sockaddr *to, socklen_t tolen);
+s32 net_recvfrom(s32 s, void *mem, s32 len, u32 flags, struct sockaddr *from, socklen_t *fromlen);
+s32 net_poll(struct pollsd *sds, s32 nsds, s32 timeout);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
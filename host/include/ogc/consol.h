@@ -0,0 +1,16 @@
+#ifndef __CONSOL_H__
+#define __CONSOL_H__
+
+#include <gctypes.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void console_init(void *framebuffer, int xstart, int ystart, int xres, int yres, int stride);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
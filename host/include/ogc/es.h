@@ -0,0 +1,16 @@
+#ifndef __ES_H__
+#define __ES_H__
+
+#include <gctypes.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+s32 ES_GetTitleID(u64 *titleID);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
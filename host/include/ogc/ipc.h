@@ -0,0 +1,39 @@
+#ifndef __IPC_H__
+#define __IPC_H__
+
+#include <gctypes.h>
+
+#define IPC_OK 0
+#define IPC_EINVAL -4
+#define IPC_ENOHEAP -5
+#define IPC_ENOENT -6
+#define IPC_EQUEUEFULL -8
+#define IPC_ENOMEM -22
+
+#define IPC_OPEN_NONE 0
+#define IPC_OPEN_READ 1
+#define IPC_OPEN_WRITE 2
+#define IPC_OPEN_RW (IPC_OPEN_READ | IPC_OPEN_WRITE)
+
+typedef s32 (*ipccallback)(s32 result, void *usrdata);
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+s32 IOS_Open(const char *filepath, u32 mode);
+s32 IOS_Close(s32 fd);
+s32 IOS_Seek(s32 fd, s32 where, s32 whence);
+s32 IOS_Read(s32 fd, void *buf, s32 len);
+s32 IOS_Write(s32 fd, const void *buf, s32 len);
+
+// The callback runs from the IPC interrupt once IOS has answered
+s32 IOS_OpenAsync(const char *filepath, u32 mode, ipccallback ipc_cb, void *usrdata);
+s32 IOS_CloseAsync(s32 fd, ipccallback ipc_cb, void *usrdata);
+s32 IOS_ReadAsync(s32 fd, void *buf, s32 len, ipccallback ipc_cb, void *usrdata);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
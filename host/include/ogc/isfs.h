@@ -0,0 +1,24 @@
+#ifndef __ISFS_H__
+#define __ISFS_H__
+
+#include <gctypes.h>
+
+#define ISFS_OK 0
+#define ISFS_ENOMEM -22
+#define ISFS_EINVAL -101
+
+#define ISFS_OPEN_READ 1
+#define ISFS_OPEN_WRITE 2
+#define ISFS_OPEN_RW (ISFS_OPEN_READ | ISFS_OPEN_WRITE)
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+s32 ISFS_SetAttr(const char *filepath, u32 ownerID, u16 groupID, u8 attributes, u8 ownerperm, u8 groupperm, u8 otherperm);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
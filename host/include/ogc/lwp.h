@@ -0,0 +1,32 @@
+#ifndef __LWP_H__
+#define __LWP_H__
+
+#include <gctypes.h>
+
+#define LWP_THREAD_NULL 0xffffffff
+#define LWP_TQUEUE_NULL 0xffffffff
+
+#define LWP_PRIO_IDLE 0
+#define LWP_PRIO_HIGHEST 127
+
+typedef u32 lwp_t;
+typedef u32 lwpq_t;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+s32 LWP_CreateThread(lwp_t *thethread, void *(*entry)(void *), void *arg, void *stackbase, u32 stack_size, u8 prio);
+lwp_t LWP_GetSelf(void);
+
+s32 LWP_InitQueue(lwpq_t *thequeue);
+void LWP_CloseQueue(lwpq_t thequeue);
+s32 LWP_ThreadSleep(lwpq_t thequeue);
+void LWP_ThreadSignal(lwpq_t thequeue);
+void LWP_ThreadBroadcast(lwpq_t thequeue);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
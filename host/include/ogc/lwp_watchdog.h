@@ -0,0 +1,34 @@
+#ifndef __LWP_WATCHDOG_H__
+#define __LWP_WATCHDOG_H__
+
+#include <gctypes.h>
+
+/* Same timebase rate and conversions as libogc, so timings mean the same thing on the host */
+#define TB_BUS_CLOCK 243000000u
+#define TB_CORE_CLOCK 729000000u
+#define TB_TIMER_CLOCK (TB_BUS_CLOCK / 4000) // ticks per millisecond
+
+#define ticks_to_cycles(ticks) ((((u64)(ticks) * (u64)((TB_CORE_CLOCK * 2) / TB_TIMER_CLOCK)) / 2))
+#define ticks_to_secs(ticks) (((u64)(ticks) / (u64)(TB_TIMER_CLOCK * 1000)))
+#define ticks_to_millisecs(ticks) (((u64)(ticks) / (u64)(TB_TIMER_CLOCK)))
+#define ticks_to_microsecs(ticks) ((((u64)(ticks) * 8) / (u64)(TB_TIMER_CLOCK / 125)))
+#define ticks_to_nanosecs(ticks) ((((u64)(ticks) * 8000) / (u64)(TB_TIMER_CLOCK / 125)))
+
+#define secs_to_ticks(sec) ((u64)(sec) * (TB_TIMER_CLOCK * 1000))
+#define millisecs_to_ticks(msec) ((u64)(msec) * (TB_TIMER_CLOCK))
+#define microsecs_to_ticks(usec) (((u64)(usec) * (TB_TIMER_CLOCK / 125)) / 8)
+#define nanosecs_to_ticks(nsec) (((u64)(nsec) * (TB_TIMER_CLOCK / 125)) / 8000)
+
+#define diff_ticks(tick0, tick1) (((u64)(tick1) < (u64)(tick0)) ? ((u64)-1 - (u64)(tick0) + (u64)(tick1)) : ((u64)(tick1) - (u64)(tick0)))
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+u64 gettime(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
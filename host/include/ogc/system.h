@@ -0,0 +1,21 @@
+#ifndef __SYSTEM_H__
+#define __SYSTEM_H__
+
+#include <gctypes.h>
+#include <ogc/video.h>
+
+/* No cached/uncached mirrors on the host */
+#define MEM_K0_TO_K1(x) ((void *)(x))
+#define MEM_K1_TO_K0(x) ((void *)(x))
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void *SYS_AllocateFramebuffer(GXRModeObj *rmode);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,50 @@
+#ifndef __VIDEO_H__
+#define __VIDEO_H__
+
+#include <gctypes.h>
+
+#define VI_INTERLACE 0
+#define VI_NON_INTERLACE 1
+#define VI_PROGRESSIVE 2
+
+#define VI_NTSC 0
+#define VI_PAL 1
+#define VI_MPAL 2
+
+#define VI_TVMODE(fmt, mode) (((fmt) << 2) + (mode))
+#define VI_TVMODE_NTSC_INT VI_TVMODE(VI_NTSC, VI_INTERLACE)
+
+#define VI_DISPLAY_PIX_SZ 2
+
+typedef struct _gx_rmodeobj {
+	u32 viTVMode;
+	u16 fbWidth;
+	u16 efbHeight;
+	u16 xfbHeight;
+	u16 viXOrigin;
+	u16 viYOrigin;
+	u16 viWidth;
+	u16 viHeight;
+	u32 xfbMode;
+	u8 field_rendering;
+	u8 aa;
+} GXRModeObj;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void VIDEO_Init(void);
+GXRModeObj *VIDEO_GetPreferredMode(GXRModeObj *mode);
+void VIDEO_Configure(GXRModeObj *rmode);
+void VIDEO_SetNextFramebuffer(void *fb);
+void VIDEO_SetBlack(BOOL black);
+void VIDEO_Flush(void);
+void VIDEO_WaitVSync(void);
+u32 VIDEO_GetFrameBufferSize(GXRModeObj *rmode);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
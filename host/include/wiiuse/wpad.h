@@ -0,0 +1,38 @@
+#ifndef __WPAD_H__
+#define __WPAD_H__
+
+/* Host stand-in for libogc's wiiuse/wpad.h. Like the real one, it drags in gccore */
+
+#include <gccore.h>
+
+#define WPAD_CHAN_0 0
+
+#define WPAD_ERR_NONE 0
+#define WPAD_ERR_NO_CONTROLLER -1
+
+#define WPAD_BUTTON_2 0x0001
+#define WPAD_BUTTON_1 0x0002
+#define WPAD_BUTTON_B 0x0004
+#define WPAD_BUTTON_A 0x0008
+#define WPAD_BUTTON_MINUS 0x0010
+#define WPAD_BUTTON_HOME 0x0080
+#define WPAD_BUTTON_LEFT 0x0100
+#define WPAD_BUTTON_RIGHT 0x0200
+#define WPAD_BUTTON_DOWN 0x0400
+#define WPAD_BUTTON_UP 0x0800
+#define WPAD_BUTTON_PLUS 0x1000
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+s32 WPAD_Init(void);
+s32 WPAD_ScanPads(void);
+u32 WPAD_ButtonsDown(int chan);
+u32 WPAD_ButtonsHeld(int chan);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,198 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <ogc/lwp_watchdog.h>
+
+#include "footprint.h"
+#include "profile.h"
+#include "sim.h"
+
+/*
+ * Frame accounting for benchmark runs. Two clocks are kept side by side:
+ * virtual time, which models the console and is identical on every run, and the host's
+ * CPU time, which shows what the code itself costs but moves around with the machine.
+ */
+
+static const char *__sim_section_names[PROFILE_SECTIONS] = { "other", "input", "format", "render", "save" };
+
+static int __sim_started = 0;
+static int __sim_section = PROFILE_NONE;
+static u64 __sim_section_ticks_at = 0;
+static u64 __sim_section_cpu_at = 0;
+
+static u64 __sim_ticks[PROFILE_SECTIONS];
+static u64 __sim_cpu[PROFILE_SECTIONS];
+
+static u64 __sim_startup_ticks = 0;
+static u64 __sim_frame_ticks_at = 0, __sim_frame_cpu_at = 0;
+static u64 __sim_worst_frame_ticks = 0, __sim_worst_frame_cpu = 0;
+static u64 __sim_loop_frames = 0;
+static s64 __sim_sync_error_us = 0;
+static u32 __sim_sync_ms = 0;
+
+static u64 __sim_cpu_now(void) {
+	struct timespec ts;
+
+	clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+	return (u64)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+void PROFILE_Enter(int section) {
+	u64 ticks = sim_clock_ticks();
+	u64 cpu = __sim_cpu_now();
+
+	// The first section entered marks the start of the main loop; everything before is startup
+	if (!__sim_started) {
+		__sim_started = 1;
+		__sim_startup_ticks = ticks;
+		__sim_frame_ticks_at = ticks;
+		__sim_frame_cpu_at = cpu;
+	} else {
+		__sim_ticks[__sim_section] += ticks - __sim_section_ticks_at;
+		__sim_cpu[__sim_section] += cpu - __sim_section_cpu_at;
+	}
+
+	__sim_section = section;
+	__sim_section_ticks_at = ticks;
+	__sim_section_cpu_at = cpu;
+}
+
+void PROFILE_Sync(long long offsetUs, unsigned elapsedMs) {
+	__sim_sync_error_us = sim_net_offset_error_us(offsetUs);
+	__sim_sync_ms = elapsedMs;
+}
+
+// Called as each frame ends, before waiting for the display
+void sim_bench_frame_end(void) {
+	u64 ticks, cpu;
+
+	if (!__sim_started) return;
+
+	PROFILE_Enter(PROFILE_NONE);
+	ticks = sim_clock_ticks();
+	cpu = __sim_cpu_now();
+
+	if (ticks - __sim_frame_ticks_at > __sim_worst_frame_ticks) __sim_worst_frame_ticks = ticks - __sim_frame_ticks_at;
+	if (cpu - __sim_frame_cpu_at > __sim_worst_frame_cpu) __sim_worst_frame_cpu = cpu - __sim_frame_cpu_at;
+	__sim_loop_frames++;
+}
+
+// Called once the display wait is over and the next frame begins
+void sim_bench_frame_start(void) {
+	__sim_frame_ticks_at = sim_clock_ticks();
+	__sim_frame_cpu_at = __sim_cpu_now();
+	__sim_section_ticks_at = __sim_frame_ticks_at;
+	__sim_section_cpu_at = __sim_frame_cpu_at;
+}
+
+typedef struct _sim_metric {
+	const char *name;
+	double value;
+} sim_metric;
+
+#define SIM_METRICS 21
+
+static void __sim_metrics(sim_metric *m) {
+	u64 frames = __sim_loop_frames ? __sim_loop_frames : 1;
+	footprint_heap heap;
+	u64 cpu = 0;
+	u32 bias = 0;
+	s64 error;
+	int i;
+
+	for (i = 0; i < PROFILE_SECTIONS; i++) cpu += __sim_cpu[i];
+	FOOTPRINT_GetHeap(&heap);
+	sim_nand_get_bias(&bias);
+	error = sim_net_error_us(bias);
+
+	m[0] = (sim_metric){ "frames", __sim_loop_frames };
+	m[1] = (sim_metric){ "vsync_periods", sim_stat.vsyncPeriods };
+	m[2] = (sim_metric){ "presses", sim_stat.presses };
+	m[3] = (sim_metric){ "startup_us", ticks_to_microsecs(__sim_startup_ticks) };
+	m[4] = (sim_metric){ "virtual_ms", ticks_to_millisecs(sim_clock_ticks()) };
+	m[5] = (sim_metric){ "worst_frame_us", ticks_to_microsecs(__sim_worst_frame_ticks) };
+	m[6] = (sim_metric){ "worst_frame_cpu_us", __sim_worst_frame_cpu / 1000.0 };
+	m[7] = (sim_metric){ "cpu_us_per_frame", cpu / 1000.0 / frames };
+	m[8] = (sim_metric){ "saves", sim_stat.sysconfSaves + sim_stat.settingTxtSaves };
+	m[9] = (sim_metric){ "nand_writes", sim_stat.nandWrites };
+	m[10] = (sim_metric){ "nand_bytes_written", sim_stat.nandBytesWritten };
+	m[11] = (sim_metric){ "nand_bytes_read", sim_stat.nandBytesRead };
+	m[12] = (sim_metric){ "rtc_reads", sim_stat.rtcReads };
+	m[13] = (sim_metric){ "ipc_calls", sim_stat.ipcCalls };
+	m[14] = (sim_metric){ "heap_peak_bytes", heap.peak };
+	m[15] = (sim_metric){ "heap_bytes_at_exit", heap.inUse };
+	m[16] = (sim_metric){ "ntp_requests", sim_stat.ntpRequests };
+	m[17] = (sim_metric){ "clock_error_ms", (error < 0 ? -error : error) / 1000.0 };
+	m[18] = (sim_metric){ "sntp_offset_error_us", __sim_sync_error_us < 0 ? -__sim_sync_error_us : __sim_sync_error_us };
+	m[19] = (sim_metric){ "sntp_sync_ms", __sim_sync_ms };
+	m[20] = (sim_metric){ "nand_busy_us", ticks_to_microsecs(sim_stat.nandBusyTicks) };
+}
+
+int sim_bench_write_json(const char *path, const char *name) {
+	sim_metric m[SIM_METRICS];
+	u64 frames = __sim_loop_frames ? __sim_loop_frames : 1;
+	FILE *fp;
+	int i;
+
+	fp = fopen(path, "w");
+	if (!fp) return -1;
+
+	__sim_metrics(m);
+	fprintf(fp, "{\n  \"name\": \"%s\"", name);
+	for (i = 0; i < SIM_METRICS; i++) {
+		if (m[i].value == (double)(u64)m[i].value) fprintf(fp, ",\n  \"%s\": %llu", m[i].name, (unsigned long long)m[i].value);
+		else fprintf(fp, ",\n  \"%s\": %.3f", m[i].name, m[i].value);
+	}
+
+	fprintf(fp, ",\n  \"virtual_us\": {");
+	for (i = 0; i < PROFILE_SECTIONS; i++)
+		fprintf(fp, "%s\"%s\": %llu", i ? ", " : " ", __sim_section_names[i], (unsigned long long)ticks_to_microsecs(__sim_ticks[i]));
+	fprintf(fp, " },\n  \"cpu_us\": {");
+	for (i = 0; i < PROFILE_SECTIONS; i++)
+		fprintf(fp, "%s\"%s\": %.3f", i ? ", " : " ", __sim_section_names[i], __sim_cpu[i] / 1000.0);
+	fprintf(fp, " },\n  \"cpu_us_per_frame_by_section\": {");
+	for (i = 0; i < PROFILE_SECTIONS; i++)
+		fprintf(fp, "%s\"%s\": %.3f", i ? ", " : " ", __sim_section_names[i], __sim_cpu[i] / 1000.0 / frames);
+	fprintf(fp, " }\n}\n");
+
+	fclose(fp);
+	return 0;
+}
+
+/*
+ * Thresholds are lines of "<sequence> <metric> <max>", '*' matching any sequence.
+ * Returns how many were exceeded, or -1 when the file can't be read.
+ */
+int sim_bench_check(const char *path, const char *name) {
+	sim_metric m[SIM_METRICS];
+	char line[256], seq[64], metric[64];
+	double max;
+	int i, failed = 0, lineNo = 0;
+	FILE *fp;
+
+	fp = fopen(path, "r");
+	if (!fp) return -1;
+
+	__sim_metrics(m);
+	while (fgets(line, sizeof(line), fp)) {
+		lineNo++;
+		if (line[0] == '#' || sscanf(line, "%63s %63s %lf", seq, metric, &max) != 3) continue;
+		if (strcmp(seq, "*") && strcmp(seq, name)) continue;
+
+		for (i = 0; i < SIM_METRICS; i++)
+			if (!strcmp(m[i].name, metric)) break;
+
+		if (i == SIM_METRICS) {
+			fprintf(stderr, "[bench] %s:%d: unknown metric %s\n", path, lineNo, metric);
+			failed++;
+		} else if (m[i].value > max) {
+			fprintf(stderr, "[bench] %s: %s is %.3f, over the limit of %.3f\n", name, metric, m[i].value, max);
+			failed++;
+		}
+	}
+
+	fclose(fp);
+	return failed;
+}
@@ -0,0 +1,80 @@
+#include <ogc/lwp_watchdog.h>
+
+#include "sim.h"
+
+// The whole simulation runs on this one virtual timebase. Nothing reads the host's clock,
+// so a run is the same every time no matter how fast or loaded the machine is.
+static u64 __sim_ticks = 0;
+static u32 __sim_rtc_base = 0;
+static u64 __sim_rtc_phase = 0;
+static u64 __sim_last_period = 0;
+
+void sim_clock_setup(u32 rtc, u32 phaseMs) {
+	__sim_rtc_base = rtc;
+	__sim_rtc_phase = millisecs_to_ticks(phaseMs % 1000);
+}
+
+void sim_clock_advance(u64 ticks) {
+	__sim_ticks += ticks;
+	sim_ipc_poll();
+	sim_thread_preempt();
+}
+
+// Each LWP thread keeps its own clock; sim/thread.c swaps them in and out
+void sim_clock_set(u64 ticks) {
+	__sim_ticks = ticks;
+}
+
+u64 sim_clock_ticks(void) {
+	return __sim_ticks;
+}
+
+u32 sim_clock_rtc(void) {
+	return __sim_rtc_base + (u32)((__sim_ticks + __sim_rtc_phase) / secs_to_ticks(1));
+}
+
+// How long ago the RTC counter last ticked over
+u64 sim_clock_since_rtc_tick(void) {
+	return (__sim_ticks + __sim_rtc_phase) % secs_to_ticks(1);
+}
+
+void sim_clock_wait_vsync(void) {
+	// Sleep until the start of the next display period, however far into this one we already are
+	u64 period = (__sim_ticks * SIM_FRAME_TICKS_DEN) / SIM_FRAME_TICKS_NUM + 1;
+	u64 vsync = (period * SIM_FRAME_TICKS_NUM + SIM_FRAME_TICKS_DEN - 1) / SIM_FRAME_TICKS_DEN;
+
+	// Any other threads get the time the main thread spends asleep
+	sim_thread_run(vsync);
+
+	__sim_ticks = vsync;
+	sim_ipc_poll();
+	sim_stat.vsyncPeriods += period - __sim_last_period;
+	sim_stat.frames++;
+	__sim_last_period = period;
+}
+
+u64 gettime(void) {
+	sim_clock_advance(SIM_COST_GETTIME);
+	return __sim_ticks;
+}
+
+// Mirrors libogc: read the counter twice and only trust it when both reads agree
+u32 __SYS_GetRTC(u32 *gctime) {
+	u32 time1, time2;
+	int cnt;
+
+	sim_stat.rtcReads++;
+	for (cnt = 0; cnt < 16; cnt++) {
+		time1 = sim_clock_rtc();
+		sim_clock_advance(SIM_COST_RTC_READ);
+		time2 = sim_clock_rtc();
+		sim_clock_advance(SIM_COST_RTC_READ);
+
+		if (time1 == time2) {
+			*gctime = time1;
+			return 1;
+		}
+		sim_stat.rtcRetries++;
+	}
+	return 0;
+}
@@ -0,0 +1,411 @@
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+
+#include <wiiuse/wpad.h>
+
+#include "sim.h"
+
+/*
+ * Input scripts are plain text, one directive per line, '#' starts a comment:
+ *
+ *   rtc <seconds since 2000-01-01>   RTC counter at power on (before any input only)
+ *   phase <ms>                       how far into its current second the RTC is at power on
+ *   bias <value>                     IPL.CB in the generated SYSCONF
+ *   ntp <seconds[.fraction]>         true time at power on, as the stand-in SNTP server tells it
+ *   net <delay ms> [<jitter ms> [<loss %>]]  one-way delay, extra random delay and packet loss
+ *   arg <argument>                   an argument passed to wiirtc, after any on the command line
+ *   press <buttons> [xN]             buttons down for a frame, then a frame with nothing, N times
+ *   down <buttons> [xN]              buttons reported as newly down on N consecutive frames
+ *   wait <frames>                    frames with nothing pressed
+ *   view <entry>                     a frame with nothing pressed, before which a SYSCONF array entry is
+ *                                    read back while the same thread has a write view open on it (view.c)
+ *
+ * <buttons> is a comma separated list of Wii Remote names (A B 1 2 PLUS MINUS HOME UP DOWN LEFT RIGHT)
+ * and GameCube names (GC_A GC_B GC_X GC_Y GC_Z GC_L GC_R GC_START GC_UP GC_DOWN GC_LEFT GC_RIGHT).
+ * Every frame's input comes from the script, so replaying one always yields the same run.
+ * rtc, phase, bias, ntp, net and arg settle how the run starts, so they go before any input.
+ */
+
+typedef struct _sim_step {
+	u32 wpad;
+	u32 gc;
+	u32 count;
+	char *view; // An entry for sim_view_check on the step's first frame, or NULL
+} sim_step;
+
+static const struct {
+	const char *name;
+	u32 wpad;
+	u32 gc;
+} __sim_buttons[] = {
+	{ "A", WPAD_BUTTON_A, 0 },
+	{ "B", WPAD_BUTTON_B, 0 },
+	{ "1", WPAD_BUTTON_1, 0 },
+	{ "2", WPAD_BUTTON_2, 0 },
+	{ "PLUS", WPAD_BUTTON_PLUS, 0 },
+	{ "MINUS", WPAD_BUTTON_MINUS, 0 },
+	{ "HOME", WPAD_BUTTON_HOME, 0 },
+	{ "UP", WPAD_BUTTON_UP, 0 },
+	{ "DOWN", WPAD_BUTTON_DOWN, 0 },
+	{ "LEFT", WPAD_BUTTON_LEFT, 0 },
+	{ "RIGHT", WPAD_BUTTON_RIGHT, 0 },
+	{ "GC_A", 0, PAD_BUTTON_A },
+	{ "GC_B", 0, PAD_BUTTON_B },
+	{ "GC_X", 0, PAD_BUTTON_X },
+	{ "GC_Y", 0, PAD_BUTTON_Y },
+	{ "GC_Z", 0, PAD_TRIGGER_Z },
+	{ "GC_L", 0, PAD_TRIGGER_L },
+	{ "GC_R", 0, PAD_TRIGGER_R },
+	{ "GC_START", 0, PAD_BUTTON_START },
+	{ "GC_UP", 0, PAD_BUTTON_UP },
+	{ "GC_DOWN", 0, PAD_BUTTON_DOWN },
+	{ "GC_LEFT", 0, PAD_BUTTON_LEFT },
+	{ "GC_RIGHT", 0, PAD_BUTTON_RIGHT },
+};
+
+static sim_step *__sim_steps = NULL;
+static int __sim_step_count = 0, __sim_step_alloc = 0;
+static int __sim_step_pos = 0;
+static u32 __sim_step_used = 0;
+
+static FILE *__sim_script = NULL;
+static const char *__sim_script_name = NULL;
+static int __sim_line = 0;
+static int __sim_interactive = 0;
+
+static FILE *__sim_record = NULL;
+static sim_step __sim_record_run = { 0, 0, 0 };
+
+static u64 __sim_latched_frame = (u64)-1;
+static u32 __sim_wpad_down = 0, __sim_gc_down = 0;
+
+// Settings that have to be known before the program starts
+static u32 __sim_pre_rtc = 0, __sim_pre_phase = 0, __sim_pre_bias = 0;
+static int __sim_pre_has_rtc = 0, __sim_pre_has_phase = 0, __sim_pre_has_bias = 0;
+static s64 __sim_pre_truth = 0;
+static u32 __sim_pre_link[3] = { 0, 0, 0 };
+static int __sim_pre_has_truth = 0, __sim_pre_has_link = 0;
+static char *__sim_pre_args[8];
+static int __sim_pre_arg_count = 0;
+
+static sim_step *__sim_new_step(void) {
+	if (__sim_step_count == __sim_step_alloc) {
+		__sim_step_alloc = __sim_step_alloc ? __sim_step_alloc * 2 : 64;
+		__sim_steps = __real_realloc(__sim_steps, __sim_step_alloc * sizeof(sim_step));
+		if (!__sim_steps) {
+			fprintf(stderr, "[sim] out of memory\n");
+			exit(2);
+		}
+	}
+
+	memset(&__sim_steps[__sim_step_count], 0, sizeof(sim_step));
+	return &__sim_steps[__sim_step_count++];
+}
+
+static void __sim_add_step(u32 wpad, u32 gc, u32 count) {
+	sim_step *step;
+
+	if (!count) return;
+
+	// Only merge into a step that hasn't started playing yet
+	if (__sim_step_count > __sim_step_pos && __sim_steps[__sim_step_count - 1].wpad == wpad && __sim_steps[__sim_step_count - 1].gc == gc) {
+		__sim_steps[__sim_step_count - 1].count += count;
+		return;
+	}
+
+	step = __sim_new_step();
+	step->wpad = wpad;
+	step->gc = gc;
+	step->count = count;
+}
+
+static int __sim_parse_buttons(char *list, u32 *wpad, u32 *gc) {
+	char *name, *save;
+	size_t i;
+
+	*wpad = *gc = 0;
+	for (name = strtok_r(list, ",", &save); name; name = strtok_r(NULL, ",", &save)) {
+		for (i = 0; i < sizeof(__sim_buttons) / sizeof(__sim_buttons[0]); i++)
+			if (!strcasecmp(name, __sim_buttons[i].name)) break;
+
+		if (i == sizeof(__sim_buttons) / sizeof(__sim_buttons[0])) return -1;
+		*wpad |= __sim_buttons[i].wpad;
+		*gc |= __sim_buttons[i].gc;
+	}
+	return 0;
+}
+
+static int __sim_parse_line(char *line) {
+	char *cmd, *arg, *rep, *save;
+	u32 wpad, gc, count = 1;
+
+	if ((cmd = strchr(line, '#'))) *cmd = 0;
+
+	cmd = strtok_r(line, " \t\r\n", &save);
+	if (!cmd) return 0;
+	arg = strtok_r(NULL, " \t\r\n", &save);
+	rep = strtok_r(NULL, " \t\r\n", &save);
+
+	if (!strcasecmp(cmd, "ntp") || !strcasecmp(cmd, "net") || !strcasecmp(cmd, "arg")) {
+		if (!arg) return -1;
+		if (__sim_step_count || sim_stat.frames) {
+			fprintf(stderr, "[sim] %s:%d: %s must come before any input\n", __sim_script_name, __sim_line, cmd);
+			return -1;
+		}
+
+		if (!strcasecmp(cmd, "ntp")) {
+			if (rep || sim_net_parse_time(arg, &__sim_pre_truth) < 0) return -1;
+			__sim_pre_has_truth = 1;
+		} else if (!strcasecmp(cmd, "net")) {
+			char *loss = strtok_r(NULL, " \t\r\n", &save);
+
+			__sim_pre_link[0] = strtoul(arg, NULL, 0);
+			__sim_pre_link[1] = rep ? strtoul(rep, NULL, 0) : 0;
+			__sim_pre_link[2] = loss ? strtoul(loss, NULL, 0) : 0;
+			__sim_pre_has_link = 1;
+		} else {
+			if (rep || __sim_pre_arg_count == sizeof(__sim_pre_args) / sizeof(__sim_pre_args[0])) return -1;
+			__sim_pre_args[__sim_pre_arg_count] = __real_malloc(strlen(arg) + 1);
+			if (!__sim_pre_args[__sim_pre_arg_count]) return -1;
+			strcpy(__sim_pre_args[__sim_pre_arg_count++], arg);
+		}
+		return 0;
+	}
+
+	if (rep) {
+		if (tolower((unsigned char)rep[0]) != 'x' || !(count = strtoul(rep + 1, NULL, 0))) return -1;
+	}
+
+	if (!strcasecmp(cmd, "rtc") || !strcasecmp(cmd, "phase") || !strcasecmp(cmd, "bias")) {
+		u32 value;
+
+		if (!arg) return -1;
+		if (__sim_step_count || sim_stat.frames) {
+			fprintf(stderr, "[sim] %s:%d: %s must come before any input\n", __sim_script_name, __sim_line, cmd);
+			return -1;
+		}
+
+		value = strtoul(arg, NULL, 0);
+		if (!strcasecmp(cmd, "rtc")) { __sim_pre_rtc = value; __sim_pre_has_rtc = 1; }
+		else if (!strcasecmp(cmd, "phase")) { __sim_pre_phase = value; __sim_pre_has_phase = 1; }
+		else { __sim_pre_bias = value; __sim_pre_has_bias = 1; }
+		return 0;
+	}
+
+	if (!strcasecmp(cmd, "wait")) {
+		if (!arg || rep) return -1;
+		__sim_add_step(0, 0, strtoul(arg, NULL, 0));
+		return 0;
+	}
+
+	if (!strcasecmp(cmd, "view")) {
+		sim_step *step;
+
+		if (!arg || rep) return -1;
+		step = __sim_new_step();
+		step->count = 1;
+		step->view = __real_malloc(strlen(arg) + 1);
+		if (!step->view) return -1;
+		strcpy(step->view, arg);
+		return 0;
+	}
+
+	if (!arg || __sim_parse_buttons(arg, &wpad, &gc) < 0) return -1;
+
+	if (!strcasecmp(cmd, "press")) {
+		while (count--) {
+			__sim_add_step(wpad, gc, 1);
+			__sim_add_step(0, 0, 1);
+		}
+		return 0;
+	}
+	if (!strcasecmp(cmd, "down")) {
+		__sim_add_step(wpad, gc, count);
+		return 0;
+	}
+	return -1;
+}
+
+// Reads directives until some input is queued or the script runs out
+static int __sim_read_more(void) {
+	char line[256];
+
+	if (!__sim_script) return 0;
+
+	while (__sim_step_pos == __sim_step_count) {
+		if (__sim_interactive) {
+			sim_console_dump(sim_out);
+			fprintf(sim_out, "sim> ");
+			fflush(sim_out);
+		}
+
+		if (!fgets(line, sizeof(line), __sim_script)) return 0;
+		__sim_line++;
+
+		if (__sim_parse_line(line) < 0) {
+			fprintf(stderr, "[sim] %s:%d: can't understand \"%s\"\n", __sim_script_name, __sim_line, strtok(line, "\r\n"));
+			if (!__sim_interactive) exit(2);
+		}
+	}
+	return 1;
+}
+
+int sim_input_open(const char *script) {
+	if (script) {
+		__sim_script = fopen(script, "r");
+		if (!__sim_script) return -1;
+		__sim_script_name = script;
+
+		// Scripts are read whole up front so their settings are known before the program starts
+		while (__sim_read_more()) __sim_step_pos = __sim_step_count;
+		__sim_step_pos = 0;
+		fclose(__sim_script);
+		__sim_script = NULL;
+	} else {
+		__sim_script = stdin;
+		__sim_script_name = "stdin";
+		__sim_interactive = 1;
+	}
+	return 0;
+}
+
+int sim_input_preamble(u32 *rtc, u32 *phaseMs, u32 *bias, int *hasBias) {
+	if (__sim_pre_has_rtc) *rtc = __sim_pre_rtc;
+	if (__sim_pre_has_phase) *phaseMs = __sim_pre_phase;
+	if (__sim_pre_has_bias) {
+		*bias = __sim_pre_bias;
+		*hasBias = 1;
+	}
+	return 0;
+}
+
+int sim_input_network(s64 *truthUs, int *hasTruth, u32 *link, int *hasLink) {
+	if (__sim_pre_has_truth) {
+		*truthUs = __sim_pre_truth;
+		*hasTruth = 1;
+	}
+	if (__sim_pre_has_link) {
+		memcpy(link, __sim_pre_link, sizeof(__sim_pre_link));
+		*hasLink = 1;
+	}
+	return 0;
+}
+
+int sim_input_args(char **argv, int max) {
+	int i;
+
+	for (i = 0; i < __sim_pre_arg_count && i < max; i++) argv[i] = __sim_pre_args[i];
+	return i;
+}
+
+static void __sim_record_flush(void) {
+	size_t i;
+	int first = 1;
+
+	if (!__sim_record || !__sim_record_run.count) return;
+
+	if (!__sim_record_run.wpad && !__sim_record_run.gc) {
+		fprintf(__sim_record, "wait %u\n", __sim_record_run.count);
+	} else {
+		fprintf(__sim_record, "down ");
+		for (i = 0; i < sizeof(__sim_buttons) / sizeof(__sim_buttons[0]); i++) {
+			if ((__sim_buttons[i].wpad & __sim_record_run.wpad) || (__sim_buttons[i].gc & __sim_record_run.gc)) {
+				fprintf(__sim_record, "%s%s", first ? "" : ",", __sim_buttons[i].name);
+				first = 0;
+			}
+		}
+		fprintf(__sim_record, " x%u\n", __sim_record_run.count);
+	}
+	__sim_record_run.count = 0;
+}
+
+int sim_input_record(const char *path, u32 rtc, u32 phaseMs, u32 bias, s64 truthUs, const u32 *link, char **args, int argCount) {
+	int i;
+
+	__sim_record = fopen(path, "w");
+	if (!__sim_record) return -1;
+
+	fprintf(__sim_record, "# Recorded by wiirtc-sim\n");
+	fprintf(__sim_record, "rtc %u\nphase %u\nbias %u\n", rtc, phaseMs, bias);
+	fprintf(__sim_record, "ntp %lld.%06lld\nnet %u %u %u\n", (long long)(truthUs / 1000000), (long long)(truthUs % 1000000), link[0], link[1], link[2]);
+	for (i = 0; i < argCount; i++) fprintf(__sim_record, "arg %s\n", args[i]);
+	return 0;
+}
+
+void sim_input_close(void) {
+	if (!__sim_record) return;
+
+	__sim_record_flush();
+	fclose(__sim_record);
+	__sim_record = NULL;
+}
+
+static void __sim_record_frame(u32 wpad, u32 gc) {
+	if (!__sim_record) return;
+
+	if (__sim_record_run.count && (__sim_record_run.wpad != wpad || __sim_record_run.gc != gc)) __sim_record_flush();
+	__sim_record_run.wpad = wpad;
+	__sim_record_run.gc = gc;
+	__sim_record_run.count++;
+}
+
+// Both controller types are scanned every frame; whichever goes first pulls that frame's input
+static void __sim_latch(void) {
+	if (__sim_latched_frame == sim_stat.frames) return;
+	__sim_latched_frame = sim_stat.frames;
+
+	if (__sim_step_pos == __sim_step_count && !__sim_read_more()) {
+		fprintf(stderr, "[sim] end of input after %llu frames\n", (unsigned long long)sim_stat.frames);
+		exit(0);
+	}
+
+	if (!__sim_step_used && __sim_steps[__sim_step_pos].view) sim_view_check(__sim_steps[__sim_step_pos].view);
+	__sim_wpad_down = __sim_steps[__sim_step_pos].wpad;
+	__sim_gc_down = __sim_steps[__sim_step_pos].gc;
+	if (++__sim_step_used == __sim_steps[__sim_step_pos].count) {
+		__sim_step_pos++;
+		__sim_step_used = 0;
+	}
+
+	if (__sim_wpad_down || __sim_gc_down) sim_stat.presses++;
+	__sim_record_frame(__sim_wpad_down, __sim_gc_down);
+}
+
+s32 WPAD_Init(void) {
+	return WPAD_ERR_NONE;
+}
+
+s32 WPAD_ScanPads(void) {
+	sim_clock_advance(SIM_COST_WPAD_SCAN);
+	__sim_latch();
+	return 0;
+}
+
+u32 WPAD_ButtonsDown(int chan) {
+	return chan == 0 ? __sim_wpad_down : 0;
+}
+
+u32 WPAD_ButtonsHeld(int chan) {
+	return chan == 0 ? __sim_wpad_down : 0;
+}
+
+u32 PAD_Init(void) {
+	return 1;
+}
+
+u32 PAD_ScanPads(void) {
+	sim_clock_advance(SIM_COST_PAD_SCAN);
+	__sim_latch();
+	return 1;
+}
+
+u16 PAD_ButtonsDown(int pad) {
+	return pad == 0 ? __sim_gc_down : 0;
+}
+
+u16 PAD_ButtonsHeld(int pad) {
+	return pad == 0 ? __sim_gc_down : 0;
+}
@@ -0,0 +1,73 @@
+#include <errno.h>
+#include <pthread.h>
+
+#include <ogc/mutex.h>
+
+/*
+ * LWP mutexes on top of pthreads. libogc hands out small integer handles rather than
+ * pointers, so the same is done here with a fixed table.
+ * Nothing here touches the simulator's state, so the tools link it too.
+ */
+#define LWP_MAX_MUTEXES 128
+
+static pthread_mutex_t __lwp_mutexes[LWP_MAX_MUTEXES];
+static int __lwp_mutex_used[LWP_MAX_MUTEXES];
+static pthread_mutex_t __lwp_table_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static pthread_mutex_t *__lwp_mutex(mutex_t mutex) {
+	if (mutex < 1 || mutex > LWP_MAX_MUTEXES || !__lwp_mutex_used[mutex - 1]) return NULL;
+	return &__lwp_mutexes[mutex - 1];
+}
+
+s32 LWP_MutexInit(mutex_t *mutex, bool use_recursive) {
+	pthread_mutexattr_t attr;
+	int i;
+
+	pthread_mutex_lock(&__lwp_table_lock);
+	for (i = 0; i < LWP_MAX_MUTEXES && __lwp_mutex_used[i]; i++)
+		;
+	if (i == LWP_MAX_MUTEXES) {
+		pthread_mutex_unlock(&__lwp_table_lock);
+		return -1;
+	}
+
+	pthread_mutexattr_init(&attr);
+	pthread_mutexattr_settype(&attr, use_recursive ? PTHREAD_MUTEX_RECURSIVE : PTHREAD_MUTEX_ERRORCHECK);
+	pthread_mutex_init(&__lwp_mutexes[i], &attr);
+	pthread_mutexattr_destroy(&attr);
+	__lwp_mutex_used[i] = 1;
+	pthread_mutex_unlock(&__lwp_table_lock);
+
+	*mutex = i + 1;
+	return 0;
+}
+
+s32 LWP_MutexDestroy(mutex_t mutex) {
+	pthread_mutex_t *m = __lwp_mutex(mutex);
+
+	if (!m) return -1;
+	pthread_mutex_lock(&__lwp_table_lock);
+	pthread_mutex_destroy(m);
+	__lwp_mutex_used[mutex - 1] = 0;
+	pthread_mutex_unlock(&__lwp_table_lock);
+	return 0;
+}
+
+s32 LWP_MutexLock(mutex_t mutex) {
+	pthread_mutex_t *m = __lwp_mutex(mutex);
+
+	return m ? -pthread_mutex_lock(m) : -1;
+}
+
+s32 LWP_MutexTryLock(mutex_t mutex) {
+	pthread_mutex_t *m = __lwp_mutex(mutex);
+
+	if (!m) return -1;
+	return pthread_mutex_trylock(m) == EBUSY ? 1 : 0;
+}
+
+s32 LWP_MutexUnlock(mutex_t mutex) {
+	pthread_mutex_t *m = __lwp_mutex(mutex);
+
+	return m ? -pthread_mutex_unlock(m) : -1;
+}
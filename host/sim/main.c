@@ -0,0 +1,218 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <ogc/lwp_watchdog.h>
+
+#include "footprint.h"
+#include "sim.h"
+
+// wiirtc.c's own main, renamed by the host Makefile
+int wiirtc_main(int argc, char **argv);
+
+sim_stats sim_stat;
+FILE *sim_out = NULL;
+
+static const char *__sim_save_sysconf = NULL;
+static const char *__sim_save_setting = NULL;
+static const char *__sim_json = NULL;
+static const char *__sim_thresholds = NULL;
+static const char *__sim_name = "run";
+
+static void usage(const char *self) {
+	fprintf(stderr,
+		"Usage: %s [options] [-- wiirtc arguments]\n"
+		"  --script FILE       replay input from FILE instead of reading it from stdin\n"
+		"  --record FILE       write every frame of input used to FILE, replayable with --script\n"
+		"  --sysconf FILE      start from this SYSCONF instead of a generated one\n"
+		"  --setting FILE      start from this (encrypted) setting.txt instead of a generated one\n"
+		"  --save-sysconf FILE write the SYSCONF left on the virtual NAND to FILE on exit\n"
+		"  --save-setting FILE write the setting.txt left on the virtual NAND to FILE on exit\n"
+		"  --rtc SECONDS       RTC counter at power on, in seconds since 2000-01-01 (default 0)\n"
+		"  --phase MS          how far into its current second the RTC is at power on\n"
+		"  --bias VALUE        IPL.CB in the generated SYSCONF (default 0)\n"
+		"  --title ID          title ID reported by ES_GetTitleID (default the Homebrew Channel)\n"
+		"  --ntp-time SECONDS  true time at power on, in seconds since 2000-01-01 with any fraction;\n"
+		"                      the stand-in SNTP server keeps it (default what the console shows)\n"
+		"  --net-delay MS      one-way network delay to the SNTP server (default 5)\n"
+		"  --net-jitter MS     up to this much more delay on each packet, at random (default 0)\n"
+		"  --net-loss PERCENT  packets lost on the way to the server (default 0)\n"
+		"  --sd DIR            directory standing in for the SD card (default ./sd)\n"
+		"  --trace             print the screen after every frame that changed it\n"
+		"  --name NAME         name of this run in benchmark output (default \"run\")\n"
+		"  --json FILE         write frame timings, NAND traffic and other metrics to FILE as JSON\n"
+		"  --thresholds FILE   exit with status 3 if any metric is over its limit in FILE\n",
+		self);
+}
+
+static void report(void) {
+	footprint_heap heap;
+	u32 bias;
+
+	sim_input_close();
+
+	fprintf(sim_out, "--- final screen ---\n");
+	sim_console_dump(sim_out);
+	fflush(sim_out);
+
+	fprintf(stderr, "frames: %llu\n", (unsigned long long)sim_stat.frames);
+	fprintf(stderr, "vsync_periods: %llu\n", (unsigned long long)sim_stat.vsyncPeriods);
+	fprintf(stderr, "virtual_ms: %llu\n", (unsigned long long)ticks_to_millisecs(sim_clock_ticks()));
+	fprintf(stderr, "presses: %llu\n", (unsigned long long)sim_stat.presses);
+	fprintf(stderr, "rtc_reads: %llu\n", (unsigned long long)sim_stat.rtcReads);
+	fprintf(stderr, "rtc_retries: %llu\n", (unsigned long long)sim_stat.rtcRetries);
+	fprintf(stderr, "ipc_calls: %llu\n", (unsigned long long)sim_stat.ipcCalls);
+	fprintf(stderr, "sysconf_saves: %llu\n", (unsigned long long)sim_stat.sysconfSaves);
+	fprintf(stderr, "setting_txt_saves: %llu\n", (unsigned long long)sim_stat.settingTxtSaves);
+	fprintf(stderr, "nand_writes: %llu\n", (unsigned long long)sim_stat.nandWrites);
+	fprintf(stderr, "nand_bytes_written: %llu\n", (unsigned long long)sim_stat.nandBytesWritten);
+	fprintf(stderr, "nand_bytes_read: %llu\n", (unsigned long long)sim_stat.nandBytesRead);
+	fprintf(stderr, "nand_busy_us: %llu\n", (unsigned long long)ticks_to_microsecs(sim_stat.nandBusyTicks));
+	FOOTPRINT_GetHeap(&heap);
+	fprintf(stderr, "heap_peak_bytes: %u\n", heap.peak);
+	if (sim_nand_get_bias(&bias) == 0) {
+		fprintf(stderr, "nand_bias: %u\n", bias);
+		fprintf(stderr, "clock_error_ms: %.3f\n", sim_net_error_us(bias) / 1000.0);
+	}
+	fprintf(stderr, "ntp_requests: %llu\n", (unsigned long long)sim_stat.ntpRequests);
+
+	if (__sim_save_sysconf && sim_nand_store(SIM_NAND_SYSCONF, __sim_save_sysconf) < 0)
+		fprintf(stderr, "[sim] couldn't write %s\n", __sim_save_sysconf);
+	if (__sim_save_setting && sim_nand_store(SIM_NAND_SETTING_TXT, __sim_save_setting) < 0)
+		fprintf(stderr, "[sim] couldn't write %s\n", __sim_save_setting);
+
+	if (__sim_json && sim_bench_write_json(__sim_json, __sim_name) < 0)
+		fprintf(stderr, "[sim] couldn't write %s\n", __sim_json);
+
+	if (__sim_thresholds) {
+		int failed = sim_bench_check(__sim_thresholds, __sim_name);
+
+		if (failed < 0) fprintf(stderr, "[sim] couldn't read %s\n", __sim_thresholds);
+		if (failed) {
+			fflush(NULL);
+			_exit(3);
+		}
+	}
+}
+
+int main(int argc, char **argv) {
+	const char *script = NULL, *record = NULL, *sysconf = NULL, *setting = NULL;
+	u32 rtc = 0, phase = 0, bias = 0;
+	int hasRTC = 0, hasPhase = 0, hasBias = 0, scriptBias = 0;
+	s64 truth = 0;
+	u32 link[3] = { 5, 0, 0 };
+	int hasTruth = 0, hasLink[3] = { 0, 0, 0 };
+	char *appArgv[16];
+	int appArgc = 0;
+	int i;
+
+	appArgv[appArgc++] = "wiirtc";
+
+	for (i = 1; i < argc; i++) {
+		const char *opt = argv[i];
+		const char *val = (i + 1 < argc) ? argv[i + 1] : NULL;
+
+		if (!strcmp(opt, "--")) {
+			for (i++; i < argc && appArgc < 15; i++) appArgv[appArgc++] = argv[i];
+			break;
+		}
+		if (!strcmp(opt, "--trace")) {
+			sim_console_set_trace(1);
+			continue;
+		}
+		if (!strcmp(opt, "--help") || !val) {
+			usage(argv[0]);
+			return !strcmp(opt, "--help") ? 0 : 2;
+		}
+
+		if (!strcmp(opt, "--script")) script = val;
+		else if (!strcmp(opt, "--record")) record = val;
+		else if (!strcmp(opt, "--sysconf")) sysconf = val;
+		else if (!strcmp(opt, "--setting")) setting = val;
+		else if (!strcmp(opt, "--save-sysconf")) __sim_save_sysconf = val;
+		else if (!strcmp(opt, "--save-setting")) __sim_save_setting = val;
+		else if (!strcmp(opt, "--rtc")) { rtc = strtoul(val, NULL, 0); hasRTC = 1; }
+		else if (!strcmp(opt, "--phase")) { phase = strtoul(val, NULL, 0); hasPhase = 1; }
+		else if (!strcmp(opt, "--bias")) { bias = strtoul(val, NULL, 0); hasBias = 1; }
+		else if (!strcmp(opt, "--name")) __sim_name = val;
+		else if (!strcmp(opt, "--json")) __sim_json = val;
+		else if (!strcmp(opt, "--thresholds")) __sim_thresholds = val;
+		else if (!strcmp(opt, "--sd")) sim_sd_set_root(val);
+		else if (!strcmp(opt, "--title")) sim_nand_set_title(strtoull(val, NULL, 16));
+		else if (!strcmp(opt, "--ntp-time")) {
+			if (sim_net_parse_time(val, &truth) < 0) {
+				usage(argv[0]);
+				return 2;
+			}
+			hasTruth = 1;
+		}
+		else if (!strcmp(opt, "--net-delay")) { link[0] = strtoul(val, NULL, 0); hasLink[0] = 1; }
+		else if (!strcmp(opt, "--net-jitter")) { link[1] = strtoul(val, NULL, 0); hasLink[1] = 1; }
+		else if (!strcmp(opt, "--net-loss")) { link[2] = strtoul(val, NULL, 0); hasLink[2] = 1; }
+		else {
+			usage(argv[0]);
+			return 2;
+		}
+		i++;
+	}
+
+	sim_out = fdopen(dup(STDOUT_FILENO), "w");
+
+	if (sim_input_open(script) < 0) {
+		fprintf(stderr, "[sim] can't open %s\n", script);
+		return 2;
+	}
+	// Command line settings win over the script's
+	{
+		u32 sRTC = rtc, sPhase = phase, sBias = bias;
+
+		sim_input_preamble(&sRTC, &sPhase, &sBias, &scriptBias);
+		if (!hasRTC) rtc = sRTC;
+		if (!hasPhase) phase = sPhase;
+		if (!hasBias) bias = sBias;
+	}
+	{
+		s64 sTruth = 0;
+		u32 sLink[3];
+		int sHasTruth = 0, sHasLink = 0;
+
+		sim_input_network(&sTruth, &sHasTruth, sLink, &sHasLink);
+		if (!hasTruth && sHasTruth) {
+			truth = sTruth;
+			hasTruth = 1;
+		}
+		for (i = 0; i < 3; i++)
+			if (!hasLink[i] && sHasLink) link[i] = sLink[i];
+	}
+	// Unless told otherwise, the server agrees with the console
+	if (!hasTruth) truth = (s64)(u32)(rtc + bias) * 1000000 + (phase % 1000) * 1000;
+	appArgc += sim_input_args(&appArgv[appArgc], 15 - appArgc);
+	appArgv[appArgc] = NULL;
+
+	if (record && sim_input_record(record, rtc, phase, bias, truth, link, &appArgv[1], appArgc - 1) < 0) {
+		fprintf(stderr, "[sim] can't write %s\n", record);
+		return 2;
+	}
+
+	sim_clock_setup(rtc, phase);
+	sim_net_set_truth(truth);
+	sim_net_set_link(link[0], link[1], link[2]);
+	sim_nand_format(bias);
+	if (sysconf && sim_nand_load(SIM_NAND_SYSCONF, sysconf) < 0) {
+		fprintf(stderr, "[sim] can't read %s\n", sysconf);
+		return 2;
+	}
+	if (setting && sim_nand_load(SIM_NAND_SETTING_TXT, setting) < 0) {
+		fprintf(stderr, "[sim] can't read %s\n", setting);
+		return 2;
+	}
+
+	// The console has no time zone; make sure the host's doesn't leak in either
+	setenv("TZ", "UTC0", 1);
+	tzset();
+
+	atexit(report);
+	return wiirtc_main(appArgc, appArgv);
+}
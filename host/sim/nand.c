@@ -0,0 +1,473 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <gccore.h>
+
+#include "sim.h"
+
+// IOS error codes the real file system hands back
+#define FS_EACCESS -102
+#define FS_ENOENT -106
+
+#define NAND_MAX_FILES 8
+#define NAND_MAX_FDS 8
+
+typedef struct _sim_file {
+	char path[64];
+	u8 *data;
+	u32 size;
+	u8 otherperm; // What a homebrew title gets: 1 read, 2 write
+} sim_file;
+
+typedef struct _sim_fd {
+	sim_file *file;
+	u32 mode;
+	u32 pos;
+} sim_fd;
+
+static sim_file __sim_files[NAND_MAX_FILES];
+static sim_fd __sim_fds[NAND_MAX_FDS];
+static u64 __sim_title = 0x000100014C554C5Aull; // The Homebrew Channel
+
+static sim_file *__sim_nand_find(const char *path, int create) {
+	int i;
+
+	for (i = 0; i < NAND_MAX_FILES; i++)
+		if (__sim_files[i].data && !strcmp(__sim_files[i].path, path)) return &__sim_files[i];
+
+	if (!create) return NULL;
+
+	for (i = 0; i < NAND_MAX_FILES; i++) {
+		if (!__sim_files[i].data) {
+			snprintf(__sim_files[i].path, sizeof(__sim_files[i].path), "%s", path);
+			return &__sim_files[i];
+		}
+	}
+	return NULL;
+}
+
+static void __sim_nand_put(const char *path, const void *data, u32 size, u8 otherperm) {
+	sim_file *file = __sim_nand_find(path, 1);
+
+	__real_free(file->data);
+	file->data = __real_malloc(size ? size : 1);
+	memcpy(file->data, data, size);
+	file->size = size;
+	file->otherperm = otherperm;
+}
+
+// SYSCONF is big-endian, the same as the console that writes it
+static void __sim_put16(u8 *p, u16 v) {
+	p[0] = v >> 8;
+	p[1] = v;
+}
+
+static void __sim_put32(u8 *p, u32 v) {
+	__sim_put16(p, v >> 16);
+	__sim_put16(p + 2, v);
+}
+
+static u16 __sim_get16(const u8 *p) {
+	return (p[0] << 8) | p[1];
+}
+
+static u32 __sim_get32(const u8 *p) {
+	return ((u32)__sim_get16(p) << 16) | __sim_get16(p + 2);
+}
+
+// A small but complete SYSCONF in place of a real console's
+typedef struct _sim_entry {
+	const char *name;
+	u8 type;
+	u16 length;
+} sim_entry;
+
+static const sim_entry __sim_default_entries[] = {
+	{ "IPL.CB", 5, 4 },
+	{ "IPL.AR", 3, 1 },
+	{ "IPL.DH", 3, 1 },
+	{ "IPL.E60", 3, 1 },
+	{ "IPL.EULA", 7, 1 },
+	{ "IPL.IDL", 2, 2 },
+	{ "IPL.LNG", 3, 1 },
+	{ "IPL.NIK", 2, 0x16 },
+	{ "IPL.PC", 2, 0x4A },
+	{ "IPL.PGS", 3, 1 },
+	{ "IPL.SND", 3, 1 },
+	{ "IPL.SSV", 3, 1 },
+	{ "BT.BAR", 3, 1 },
+	{ "BT.DINF", 1, 0x461 },
+	{ "BT.MOT", 3, 1 },
+	{ "BT.SENS", 5, 4 },
+	{ "BT.SPKV", 3, 1 },
+	{ "NET.WCFG", 5, 4 },
+};
+
+static const char __sim_default_txt[] =
+	"AREA=USA\r\n"
+	"MODEL=RVL-001(USA)\r\n"
+	"DVD=0\r\n"
+	"MPCH=0x7FFE\r\n"
+	"CODE=LU\r\n"
+	"SERNO=100000000\r\n"
+	"VIDEO=NTSC\r\n"
+	"GAME=US\r\n";
+
+void sim_nand_format(u32 bias) {
+	u8 image[0x4000];
+	char txt[0x100];
+	u16 count = sizeof(__sim_default_entries) / sizeof(__sim_default_entries[0]);
+	u16 offset = 6 + (count + 1) * 2;
+	u32 key = 0x73B5DBFA;
+	int i;
+
+	memset(image, 0, sizeof(image));
+	memcpy(image, "SCv0", 4);
+	__sim_put16(&image[4], count);
+
+	for (i = 0; i < count; i++) {
+		const sim_entry *entry = &__sim_default_entries[i];
+		u8 nlen = strlen(entry->name);
+		u16 stored = entry->length - 1;
+
+		__sim_put16(&image[6 + i * 2], offset);
+		image[offset++] = (entry->type << 5) | (nlen - 1);
+		memcpy(&image[offset], entry->name, nlen);
+		offset += nlen;
+
+		// Arrays carry their length (minus one) ahead of the data
+		if (entry->type == 1) {
+			__sim_put16(&image[offset], stored);
+			offset += 2;
+		} else if (entry->type == 2) {
+			image[offset++] = stored;
+		}
+
+		if (!strcmp(entry->name, "IPL.CB")) __sim_put32(&image[offset], bias);
+		else if (!strcmp(entry->name, "IPL.LNG")) image[offset] = 1; // English
+		else if (!strcmp(entry->name, "IPL.SND")) image[offset] = 1; // Stereo
+		else if (!strcmp(entry->name, "IPL.EULA")) image[offset] = 1;
+		offset += entry->length;
+	}
+	__sim_put16(&image[6 + count * 2], offset);
+	memcpy(&image[0x3FFC], "SCed", 4);
+
+	// setting.txt is XORed with a rotating key, same as sysconf.c undoes
+	memset(txt, 0, sizeof(txt));
+	memcpy(txt, __sim_default_txt, sizeof(__sim_default_txt) - 1);
+	for (i = 0; i < 0x100; i++) {
+		txt[i] ^= key & 0xff;
+		key = (key << 1) | (key >> 31);
+	}
+
+	__sim_nand_put(SIM_NAND_SYSCONF, image, sizeof(image), 3);
+	__sim_nand_put(SIM_NAND_SETTING_TXT, txt, sizeof(txt), 1);
+}
+
+int sim_nand_load(const char *path, const char *hostFile) {
+	FILE *fp = fopen(hostFile, "rb");
+	u8 *data;
+	long size;
+	sim_file *file;
+
+	if (!fp) return -1;
+	fseek(fp, 0, SEEK_END);
+	size = ftell(fp);
+	fseek(fp, 0, SEEK_SET);
+
+	data = __real_malloc(size ? size : 1);
+	if (fread(data, 1, size, fp) != (size_t)size) {
+		__real_free(data);
+		fclose(fp);
+		return -1;
+	}
+	fclose(fp);
+
+	file = __sim_nand_find(path, 1);
+	__sim_nand_put(path, data, size, file->otherperm ? file->otherperm : 1);
+	__real_free(data);
+	return 0;
+}
+
+int sim_nand_store(const char *path, const char *hostFile) {
+	sim_file *file = __sim_nand_find(path, 0);
+	FILE *fp;
+	int ok;
+
+	if (!file) return -1;
+	fp = fopen(hostFile, "wb");
+	if (!fp) return -1;
+	ok = fwrite(file->data, 1, file->size, fp) == file->size;
+	fclose(fp);
+	return ok ? 0 : -1;
+}
+
+int sim_nand_get_bias(u32 *bias) {
+	sim_file *file = __sim_nand_find(SIM_NAND_SYSCONF, 0);
+	u16 count, offset;
+	int i;
+
+	if (!file || file->size < 0x4000) return -1;
+
+	count = __sim_get16(&file->data[4]);
+	for (i = 0; i < count; i++) {
+		offset = __sim_get16(&file->data[6 + i * 2]);
+		if (offset + 11 <= file->size && file->data[offset] == ((5 << 5) | 5) && !memcmp(&file->data[offset + 1], "IPL.CB", 6)) {
+			*bias = __sim_get32(&file->data[offset + 7]);
+			return 0;
+		}
+	}
+	return -1;
+}
+
+void sim_nand_set_title(u64 titleID) {
+	__sim_title = titleID;
+}
+
+// IOS answers one request at a time; until this tick it is still busy with async ones
+static u64 __sim_ios_busy = 0;
+
+// A synchronous request queues behind any async ones still in IOS
+static void __sim_ios_wait(void) {
+	u64 now = sim_clock_ticks();
+
+	if (__sim_ios_busy > now) sim_clock_advance(__sim_ios_busy - now);
+}
+
+// The requests that also come in async flavours report what they cost rather than taking the time themselves
+static s32 __sim_ios_open(const char *filepath, u32 mode, u64 *cost) {
+	sim_file *file;
+	int fd;
+
+	sim_stat.ipcCalls++;
+	*cost = SIM_COST_IPC_OPEN;
+
+	file = __sim_nand_find(filepath, 0);
+	if (!file) return FS_ENOENT;
+	if ((mode & file->otherperm) != mode) return FS_EACCESS;
+
+	for (fd = 0; fd < NAND_MAX_FDS; fd++) {
+		if (!__sim_fds[fd].file) {
+			__sim_fds[fd].file = file;
+			__sim_fds[fd].mode = mode;
+			__sim_fds[fd].pos = 0;
+
+			if (mode & IPC_OPEN_WRITE) {
+				if (!strcmp(filepath, SIM_NAND_SYSCONF)) sim_stat.sysconfSaves++;
+				else if (!strcmp(filepath, SIM_NAND_SETTING_TXT)) sim_stat.settingTxtSaves++;
+			}
+			return fd;
+		}
+	}
+	return IPC_ENOHEAP;
+}
+
+static sim_fd *__sim_get_fd(s32 fd) {
+	if (fd < 0 || fd >= NAND_MAX_FDS || !__sim_fds[fd].file) return NULL;
+	return &__sim_fds[fd];
+}
+
+static s32 __sim_ios_close(s32 fd, u64 *cost) {
+	sim_fd *f = __sim_get_fd(fd);
+
+	sim_stat.ipcCalls++;
+	*cost = SIM_COST_IPC;
+	if (!f) return IPC_EINVAL;
+	f->file = NULL;
+	return IPC_OK;
+}
+
+static s32 __sim_ios_read(s32 fd, void *buf, s32 len, u64 *cost) {
+	sim_fd *f = __sim_get_fd(fd);
+
+	sim_stat.ipcCalls++;
+	*cost = SIM_COST_IPC;
+	if (!f || len < 0 || !(f->mode & IPC_OPEN_READ)) return IPC_EINVAL;
+
+	if ((u32)len > f->file->size - f->pos) len = f->file->size - f->pos;
+	memcpy(buf, &f->file->data[f->pos], len);
+	f->pos += len;
+
+	sim_stat.nandBytesRead += len;
+	*cost += len * SIM_COST_NAND_READ_BYTE;
+	return len;
+}
+
+s32 IOS_Open(const char *filepath, u32 mode) {
+	u64 cost;
+	s32 ret;
+
+	__sim_ios_wait();
+	ret = __sim_ios_open(filepath, mode, &cost);
+
+	sim_stat.nandBusyTicks += cost;
+	sim_clock_advance(cost);
+	return ret;
+}
+
+s32 IOS_Close(s32 fd) {
+	u64 cost;
+	s32 ret;
+
+	__sim_ios_wait();
+	ret = __sim_ios_close(fd, &cost);
+
+	sim_stat.nandBusyTicks += cost;
+	sim_clock_advance(cost);
+	return ret;
+}
+
+s32 IOS_Read(s32 fd, void *buf, s32 len) {
+	u64 cost;
+	s32 ret;
+
+	__sim_ios_wait();
+	ret = __sim_ios_read(fd, buf, len, &cost);
+
+	sim_stat.nandBusyTicks += cost;
+	sim_clock_advance(cost);
+	return ret;
+}
+
+s32 IOS_Seek(s32 fd, s32 where, s32 whence) {
+	sim_fd *f = __sim_get_fd(fd);
+	s64 pos;
+
+	__sim_ios_wait();
+	sim_stat.ipcCalls++;
+	sim_stat.nandBusyTicks += SIM_COST_IPC;
+	sim_clock_advance(SIM_COST_IPC);
+	if (!f) return IPC_EINVAL;
+
+	switch (whence) {
+		case SEEK_SET: pos = where; break;
+		case SEEK_CUR: pos = (s64)f->pos + where; break;
+		case SEEK_END: pos = (s64)f->file->size + where; break;
+		default: return IPC_EINVAL;
+	}
+	if (pos < 0 || pos > f->file->size) return IPC_EINVAL;
+
+	f->pos = pos;
+	return pos;
+}
+
+s32 IOS_Write(s32 fd, const void *buf, s32 len) {
+	sim_fd *f = __sim_get_fd(fd);
+
+	__sim_ios_wait();
+	sim_stat.ipcCalls++;
+	sim_stat.nandBusyTicks += SIM_COST_IPC;
+	sim_clock_advance(SIM_COST_IPC);
+	if (!f || len < 0 || !(f->mode & IPC_OPEN_WRITE)) return IPC_EINVAL;
+
+	// Files on the Wii never grow through a plain write
+	if ((u32)len > f->file->size - f->pos) len = f->file->size - f->pos;
+	memcpy(&f->file->data[f->pos], buf, len);
+	f->pos += len;
+
+	sim_stat.nandWrites++;
+	sim_stat.nandBytesWritten += len;
+	sim_stat.nandBusyTicks += len * SIM_COST_NAND_WRITE_BYTE;
+	sim_clock_advance(len * SIM_COST_NAND_WRITE_BYTE);
+	return len;
+}
+
+/*
+ * Async requests. The work is done on the spot, but IOS answers one request at a time, so each
+ * completes once the ones before it have and its own cost has passed. The PowerPC carries on
+ * meanwhile; the callback runs as the clock passes the completion, the way the IPC interrupt would.
+ */
+#define SIM_MAX_ASYNC 8
+
+typedef struct _sim_async {
+	u64 at;
+	s32 result;
+	ipccallback cb;
+	void *usrdata;
+} sim_async;
+
+static sim_async __sim_async[SIM_MAX_ASYNC];
+static int __sim_async_count = 0;
+static int __sim_async_firing = 0;
+
+static s32 __sim_async_queue(s32 result, u64 cost, ipccallback cb, void *usrdata) {
+	u64 now = sim_clock_ticks();
+
+	if (__sim_async_count == SIM_MAX_ASYNC) return IPC_EQUEUEFULL;
+
+	if (__sim_ios_busy < now) __sim_ios_busy = now;
+	__sim_ios_busy += cost;
+	sim_stat.nandBusyTicks += cost;
+
+	__sim_async[__sim_async_count].at = __sim_ios_busy;
+	__sim_async[__sim_async_count].result = result;
+	__sim_async[__sim_async_count].cb = cb;
+	__sim_async[__sim_async_count].usrdata = usrdata;
+	__sim_async_count++;
+	return IPC_OK;
+}
+
+s32 IOS_OpenAsync(const char *filepath, u32 mode, ipccallback ipc_cb, void *usrdata) {
+	u64 cost;
+	s32 ret = __sim_ios_open(filepath, mode, &cost);
+
+	return __sim_async_queue(ret, cost, ipc_cb, usrdata);
+}
+
+s32 IOS_CloseAsync(s32 fd, ipccallback ipc_cb, void *usrdata) {
+	u64 cost;
+	s32 ret = __sim_ios_close(fd, &cost);
+
+	return __sim_async_queue(ret, cost, ipc_cb, usrdata);
+}
+
+s32 IOS_ReadAsync(s32 fd, void *buf, s32 len, ipccallback ipc_cb, void *usrdata) {
+	u64 cost;
+	s32 ret = __sim_ios_read(fd, buf, len, &cost);
+
+	return __sim_async_queue(ret, cost, ipc_cb, usrdata);
+}
+
+// When the next async request completes, if any is outstanding
+int sim_ipc_next(u64 *at) {
+	if (!__sim_async_count) return 0;
+	*at = __sim_async[0].at;
+	return 1;
+}
+
+// Runs the callback of every request complete by now; requests complete in the order they went in
+void sim_ipc_poll(void) {
+	sim_async done;
+
+	if (__sim_async_firing) return;
+	__sim_async_firing = 1;
+	while (__sim_async_count && __sim_async[0].at <= sim_clock_ticks()) {
+		done = __sim_async[0];
+		__sim_async_count--;
+		memmove(&__sim_async[0], &__sim_async[1], __sim_async_count * sizeof(sim_async));
+		if (done.cb) done.cb(done.result, done.usrdata);
+	}
+	__sim_async_firing = 0;
+}
+
+s32 ISFS_SetAttr(const char *filepath, u32 ownerID, u16 groupID, u8 attributes, u8 ownerperm, u8 groupperm, u8 otherperm) {
+	sim_file *file;
+
+	__sim_ios_wait();
+	sim_stat.ipcCalls++;
+	sim_clock_advance(SIM_COST_IPC);
+
+	file = __sim_nand_find(filepath, 0);
+	if (!file) return FS_ENOENT;
+	file->otherperm = otherperm;
+	return ISFS_OK;
+}
+
+s32 ES_GetTitleID(u64 *titleID) {
+	__sim_ios_wait();
+	sim_stat.ipcCalls++;
+	sim_clock_advance(SIM_COST_IPC);
+	*titleID = __sim_title;
+	return 0;
+}
@@ -0,0 +1,288 @@
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <network.h>
+#include <ogc/lwp_watchdog.h>
+
+#include "sim.h"
+
+/*
+ * The network, with a stand-in SNTP server on it that answers on port 123 of any address.
+ *
+ * The server's clock is the true time of the simulation: sim_net_set_truth says what it read
+ * at power on, and from there it runs on the virtual timebase. Knowing the truth is what lets
+ * the run report how far off the console's clock was left, see sim_net_error_us.
+ *
+ * Each packet takes the base one-way delay plus up to the jitter on top, and some may be lost.
+ * The jitter and losses come from a fixed sequence, so a run stays the same every time.
+ */
+#define SIM_NET_SOCKETS 4
+#define SIM_NET_QUEUE 8
+#define SIM_NET_PACKET 48
+#define SIM_NET_SERVER_PORT 123
+#define SIM_NET_SERVER_ADDR 0x0a00007b  // 10.0.0.123, what any name resolves to
+#define SIM_NTP_TO_GC_EPOCH 3155673600ull // Seconds from 1900-01-01, where NTP counts from, to 2000-01-01
+#define SIM_GC_TO_UNIX_EPOCH 946684800ll
+
+typedef struct _sim_packet {
+	u64 arrives;
+	u32 from;
+	u8 data[SIM_NET_PACKET];
+} sim_packet;
+
+typedef struct _sim_socket {
+	int open;
+	int count;
+	sim_packet queue[SIM_NET_QUEUE];
+} sim_socket;
+
+static sim_socket __sim_sockets[SIM_NET_SOCKETS];
+static int __sim_net_up = 0;
+static s64 __sim_truth_us = 0; // The true time at tick 0, in microseconds since 2000-01-01
+static u32 __sim_delay_us = 5000, __sim_jitter_us = 0, __sim_loss_percent = 0;
+static u32 __sim_random = 12345;
+
+static struct hostent __sim_host;
+static struct in_addr __sim_host_addr;
+static char *__sim_host_list[2] = { (char *)&__sim_host_addr, NULL };
+
+void sim_net_set_truth(s64 us) {
+	__sim_truth_us = us;
+}
+
+// "SECONDS[.FRACTION]" since 2000-01-01, to the microsecond
+int sim_net_parse_time(const char *s, s64 *us) {
+	char *end;
+	s64 value = strtoll(s, &end, 10) * 1000000;
+	s32 scale = 100000;
+
+	if (end == s) return -1;
+	if (*end == '.') {
+		for (end++; *end >= '0' && *end <= '9'; end++, scale /= 10) value += (*end - '0') * scale;
+	}
+	if (*end) return -1;
+
+	*us = value;
+	return 0;
+}
+
+void sim_net_set_link(u32 delayMs, u32 jitterMs, u32 lossPercent) {
+	__sim_delay_us = delayMs * 1000;
+	__sim_jitter_us = jitterMs * 1000;
+	__sim_loss_percent = lossPercent;
+}
+
+static u32 __sim_net_next(void) {
+	__sim_random = __sim_random * 1103515245 + 12345;
+	return (__sim_random >> 16) & 0x7fff;
+}
+
+static u64 __sim_net_delay(void) {
+	u32 us = __sim_delay_us;
+
+	if (__sim_jitter_us) us += __sim_net_next() % (__sim_jitter_us + 1);
+	return microsecs_to_ticks(us);
+}
+
+static s64 __sim_net_truth(u64 ticks) {
+	return __sim_truth_us + (s64)ticks_to_microsecs(ticks);
+}
+
+static void __sim_net_store_time(u8 *p, s64 us) {
+	u64 secs = us / 1000000 + SIM_NTP_TO_GC_EPOCH;
+	u32 frac = (u32)(((u64)(us % 1000000) << 32) / 1000000);
+	int i;
+
+	for (i = 0; i < 4; i++) p[i] = secs >> (24 - i * 8);
+	for (i = 0; i < 4; i++) p[4 + i] = frac >> (24 - i * 8);
+}
+
+// How far the clock the console shows is from the true time, given the IPL.CB it has now.
+// The two run at the same rate, so this is the same at any moment
+s64 sim_net_error_us(u32 bias) {
+	s64 shown = (s64)(u32)(sim_clock_rtc() + bias) * 1000000 + ticks_to_microsecs(sim_clock_since_rtc_tick());
+
+	return shown - __sim_net_truth(sim_clock_ticks());
+}
+
+// How far an SNTP client's idea of Unix time less the timebase is from the truth
+s64 sim_net_offset_error_us(s64 offsetUs) {
+	return offsetUs - (__sim_truth_us + (s64)SIM_GC_TO_UNIX_EPOCH * 1000000);
+}
+
+s32 net_init(void) {
+	sim_clock_advance(SIM_COST_NET_INIT);
+	sim_stat.ipcCalls++;
+	__sim_net_up = 1;
+	return 0;
+}
+
+void net_deinit(void) {
+	__sim_net_up = 0;
+}
+
+s32 inet_aton(const char *cp, struct in_addr *addr) {
+	unsigned a, b, c, d;
+	char end;
+
+	if (sscanf(cp, "%u.%u.%u.%u%c", &a, &b, &c, &d, &end) != 4 || a > 255 || b > 255 || c > 255 || d > 255) return 0;
+	addr->s_addr = (a << 24) | (b << 16) | (c << 8) | d;
+	return 1;
+}
+
+struct hostent *net_gethostbyname(const char *addrString) {
+	if (!__sim_net_up) return NULL;
+
+	sim_clock_advance(SIM_COST_DNS);
+	sim_stat.ipcCalls++;
+	if (!inet_aton(addrString, &__sim_host_addr)) __sim_host_addr.s_addr = SIM_NET_SERVER_ADDR;
+
+	__sim_host.h_name = (char *)addrString;
+	__sim_host.h_addrtype = AF_INET;
+	__sim_host.h_length = sizeof(__sim_host_addr);
+	__sim_host.h_addr_list = __sim_host_list;
+	return &__sim_host;
+}
+
+s32 net_socket(u32 domain, u32 type, u32 protocol) {
+	int i;
+
+	sim_clock_advance(SIM_COST_IPC);
+	sim_stat.ipcCalls++;
+	if (!__sim_net_up) return -ENETDOWN;
+	if (domain != AF_INET || type != SOCK_DGRAM) return -EPROTONOSUPPORT;
+
+	for (i = 0; i < SIM_NET_SOCKETS; i++) {
+		if (!__sim_sockets[i].open) {
+			__sim_sockets[i].open = 1;
+			__sim_sockets[i].count = 0;
+			return i;
+		}
+	}
+	return -EMFILE;
+}
+
+s32 net_close(s32 s) {
+	sim_clock_advance(SIM_COST_IPC);
+	sim_stat.ipcCalls++;
+	if (s < 0 || s >= SIM_NET_SOCKETS || !__sim_sockets[s].open) return -EBADF;
+	__sim_sockets[s].open = 0;
+	return 0;
+}
+
+// The stand-in server: stamps the request as it arrives and sends it back as a stratum 2 reply
+static void __sim_net_serve(sim_socket *sock, const u8 *request, u32 to) {
+	u64 arrives = sim_clock_ticks() + __sim_net_delay();
+	sim_packet *reply;
+
+	if (__sim_loss_percent && __sim_net_next() % 100 < __sim_loss_percent) return;
+	if ((request[0] & 7) != 3 || sock->count == SIM_NET_QUEUE) return;
+
+	reply = &sock->queue[sock->count++];
+	memset(reply->data, 0, SIM_NET_PACKET);
+	reply->data[0] = (request[0] & 0x38) | 4; // Same version, no leap second warning, server mode
+	reply->data[1] = 2;
+	reply->data[2] = request[2];
+	reply->data[3] = (u8)-20; // About a microsecond
+	memcpy(&reply->data[12], "SIM", 4);
+	__sim_net_store_time(&reply->data[16], __sim_net_truth(arrives) - 16000000);
+	memcpy(&reply->data[24], &request[40], 8);
+	__sim_net_store_time(&reply->data[32], __sim_net_truth(arrives));
+	arrives += SIM_COST_NTP_SERVER;
+	__sim_net_store_time(&reply->data[40], __sim_net_truth(arrives));
+
+	reply->arrives = arrives + __sim_net_delay();
+	reply->from = to;
+	sim_stat.ntpRequests++;
+}
+
+s32 net_sendto(s32 s, const void *data, s32 len, u32 flags, struct sockaddr *to, socklen_t tolen) {
+	struct sockaddr_in *addr = (struct sockaddr_in *)to;
+
+	sim_clock_advance(SIM_COST_IPC);
+	sim_stat.ipcCalls++;
+	if (s < 0 || s >= SIM_NET_SOCKETS || !__sim_sockets[s].open) return -EBADF;
+	if (!addr || tolen < sizeof(*addr) || addr->sin_family != AF_INET) return -EINVAL;
+
+	// Anything not for the server's port just goes nowhere, like it would on a real network
+	if (addr->sin_port == SIM_NET_SERVER_PORT && len >= SIM_NET_PACKET) __sim_net_serve(&__sim_sockets[s], data, addr->sin_addr.s_addr);
+	return len;
+}
+
+// The packet on the socket that arrives first, or -1
+static int __sim_net_first(sim_socket *sock) {
+	int i, first = -1;
+
+	for (i = 0; i < sock->count; i++)
+		if (first < 0 || sock->queue[i].arrives < sock->queue[first].arrives) first = i;
+	return first;
+}
+
+s32 net_poll(struct pollsd *sds, s32 nsds, s32 timeout) {
+	u64 deadline = timeout >= 0 ? sim_clock_ticks() + millisecs_to_ticks(timeout) : (u64)-1;
+	int i, ready;
+
+	sim_clock_advance(SIM_COST_IPC);
+	sim_stat.ipcCalls++;
+
+	while (1) {
+		u64 next = deadline;
+
+		ready = 0;
+		for (i = 0; i < nsds; i++) {
+			sim_socket *sock;
+			int first;
+
+			sds[i].revents = 0;
+			if (sds[i].socket < 0 || sds[i].socket >= SIM_NET_SOCKETS) continue;
+			sock = &__sim_sockets[sds[i].socket];
+			first = __sim_net_first(sock);
+			if (first < 0) continue;
+
+			if (sock->queue[first].arrives <= sim_clock_ticks()) {
+				sds[i].revents = sds[i].events & POLLIN;
+				if (sds[i].revents) ready++;
+			} else if (sock->queue[first].arrives < next) {
+				next = sock->queue[first].arrives;
+			}
+		}
+
+		// Sleep until the next packet lands or the time is up
+		if (ready || (timeout >= 0 && sim_clock_ticks() >= deadline)) return ready;
+		if (timeout < 0 && next == deadline) return -EAGAIN; // Nothing will ever come
+		sim_clock_advance(next - sim_clock_ticks());
+	}
+}
+
+s32 net_recvfrom(s32 s, void *mem, s32 len, u32 flags, struct sockaddr *from, socklen_t *fromlen) {
+	struct pollsd sd = { s, POLLIN, 0 };
+	sim_socket *sock;
+	int first;
+
+	if (s < 0 || s >= SIM_NET_SOCKETS || !__sim_sockets[s].open) return -EBADF;
+	sock = &__sim_sockets[s];
+
+	// Blocks until a packet is in, as the console's does
+	if (net_poll(&sd, 1, -1) <= 0) return -EAGAIN;
+	sim_clock_advance(SIM_COST_IPC);
+	sim_stat.ipcCalls++;
+
+	first = __sim_net_first(sock);
+	if (len > SIM_NET_PACKET) len = SIM_NET_PACKET;
+	memcpy(mem, sock->queue[first].data, len);
+	if (from && fromlen && *fromlen >= sizeof(struct sockaddr_in)) {
+		struct sockaddr_in *addr = (struct sockaddr_in *)from;
+
+		memset(addr, 0, sizeof(*addr));
+		addr->sin_len = sizeof(*addr);
+		addr->sin_family = AF_INET;
+		addr->sin_port = SIM_NET_SERVER_PORT;
+		addr->sin_addr.s_addr = sock->queue[first].from;
+		*fromlen = sizeof(*addr);
+	}
+
+	sock->queue[first] = sock->queue[--sock->count];
+	return len;
+}
@@ -0,0 +1,38 @@
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/stat.h>
+
+#include <fat.h>
+
+#include "sim.h"
+
+// The host directory standing in for the SD card root
+static const char *__sim_sd_root = "sd";
+
+FILE *__real_fopen(const char *path, const char *mode);
+
+void sim_sd_set_root(const char *root) {
+	__sim_sd_root = root;
+}
+
+// Maps "sd:/x" to "<root>/x"; anything else passes through untouched
+const char *sim_sd_path(const char *path, char *buf, size_t size) {
+	if (strncmp(path, "sd:/", 4)) return path;
+
+	snprintf(buf, size, "%s/%s", __sim_sd_root, path + 4);
+	return buf;
+}
+
+bool fatInitDefault(void) {
+	struct stat st;
+
+	return stat(__sim_sd_root, &st) == 0 && S_ISDIR(st.st_mode);
+}
+
+// Linked in place of fopen with --wrap, so the program's own sd:/ paths just work
+FILE *__wrap_fopen(const char *path, const char *mode) {
+	char buf[512];
+
+	return __real_fopen(sim_sd_path(path, buf, sizeof(buf)), mode);
+}
@@ -0,0 +1,109 @@
+#ifndef __SIM_H__
+#define __SIM_H__
+
+#include <stdio.h>
+
+#include <gctypes.h>
+
+// Rough costs of the hardware operations the simulator stands in for, in timebase ticks.
+// They only need to be plausible and, above all, the same on every run.
+#define SIM_COST_GETTIME microsecs_to_ticks(1)
+#define SIM_COST_RTC_READ microsecs_to_ticks(12) // One EXI transfer of the RTC counter; __SYS_GetRTC does at least two
+#define SIM_COST_IPC microsecs_to_ticks(150)     // IPC round trip to IOS with no data
+#define SIM_COST_IPC_OPEN microsecs_to_ticks(600)
+#define SIM_COST_NAND_READ_BYTE nanosecs_to_ticks(500)
+#define SIM_COST_NAND_WRITE_BYTE nanosecs_to_ticks(2000)
+#define SIM_COST_NET_INIT millisecs_to_ticks(2000) // Bringing up the Wi-Fi link and DHCP
+#define SIM_COST_DNS millisecs_to_ticks(20)
+#define SIM_COST_NTP_SERVER microsecs_to_ticks(50)  // Between the server's receive and transmit stamps
+#define SIM_COST_WPAD_SCAN microsecs_to_ticks(20)   // Rough figures for the controller scans and one console glyph,
+#define SIM_COST_PAD_SCAN microsecs_to_ticks(5)     // enough that they show up in a frame's time
+#define SIM_COST_GLYPH nanosecs_to_ticks(500)
+
+// The simulator's own memory isn't wiirtc's, so it allocates past footprint.c's counting wrappers
+void *__real_malloc(size_t size);
+void *__real_realloc(void *ptr, size_t size);
+void __real_free(void *ptr);
+
+// NTSC field rate, 60000/1001 Hz, kept as a fraction of ticks so frames never drift
+#define SIM_FRAME_TICKS_NUM (TB_TIMER_CLOCK * 1000ull * 1001)
+#define SIM_FRAME_TICKS_DEN 60000ull
+
+typedef struct _sim_stats {
+	u64 frames;           // VIDEO_WaitVSync calls
+	u64 vsyncPeriods;     // Display periods elapsed, including ones missed by slow frames
+	u64 presses;          // Frames with any button newly pressed
+	u64 rtcReads;         // __SYS_GetRTC calls
+	u64 rtcRetries;       // Extra RTC read pairs because the counter ticked mid-read
+	u64 ipcCalls;
+	u64 nandBytesRead;
+	u64 nandBytesWritten;
+	u64 nandWrites;       // IOS_Write calls
+	u64 sysconfSaves;     // Opens of SYSCONF for writing
+	u64 settingTxtSaves;  // Opens of setting.txt for writing
+	u64 ntpRequests;      // Requests the stand-in SNTP server answered
+	u64 nandBusyTicks;    // Time IOS spent on file requests, async ones included
+} sim_stats;
+
+extern sim_stats sim_stat;
+extern FILE *sim_out; // The real stdout; stdout itself belongs to the simulated console
+
+/* clock.c */
+void sim_clock_setup(u32 rtc, u32 phaseMs);
+void sim_clock_advance(u64 ticks);
+void sim_clock_set(u64 ticks);
+u64 sim_clock_ticks(void);
+u32 sim_clock_rtc(void);
+u64 sim_clock_since_rtc_tick(void);
+void sim_clock_wait_vsync(void);
+
+/* thread.c */
+void sim_thread_run(u64 until);
+void sim_thread_preempt(void);
+
+/* video.c */
+void sim_console_dump(FILE *fp);
+void sim_console_set_trace(int trace);
+void sim_console_frame(u64 frame);
+
+/* input.c */
+int sim_input_open(const char *script);
+int sim_input_record(const char *path, u32 rtc, u32 phaseMs, u32 bias, s64 truthUs, const u32 *link, char **args, int argCount);
+void sim_input_close(void);
+int sim_input_preamble(u32 *rtc, u32 *phaseMs, u32 *bias, int *hasBias);
+int sim_input_network(s64 *truthUs, int *hasTruth, u32 *link, int *hasLink);
+int sim_input_args(char **argv, int max);
+
+/* view.c */
+void sim_view_check(const char *name);
+
+/* bench.c */
+void sim_bench_frame_end(void);
+void sim_bench_frame_start(void);
+int sim_bench_write_json(const char *path, const char *name);
+int sim_bench_check(const char *path, const char *name);
+
+/* sd.c */
+void sim_sd_set_root(const char *root);
+const char *sim_sd_path(const char *path, char *buf, size_t size);
+
+/* net.c */
+int sim_net_parse_time(const char *s, s64 *us);
+void sim_net_set_truth(s64 us);
+void sim_net_set_link(u32 delayMs, u32 jitterMs, u32 lossPercent);
+s64 sim_net_error_us(u32 bias);
+s64 sim_net_offset_error_us(s64 offsetUs);
+
+/* nand.c */
+#define SIM_NAND_SYSCONF "/shared2/sys/SYSCONF"
+#define SIM_NAND_SETTING_TXT "/title/00000001/00000002/data/setting.txt"
+
+int sim_nand_load(const char *path, const char *hostFile);
+int sim_nand_store(const char *path, const char *hostFile);
+void sim_nand_format(u32 bias);
+int sim_nand_get_bias(u32 *bias);
+void sim_nand_set_title(u64 titleID);
+int sim_ipc_next(u64 *at);
+void sim_ipc_poll(void);
+
+#endif
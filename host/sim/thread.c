@@ -0,0 +1,235 @@
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <ogc/cond.h>
+#include <ogc/lwp.h>
+
+#include "sim.h"
+
+/*
+ * LWP threads and condition variables, run strictly one at a time so a run stays the same every time.
+ *
+ * The main thread runs until it waits for a vsync or on a condition. Only then do the other threads
+ * get to run, the way a lower-priority thread on the console only gets the CPU while the main one
+ * sleeps. Each keeps its own virtual clock: during a vsync wait they may run up to the vsync and no
+ * further, so their IOS calls overlap the main thread's frame instead of stretching it.
+ *
+ * IPC completions are events on the same timeline: they fire in order with the other threads.
+ *
+ * A thread must not hold a mutex across anything that takes virtual time, as it can be put to
+ * sleep there with the main thread about to want the same mutex.
+ */
+#define SIM_MAX_THREADS 8
+
+enum { SIM_THREAD_FREE, SIM_THREAD_READY, SIM_THREAD_WAITING, SIM_THREAD_DONE };
+
+typedef struct _sim_thread {
+	pthread_t thread;
+	pthread_cond_t go;
+	int state;
+	cond_t cond; // What a waiting thread waits on
+	u64 ticks;   // Its virtual clock while someone else is running
+	void *(*entry)(void *);
+	void *arg;
+} sim_thread;
+
+static sim_thread __sim_threads[SIM_MAX_THREADS]; // [0] is the main thread
+static pthread_mutex_t __sim_baton = PTHREAD_MUTEX_INITIALIZER; // Held by whichever thread is running
+static int __sim_current = 0;
+static int __sim_started = 0;
+static u64 __sim_horizon = ~0ull;
+static cond_t __sim_conds = 0;
+
+static void __sim_thread_setup(void) {
+	if (__sim_started) return;
+	pthread_cond_init(&__sim_threads[0].go, NULL);
+	__sim_threads[0].state = SIM_THREAD_READY;
+	pthread_mutex_lock(&__sim_baton);
+	__sim_started = 1;
+}
+
+// Hands the virtual CPU to another thread and sleeps until it comes back
+static void __sim_thread_switch(int to) {
+	int self = __sim_current;
+
+	__sim_threads[self].ticks = sim_clock_ticks();
+	__sim_current = to;
+	sim_clock_set(__sim_threads[to].ticks);
+	pthread_cond_signal(&__sim_threads[to].go);
+	while (__sim_current != self) pthread_cond_wait(&__sim_threads[self].go, &__sim_baton);
+}
+
+// The ready thread furthest behind, if it is behind until
+static int __sim_thread_next(u64 until) {
+	int i, next = -1;
+
+	for (i = 1; i < SIM_MAX_THREADS; i++) {
+		if (__sim_threads[i].state != SIM_THREAD_READY || __sim_threads[i].ticks >= until) continue;
+		if (next < 0 || __sim_threads[i].ticks < __sim_threads[next].ticks) next = i;
+	}
+	return next;
+}
+
+// Runs whatever happens next before until: the ready thread furthest behind, or an IPC completion
+static int __sim_thread_step(u64 until) {
+	int next = __sim_thread_next(until);
+	u64 at;
+
+	if (sim_ipc_next(&at) && at < until && (next < 0 || at <= __sim_threads[next].ticks)) {
+		// The interrupt arrives while the main thread sleeps
+		if (sim_clock_ticks() < at) sim_clock_set(at);
+		sim_ipc_poll();
+		return 1;
+	}
+	if (next < 0) return 0;
+
+	__sim_thread_switch(next);
+	return 1;
+}
+
+// Puts the running thread to sleep on a condition or queue until something wakes it
+static void __sim_thread_block(u32 cond) {
+	int self = __sim_current;
+
+	__sim_threads[self].state = SIM_THREAD_WAITING;
+	__sim_threads[self].cond = cond;
+
+	if (self) {
+		__sim_thread_switch(0);
+		return;
+	}
+
+	// The main thread has nothing to do until it is woken, so everything else runs unbounded
+	while (__sim_threads[0].state == SIM_THREAD_WAITING) {
+		if (!__sim_thread_step(~0ull)) {
+			fprintf(stderr, "[sim] every thread is waiting and no IPC request is outstanding\n");
+			abort();
+		}
+	}
+}
+
+static void *__sim_thread_main(void *arg) {
+	int self = (int)(long)arg;
+
+	pthread_mutex_lock(&__sim_baton);
+	while (__sim_current != self) pthread_cond_wait(&__sim_threads[self].go, &__sim_baton);
+
+	__sim_threads[self].entry(__sim_threads[self].arg);
+
+	__sim_threads[self].state = SIM_THREAD_DONE;
+	__sim_threads[self].ticks = sim_clock_ticks();
+	__sim_current = 0;
+	sim_clock_set(__sim_threads[0].ticks);
+	pthread_cond_signal(&__sim_threads[0].go);
+	pthread_mutex_unlock(&__sim_baton);
+	return NULL;
+}
+
+// Called by the main thread while it waits for the vsync at until
+void sim_thread_run(u64 until) {
+	__sim_thread_setup();
+
+	__sim_horizon = until;
+	while (__sim_thread_step(until))
+		;
+	__sim_horizon = ~0ull;
+}
+
+// Called whenever virtual time moves; a thread that has caught up with the vsync gives way
+void sim_thread_preempt(void) {
+	if (__sim_current && sim_clock_ticks() >= __sim_horizon) __sim_thread_switch(0);
+}
+
+s32 LWP_CreateThread(lwp_t *thethread, void *(*entry)(void *), void *arg, void *stackbase, u32 stack_size, u8 prio) {
+	sim_thread *t;
+	int i;
+
+	__sim_thread_setup();
+
+	for (i = 1; i < SIM_MAX_THREADS && __sim_threads[i].state != SIM_THREAD_FREE; i++)
+		;
+	if (i == SIM_MAX_THREADS) return -1;
+
+	// Every thread created here runs below the main thread, so it starts at the next wait
+	t = &__sim_threads[i];
+	pthread_cond_init(&t->go, NULL);
+	t->state = SIM_THREAD_READY;
+	t->ticks = sim_clock_ticks();
+	t->entry = entry;
+	t->arg = arg;
+	if (pthread_create(&t->thread, NULL, __sim_thread_main, (void *)(long)i)) {
+		t->state = SIM_THREAD_FREE;
+		return -1;
+	}
+
+	*thethread = i;
+	return 0;
+}
+
+// The main thread is 0, the others the handles LWP_CreateThread gave out
+lwp_t LWP_GetSelf(void) {
+	return __sim_current;
+}
+
+s32 LWP_CondInit(cond_t *cond) {
+	*cond = ++__sim_conds;
+	return 0;
+}
+
+s32 LWP_CondDestroy(cond_t cond) {
+	return 0;
+}
+
+s32 LWP_CondWait(cond_t cond, mutex_t mutex) {
+	__sim_thread_setup();
+
+	LWP_MutexUnlock(mutex);
+	__sim_thread_block(cond);
+	return LWP_MutexLock(mutex);
+}
+
+// A woken thread carries on from whenever it was woken, if that is later than where it stopped
+static s32 __sim_cond_wake(cond_t cond, int all) {
+	u64 now = sim_clock_ticks();
+	int i;
+
+	for (i = 0; i < SIM_MAX_THREADS; i++) {
+		if (__sim_threads[i].state != SIM_THREAD_WAITING || __sim_threads[i].cond != cond) continue;
+		__sim_threads[i].state = SIM_THREAD_READY;
+		if (__sim_threads[i].ticks < now) __sim_threads[i].ticks = now;
+		if (!all) break;
+	}
+	return 0;
+}
+
+s32 LWP_CondSignal(cond_t cond) {
+	return __sim_cond_wake(cond, 0);
+}
+
+s32 LWP_CondBroadcast(cond_t cond) {
+	return __sim_cond_wake(cond, 1);
+}
+
+// Thread queues share the conditions' handles and wake-ups; they just come without a mutex
+s32 LWP_InitQueue(lwpq_t *thequeue) {
+	*thequeue = ++__sim_conds;
+	return 0;
+}
+
+void LWP_CloseQueue(lwpq_t thequeue) {
+}
+
+s32 LWP_ThreadSleep(lwpq_t thequeue) {
+	__sim_thread_setup();
+	__sim_thread_block(thequeue);
+	return 0;
+}
+
+void LWP_ThreadSignal(lwpq_t thequeue) {
+	__sim_cond_wake(thequeue, 0);
+}
+
+void LWP_ThreadBroadcast(lwpq_t thequeue) {
+	__sim_cond_wake(thequeue, 1);
+}
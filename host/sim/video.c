@@ -0,0 +1,189 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <gccore.h>
+
+#include "sim.h"
+
+// Same glyph size as libogc's console font
+#define FONT_XSIZE 8
+#define FONT_YSIZE 16
+
+#define CONSOLE_MAX_COLS 128
+#define CONSOLE_MAX_ROWS 64
+
+static GXRModeObj __sim_rmode = {
+	VI_TVMODE_NTSC_INT, // viTVMode
+	640,                // fbWidth
+	480,                // efbHeight
+	480,                // xfbHeight
+	40,                 // viXOrigin
+	0,                  // viYOrigin
+	640,                // viWidth
+	480,                // viHeight
+	1,                  // xfbMode
+	0,                  // field_rendering
+	0,                  // aa
+};
+
+// The framebuffer is a character grid rather than pixels: what the console would have drawn, as text
+static char __sim_screen[CONSOLE_MAX_ROWS][CONSOLE_MAX_COLS + 1];
+static int __sim_cols = 0, __sim_rows = 0;
+static int __sim_col = 0, __sim_row = 0;
+static int __sim_dirty = 0;
+static int __sim_trace = 0;
+
+// Escape sequence parser state
+static int __sim_esc = 0;
+static int __sim_esc_arg = 0;
+
+static void __sim_clear(void) {
+	int row;
+
+	for (row = 0; row < __sim_rows; row++) {
+		memset(__sim_screen[row], ' ', __sim_cols);
+		__sim_screen[row][__sim_cols] = 0;
+	}
+	__sim_col = __sim_row = 0;
+}
+
+static void __sim_newline(void) {
+	__sim_col = 0;
+	if (++__sim_row < __sim_rows) return;
+
+	memmove(__sim_screen[0], __sim_screen[1], sizeof(__sim_screen[0]) * (__sim_rows - 1));
+	memset(__sim_screen[__sim_rows - 1], ' ', __sim_cols);
+	__sim_row = __sim_rows - 1;
+}
+
+static void __sim_putc(char c) {
+	if (__sim_esc == 1) {
+		__sim_esc = (c == '[') ? 2 : 0;
+		return;
+	}
+	if (__sim_esc == 2) {
+		if (c >= '0' && c <= '9') {
+			__sim_esc_arg = __sim_esc_arg * 10 + (c - '0');
+			return;
+		}
+		if (c == ';') return;
+
+		// Colours don't survive into ASCII, but clearing and homing do
+		if (c == 'J' && __sim_esc_arg == 2) __sim_clear();
+		else if (c == 'H') __sim_col = __sim_row = 0;
+		else if (c == 'K') memset(&__sim_screen[__sim_row][__sim_col], ' ', __sim_cols - __sim_col);
+		__sim_esc = 0;
+		return;
+	}
+
+	switch (c) {
+		case '\e':
+			__sim_esc = 1;
+			__sim_esc_arg = 0;
+			return;
+		case '\r':
+			__sim_col = 0;
+			return;
+		case '\n':
+			__sim_newline();
+			break;
+		case '\t':
+			__sim_col = (__sim_col + 8) & ~7;
+			if (__sim_col >= __sim_cols) __sim_newline();
+			break;
+		default:
+			if (__sim_col >= __sim_cols) __sim_newline();
+			__sim_screen[__sim_row][__sim_col++] = c;
+			sim_clock_advance(SIM_COST_GLYPH);
+	}
+	__sim_dirty = 1;
+}
+
+static ssize_t __sim_console_write(void *cookie, const char *buf, size_t size) {
+	size_t i;
+
+	for (i = 0; i < size; i++)
+		__sim_putc(buf[i]);
+	return size;
+}
+
+void console_init(void *framebuffer, int xstart, int ystart, int xres, int yres, int stride) {
+	cookie_io_functions_t io = { NULL, __sim_console_write, NULL, NULL };
+	FILE *console;
+
+	__sim_cols = (xres - xstart) / FONT_XSIZE;
+	__sim_rows = (yres - ystart) / FONT_YSIZE;
+	if (__sim_cols > CONSOLE_MAX_COLS) __sim_cols = CONSOLE_MAX_COLS;
+	if (__sim_rows > CONSOLE_MAX_ROWS) __sim_rows = CONSOLE_MAX_ROWS;
+	__sim_clear();
+
+	// Like libogc, the console takes over stdout
+	console = fopencookie(NULL, "w", io);
+	setvbuf(console, NULL, _IONBF, 0);
+	stdout = console;
+}
+
+void sim_console_dump(FILE *fp) {
+	int row, last = 0;
+	char line[CONSOLE_MAX_COLS + 1];
+
+	fflush(stdout);
+
+	for (row = 0; row < __sim_rows; row++)
+		if (strspn(__sim_screen[row], " ") != (size_t)__sim_cols) last = row + 1;
+
+	for (row = 0; row < last; row++) {
+		int len = __sim_cols;
+
+		memcpy(line, __sim_screen[row], __sim_cols + 1);
+		while (len > 0 && line[len - 1] == ' ') line[--len] = 0;
+		fprintf(fp, "%s\n", line);
+	}
+}
+
+void sim_console_set_trace(int trace) {
+	__sim_trace = trace;
+}
+
+void sim_console_frame(u64 frame) {
+	if (!__sim_trace || !__sim_dirty) return;
+
+	fprintf(sim_out, "--- frame %llu ---\n", (unsigned long long)frame);
+	sim_console_dump(sim_out);
+	__sim_dirty = 0;
+}
+
+void VIDEO_Init(void) {
+}
+
+GXRModeObj *VIDEO_GetPreferredMode(GXRModeObj *mode) {
+	return &__sim_rmode;
+}
+
+void VIDEO_Configure(GXRModeObj *rmode) {
+}
+
+void VIDEO_SetNextFramebuffer(void *fb) {
+}
+
+void VIDEO_SetBlack(BOOL black) {
+}
+
+void VIDEO_Flush(void) {
+}
+
+void VIDEO_WaitVSync(void) {
+	sim_bench_frame_end();
+	sim_clock_wait_vsync();
+	sim_bench_frame_start();
+	sim_console_frame(sim_stat.frames);
+}
+
+u32 VIDEO_GetFrameBufferSize(GXRModeObj *rmode) {
+	return rmode->fbWidth * rmode->xfbHeight * VI_DISPLAY_PIX_SZ;
+}
+
+void *SYS_AllocateFramebuffer(GXRModeObj *rmode) {
+	return calloc(1, VIDEO_GetFrameBufferSize(rmode));
+}
@@ -0,0 +1,37 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "sysconf.h"
+#include "sim.h"
+
+/*
+ * The view script directive. It opens a write view on a SYSCONF array entry, changes the first
+ * byte, and reads the entry back with a get on the same thread before putting the byte back and
+ * releasing the view unmarked. The get has to see the change, and it has to return at all: a get
+ * that waited for its own thread's write would never finish, so an alarm ends a run that hangs.
+ */
+#define SIM_VIEW_TIMEOUT 5 // Seconds of real time
+
+void sim_view_check(const char *name) {
+	u8 *data, readBack[0x4000];
+	s32 len, ret;
+
+	len = SYSCONF_GetWriteView(name, &data);
+	if (len < 0) {
+		fprintf(stderr, "[sim] view %s: no write view, err %d\n", name, len);
+		exit(2);
+	}
+
+	alarm(SIM_VIEW_TIMEOUT);
+	data[0] ^= 0xFF;
+	ret = SYSCONF_Get(name, readBack, sizeof(readBack));
+	alarm(0);
+	data[0] ^= 0xFF;
+	SYSCONF_ReleaseWriteView(0, 0);
+
+	if (ret != len || readBack[0] != (data[0] ^ 0xFF)) {
+		fprintf(stderr, "[sim] view %s: a get under the write view read %d bytes, not the change\n", name, ret);
+		exit(3);
+	}
+}
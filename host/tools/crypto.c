@@ -0,0 +1,244 @@
+#include <string.h>
+
+#include "crypto.h"
+
+// AES-128, byte at a time. Only a handful of clusters are ever run through it, so tables of
+// combined round transforms would buy nothing worth the size.
+
+static const u8 __sbox[256] = {
+	0x63, 0x7c, 0x77, 0x7b, 0xf2, 0x6b, 0x6f, 0xc5, 0x30, 0x01, 0x67, 0x2b, 0xfe, 0xd7, 0xab, 0x76,
+	0xca, 0x82, 0xc9, 0x7d, 0xfa, 0x59, 0x47, 0xf0, 0xad, 0xd4, 0xa2, 0xaf, 0x9c, 0xa4, 0x72, 0xc0,
+	0xb7, 0xfd, 0x93, 0x26, 0x36, 0x3f, 0xf7, 0xcc, 0x34, 0xa5, 0xe5, 0xf1, 0x71, 0xd8, 0x31, 0x15,
+	0x04, 0xc7, 0x23, 0xc3, 0x18, 0x96, 0x05, 0x9a, 0x07, 0x12, 0x80, 0xe2, 0xeb, 0x27, 0xb2, 0x75,
+	0x09, 0x83, 0x2c, 0x1a, 0x1b, 0x6e, 0x5a, 0xa0, 0x52, 0x3b, 0xd6, 0xb3, 0x29, 0xe3, 0x2f, 0x84,
+	0x53, 0xd1, 0x00, 0xed, 0x20, 0xfc, 0xb1, 0x5b, 0x6a, 0xcb, 0xbe, 0x39, 0x4a, 0x4c, 0x58, 0xcf,
+	0xd0, 0xef, 0xaa, 0xfb, 0x43, 0x4d, 0x33, 0x85, 0x45, 0xf9, 0x02, 0x7f, 0x50, 0x3c, 0x9f, 0xa8,
+	0x51, 0xa3, 0x40, 0x8f, 0x92, 0x9d, 0x38, 0xf5, 0xbc, 0xb6, 0xda, 0x21, 0x10, 0xff, 0xf3, 0xd2,
+	0xcd, 0x0c, 0x13, 0xec, 0x5f, 0x97, 0x44, 0x17, 0xc4, 0xa7, 0x7e, 0x3d, 0x64, 0x5d, 0x19, 0x73,
+	0x60, 0x81, 0x4f, 0xdc, 0x22, 0x2a, 0x90, 0x88, 0x46, 0xee, 0xb8, 0x14, 0xde, 0x5e, 0x0b, 0xdb,
+	0xe0, 0x32, 0x3a, 0x0a, 0x49, 0x06, 0x24, 0x5c, 0xc2, 0xd3, 0xac, 0x62, 0x91, 0x95, 0xe4, 0x79,
+	0xe7, 0xc8, 0x37, 0x6d, 0x8d, 0xd5, 0x4e, 0xa9, 0x6c, 0x56, 0xf4, 0xea, 0x65, 0x7a, 0xae, 0x08,
+	0xba, 0x78, 0x25, 0x2e, 0x1c, 0xa6, 0xb4, 0xc6, 0xe8, 0xdd, 0x74, 0x1f, 0x4b, 0xbd, 0x8b, 0x8a,
+	0x70, 0x3e, 0xb5, 0x66, 0x48, 0x03, 0xf6, 0x0e, 0x61, 0x35, 0x57, 0xb9, 0x86, 0xc1, 0x1d, 0x9e,
+	0xe1, 0xf8, 0x98, 0x11, 0x69, 0xd9, 0x8e, 0x94, 0x9b, 0x1e, 0x87, 0xe9, 0xce, 0x55, 0x28, 0xdf,
+	0x8c, 0xa1, 0x89, 0x0d, 0xbf, 0xe6, 0x42, 0x68, 0x41, 0x99, 0x2d, 0x0f, 0xb0, 0x54, 0xbb, 0x16,
+};
+
+static u8 __inv_sbox[256];
+
+static u8 __xtime(u8 x) {
+	return (x << 1) ^ ((x & 0x80) ? 0x1b : 0);
+}
+
+static u8 __mul(u8 a, u8 b) {
+	u8 r = 0;
+
+	while (b) {
+		if (b & 1) r ^= a;
+		a = __xtime(a);
+		b >>= 1;
+	}
+	return r;
+}
+
+void aes_set_key(aes_ctx *ctx, const u8 key[16]) {
+	u8 *rk = ctx->roundKeys;
+	u8 rcon = 1, t[4], x;
+	int i;
+
+	if (!__inv_sbox[0]) {
+		for (i = 0; i < 256; i++) __inv_sbox[__sbox[i]] = i;
+	}
+
+	memcpy(rk, key, 16);
+	for (i = 16; i < 176; i += 4) {
+		memcpy(t, &rk[i - 4], 4);
+		if (i % 16 == 0) {
+			x = t[0];
+			t[0] = __sbox[t[1]] ^ rcon;
+			t[1] = __sbox[t[2]];
+			t[2] = __sbox[t[3]];
+			t[3] = __sbox[x];
+			rcon = __xtime(rcon);
+		}
+		rk[i + 0] = rk[i - 16] ^ t[0];
+		rk[i + 1] = rk[i - 15] ^ t[1];
+		rk[i + 2] = rk[i - 14] ^ t[2];
+		rk[i + 3] = rk[i - 13] ^ t[3];
+	}
+}
+
+// The state is kept column-major, the same as the bytes of a block
+static void __encrypt_block(const aes_ctx *ctx, u8 s[16]) {
+	const u8 *rk = ctx->roundKeys;
+	u8 t[16], a, b, c, d;
+	int round, i;
+
+	for (i = 0; i < 16; i++) s[i] ^= rk[i];
+	for (round = 1; round <= 10; round++) {
+		// SubBytes and ShiftRows together
+		for (i = 0; i < 16; i++) t[i] = __sbox[s[(i + 4 * (i % 4)) % 16]];
+		if (round < 10) {
+			for (i = 0; i < 16; i += 4) {
+				a = t[i]; b = t[i + 1]; c = t[i + 2]; d = t[i + 3];
+				t[i + 0] = __xtime(a) ^ __xtime(b) ^ b ^ c ^ d;
+				t[i + 1] = a ^ __xtime(b) ^ __xtime(c) ^ c ^ d;
+				t[i + 2] = a ^ b ^ __xtime(c) ^ __xtime(d) ^ d;
+				t[i + 3] = __xtime(a) ^ a ^ b ^ c ^ __xtime(d);
+			}
+		}
+		for (i = 0; i < 16; i++) s[i] = t[i] ^ rk[round * 16 + i];
+	}
+}
+
+static void __decrypt_block(const aes_ctx *ctx, u8 s[16]) {
+	const u8 *rk = ctx->roundKeys;
+	u8 t[16], a, b, c, d;
+	int round, i;
+
+	for (i = 0; i < 16; i++) s[i] ^= rk[160 + i];
+	for (round = 9; round >= 0; round--) {
+		// Inverse ShiftRows and SubBytes together
+		for (i = 0; i < 16; i++) t[(i + 4 * (i % 4)) % 16] = __inv_sbox[s[i]];
+		for (i = 0; i < 16; i++) t[i] ^= rk[round * 16 + i];
+		if (round > 0) {
+			for (i = 0; i < 16; i += 4) {
+				a = t[i]; b = t[i + 1]; c = t[i + 2]; d = t[i + 3];
+				t[i + 0] = __mul(a, 14) ^ __mul(b, 11) ^ __mul(c, 13) ^ __mul(d, 9);
+				t[i + 1] = __mul(a, 9) ^ __mul(b, 14) ^ __mul(c, 11) ^ __mul(d, 13);
+				t[i + 2] = __mul(a, 13) ^ __mul(b, 9) ^ __mul(c, 14) ^ __mul(d, 11);
+				t[i + 3] = __mul(a, 11) ^ __mul(b, 13) ^ __mul(c, 9) ^ __mul(d, 14);
+			}
+		}
+		memcpy(s, t, 16);
+	}
+}
+
+void aes_cbc_encrypt(const aes_ctx *ctx, u8 iv[16], const u8 *in, u8 *out, u32 len) {
+	u32 i, j;
+
+	for (i = 0; i < len; i += 16) {
+		for (j = 0; j < 16; j++) out[i + j] = in[i + j] ^ iv[j];
+		__encrypt_block(ctx, &out[i]);
+		memcpy(iv, &out[i], 16);
+	}
+}
+
+void aes_cbc_decrypt(const aes_ctx *ctx, u8 iv[16], const u8 *in, u8 *out, u32 len) {
+	u8 block[16];
+	u32 i, j;
+
+	for (i = 0; i < len; i += 16) {
+		memcpy(block, &in[i], 16);
+		memcpy(&out[i], block, 16);
+		__decrypt_block(ctx, &out[i]);
+		for (j = 0; j < 16; j++) out[i + j] ^= iv[j];
+		memcpy(iv, block, 16);
+	}
+}
+
+#define ROL(x, n) (((x) << (n)) | ((x) >> (32 - (n))))
+
+static void __sha1_block(sha1_ctx *ctx, const u8 *p) {
+	u32 w[80], a, b, c, d, e, f, k, t;
+	int i;
+
+	for (i = 0; i < 16; i++) w[i] = ((u32)p[i * 4] << 24) | (p[i * 4 + 1] << 16) | (p[i * 4 + 2] << 8) | p[i * 4 + 3];
+	for (i = 16; i < 80; i++) w[i] = ROL(w[i - 3] ^ w[i - 8] ^ w[i - 14] ^ w[i - 16], 1);
+
+	a = ctx->h[0]; b = ctx->h[1]; c = ctx->h[2]; d = ctx->h[3]; e = ctx->h[4];
+	for (i = 0; i < 80; i++) {
+		if (i < 20) {
+			f = (b & c) | (~b & d);
+			k = 0x5a827999;
+		} else if (i < 40) {
+			f = b ^ c ^ d;
+			k = 0x6ed9eba1;
+		} else if (i < 60) {
+			f = (b & c) | (b & d) | (c & d);
+			k = 0x8f1bbcdc;
+		} else {
+			f = b ^ c ^ d;
+			k = 0xca62c1d6;
+		}
+		t = ROL(a, 5) + f + e + k + w[i];
+		e = d; d = c; c = ROL(b, 30); b = a; a = t;
+	}
+	ctx->h[0] += a; ctx->h[1] += b; ctx->h[2] += c; ctx->h[3] += d; ctx->h[4] += e;
+}
+
+void sha1_init(sha1_ctx *ctx) {
+	ctx->h[0] = 0x67452301;
+	ctx->h[1] = 0xefcdab89;
+	ctx->h[2] = 0x98badcfe;
+	ctx->h[3] = 0x10325476;
+	ctx->h[4] = 0xc3d2e1f0;
+	ctx->length = 0;
+	ctx->used = 0;
+}
+
+void sha1_update(sha1_ctx *ctx, const void *data, u32 len) {
+	const u8 *p = data;
+	u32 n;
+
+	ctx->length += len;
+	while (len) {
+		if (!ctx->used && len >= 64) {
+			__sha1_block(ctx, p);
+			p += 64;
+			len -= 64;
+			continue;
+		}
+		n = 64 - ctx->used < len ? 64 - ctx->used : len;
+		memcpy(&ctx->block[ctx->used], p, n);
+		ctx->used += n;
+		p += n;
+		len -= n;
+		if (ctx->used == 64) {
+			__sha1_block(ctx, ctx->block);
+			ctx->used = 0;
+		}
+	}
+}
+
+void sha1_final(sha1_ctx *ctx, u8 digest[20]) {
+	u64 bits = ctx->length * 8;
+	u8 pad = 0x80, zero = 0, len[8];
+	int i;
+
+	sha1_update(ctx, &pad, 1);
+	while (ctx->used != 56) sha1_update(ctx, &zero, 1);
+	for (i = 0; i < 8; i++) len[i] = bits >> (56 - i * 8);
+	sha1_update(ctx, len, 8);
+
+	for (i = 0; i < 20; i++) digest[i] = ctx->h[i / 4] >> (24 - (i % 4) * 8);
+}
+
+void hmac_sha1(const u8 *key, u32 keyLen, const void *salt, u32 saltLen, const void *data, u32 len, u8 digest[20]) {
+	u8 pad[64], inner[20];
+	sha1_ctx ctx;
+	int i;
+
+	// Keys over a block are hashed first; the NAND's are 20 bytes so this never happens in practice
+	memset(pad, 0, sizeof(pad));
+	if (keyLen > 64) {
+		sha1_init(&ctx);
+		sha1_update(&ctx, key, keyLen);
+		sha1_final(&ctx, pad);
+	} else {
+		memcpy(pad, key, keyLen);
+	}
+
+	for (i = 0; i < 64; i++) pad[i] ^= 0x36;
+	sha1_init(&ctx);
+	sha1_update(&ctx, pad, 64);
+	sha1_update(&ctx, salt, saltLen);
+	sha1_update(&ctx, data, len);
+	sha1_final(&ctx, inner);
+
+	for (i = 0; i < 64; i++) pad[i] ^= 0x36 ^ 0x5c;
+	sha1_init(&ctx);
+	sha1_update(&ctx, pad, 64);
+	sha1_update(&ctx, inner, 20);
+	sha1_final(&ctx, digest);
+}
@@ -0,0 +1,30 @@
+#ifndef __TOOLS_CRYPTO_H__
+#define __TOOLS_CRYPTO_H__
+
+#include <gctypes.h>
+
+// Just enough AES-128 and SHA-1 for the NAND's file clusters, without pulling in a crypto library
+
+typedef struct _aes_ctx {
+	u8 roundKeys[176];
+} aes_ctx;
+
+void aes_set_key(aes_ctx *ctx, const u8 key[16]);
+void aes_cbc_encrypt(const aes_ctx *ctx, u8 iv[16], const u8 *in, u8 *out, u32 len);
+void aes_cbc_decrypt(const aes_ctx *ctx, u8 iv[16], const u8 *in, u8 *out, u32 len);
+
+typedef struct _sha1_ctx {
+	u32 h[5];
+	u64 length;
+	u8 block[64];
+	u32 used;
+} sha1_ctx;
+
+void sha1_init(sha1_ctx *ctx);
+void sha1_update(sha1_ctx *ctx, const void *data, u32 len);
+void sha1_final(sha1_ctx *ctx, u8 digest[20]);
+
+// HMAC-SHA1 over salt followed by data, the way the NAND file system keys its clusters
+void hmac_sha1(const u8 *key, u32 keyLen, const void *salt, u32 saltLen, const void *data, u32 len, u8 digest[20]);
+
+#endif
@@ -0,0 +1,440 @@
+/*
+ * nandtool: read or patch SYSCONF and setting.txt inside a BootMii nand.bin, offline.
+ *
+ * The dump is mmapped and only the pages that matter are looked at: the superblock headers to
+ * find the newest superblock, that superblock (it is not encrypted), and the clusters of the two
+ * files. Those clusters are decrypted, checked against their HMAC and handed to sysconf.c.
+ * On set, only clusters whose contents changed are encrypted again and written back, together
+ * with their HMAC and ECC. The FAT and FST never change since neither file changes size.
+ *
+ * NAND layout: 0x8000 clusters of 8 pages, each page 0x800 bytes of data then 0x40 of spare.
+ * File data is AES-128-CBC with a zero IV per cluster. Each cluster's HMAC-SHA1 covers a salt
+ * naming the file, then the plain data, and sits in the spare area of its 7th and 8th pages.
+ * Every page's spare also holds an ECC for each 512 bytes of its data.
+ */
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <gccore.h>
+
+#include "crypto.h"
+#include "sysconf.h"
+#include "values.h"
+
+#define PAGE_DATA 0x800
+#define PAGE_SPARE 0x40
+#define PAGE_SIZE (PAGE_DATA + PAGE_SPARE)
+#define CLUSTER_PAGES 8
+#define CLUSTER_DATA (PAGE_DATA * CLUSTER_PAGES)
+#define CLUSTERS 0x8000
+#define NAND_SIZE ((u64)CLUSTERS * CLUSTER_PAGES * PAGE_SIZE)
+
+// BootMii appends keys.bin to newer dumps; inside it sits the console's OTP
+#define KEYS_SIZE 0x400
+#define KEYS_HMAC 0x144
+#define KEYS_AES 0x158
+
+#define SUPERBLOCK_FIRST 0x7F00
+#define SUPERBLOCK_CLUSTERS 16
+#define SUPERBLOCK_COUNT 16
+#define SUPERBLOCK_SIZE (SUPERBLOCK_CLUSTERS * CLUSTER_DATA)
+#define FAT_OFFSET 0x0C
+#define FST_OFFSET 0x1000C
+#define FST_ENTRIES 0x17FF
+#define FST_SIZE 0x20
+#define FAT_LAST 0xFFFB
+
+#define SYSCONF_PATH "/shared2/sys/SYSCONF"
+#define SETTING_TXT_PATH "/title/00000001/00000002/data/setting.txt"
+
+enum { CMD_DUMP, CMD_GET, CMD_SET };
+
+typedef struct _nand_file {
+	const char *path;
+	int entry;
+	u32 size;
+	int count;
+	u16 *clusters;
+	u8 *data; // Plain contents of every cluster, count * CLUSTER_DATA bytes
+	int hmacBad;
+} nand_file;
+
+static u8 *__nand;
+static u8 __superblock[SUPERBLOCK_SIZE];
+static u8 __hmacKey[20];
+static aes_ctx __aes;
+
+static u64 __bytesRead;
+static u64 __bytesDecrypted;
+static u64 __bytesWritten;
+static int __clustersWritten;
+
+static void __usage(void) {
+	fprintf(stderr,
+		"usage: nandtool [-k keys.bin] [-r rtc] <nand.bin> dump\n"
+		"       nandtool [-k keys.bin] [-r rtc] <nand.bin> get <key>\n"
+		"       nandtool [-k keys.bin] [-r rtc] <nand.bin> set <key> <value>\n"
+		"\n"
+		"Works on " SYSCONF_PATH " and " SETTING_TXT_PATH ".\n"
+		"Keys and values are the same as sysconftool's. The console's keys are read from the\n"
+		"end of nand.bin when BootMii appended them, otherwise give keys.bin with -k.\n");
+	exit(2);
+}
+
+static u16 __nand_get16(const u8 *p) {
+	return (p[0] << 8) | p[1];
+}
+
+static u32 __nand_get32(const u8 *p) {
+	return ((u32)__nand_get16(p) << 16) | __nand_get16(p + 2);
+}
+
+static void __nand_put32(u8 *p, u32 v) {
+	p[0] = v >> 24;
+	p[1] = v >> 16;
+	p[2] = v >> 8;
+	p[3] = v;
+}
+
+static u8 *__page(u32 cluster, int page) {
+	return &__nand[((u64)cluster * CLUSTER_PAGES + page) * PAGE_SIZE];
+}
+
+static void __read_cluster(u32 cluster, u8 *out) {
+	int i;
+
+	for (i = 0; i < CLUSTER_PAGES; i++) memcpy(&out[i * PAGE_DATA], __page(cluster, i), PAGE_DATA);
+	__bytesRead += CLUSTER_PAGES * PAGE_SIZE;
+}
+
+static int __parity(u8 x) {
+	x ^= x >> 4;
+	x ^= x >> 2;
+	x ^= x >> 1;
+	return x & 1;
+}
+
+// The NAND controller's ECC over 512 bytes: column and line parities, 12 bits each way
+static void __ecc(const u8 *data, u8 *ecc) {
+	u8 a[12][2];
+	u32 a0 = 0, a1 = 0;
+	int i, j;
+	u8 x;
+
+	memset(a, 0, sizeof(a));
+	for (i = 0; i < 512; i++) {
+		x = data[i];
+		for (j = 0; j < 9; j++) a[3 + j][(i >> j) & 1] ^= x;
+	}
+
+	x = a[3][0] ^ a[3][1];
+	a[0][0] = x & 0x55;
+	a[0][1] = x & 0xaa;
+	a[1][0] = x & 0x33;
+	a[1][1] = x & 0xcc;
+	a[2][0] = x & 0x0f;
+	a[2][1] = x & 0xf0;
+
+	for (j = 0; j < 12; j++) {
+		a0 |= __parity(a[j][0]) << j;
+		a1 |= __parity(a[j][1]) << j;
+	}
+
+	ecc[0] = a0;
+	ecc[1] = a0 >> 8;
+	ecc[2] = a1;
+	ecc[3] = a1 >> 8;
+}
+
+static const u8 *__fst(int entry) {
+	return &__superblock[FST_OFFSET + entry * FST_SIZE];
+}
+
+static void __cluster_hmac(const u8 *plain, int entry, int index, u8 *hmac) {
+	const u8 *fst = __fst(entry);
+	u8 salt[0x40];
+
+	memset(salt, 0, sizeof(salt));
+	memcpy(salt, fst + 0x16, 4); // uid
+	memcpy(salt + 4, fst, 12);   // name
+	__nand_put32(salt + 0x10, index);
+	__nand_put32(salt + 0x14, entry);
+	memcpy(salt + 0x18, fst + 0x1C, 4); // x3
+	hmac_sha1(__hmacKey, sizeof(__hmacKey), salt, sizeof(salt), plain, CLUSTER_DATA, hmac);
+}
+
+// Newest superblock by generation; they are stored in the clear
+static int __load_superblock(void) {
+	u32 generation = 0, gen;
+	int i, best = -1;
+	u8 *page;
+
+	for (i = 0; i < SUPERBLOCK_COUNT; i++) {
+		page = __page(SUPERBLOCK_FIRST + i * SUPERBLOCK_CLUSTERS, 0);
+		__bytesRead += PAGE_SIZE;
+		if (memcmp(page, "SFFS", 4)) continue;
+		gen = __nand_get32(page + 4);
+		if (best < 0 || gen > generation) {
+			generation = gen;
+			best = i;
+		}
+	}
+	if (best < 0) return -1;
+
+	for (i = 0; i < SUPERBLOCK_CLUSTERS; i++)
+		__read_cluster(SUPERBLOCK_FIRST + best * SUPERBLOCK_CLUSTERS + i, &__superblock[i * CLUSTER_DATA]);
+	return best;
+}
+
+static int __lookup(const char *path) {
+	char name[13];
+	const char *end;
+	int entry = 0, child, steps;
+
+	while (*path) {
+		while (*path == '/') path++;
+		if (!*path) break;
+		end = strchr(path, '/');
+		if (!end) end = path + strlen(path);
+		if (end - path > 12) return -1;
+		memset(name, 0, sizeof(name));
+		memcpy(name, path, end - path);
+		path = end;
+
+		// Only directories (mode 2) have children; sub is the first, sib links the rest
+		if ((__fst(entry)[0x0C] & 3) != 2) return -1;
+		child = __nand_get16(__fst(entry) + 0x0E);
+		for (steps = 0; child < FST_ENTRIES && steps < FST_ENTRIES; steps++) {
+			if (!strncmp((const char *)__fst(child), name, 12)) break;
+			child = __nand_get16(__fst(child) + 0x10);
+		}
+		if (child >= FST_ENTRIES || steps == FST_ENTRIES) return -1;
+		entry = child;
+	}
+	return entry;
+}
+
+static int __load_file(nand_file *file) {
+	u8 iv[16], hmac[20], cipher[CLUSTER_DATA];
+	const u8 *fst;
+	u16 cluster;
+	int i;
+
+	file->entry = __lookup(file->path);
+	if (file->entry < 0) return -1;
+	fst = __fst(file->entry);
+	if ((fst[0x0C] & 3) != 1) return -1;
+
+	file->size = __nand_get32(fst + 0x12);
+	file->count = (file->size + CLUSTER_DATA - 1) / CLUSTER_DATA;
+	file->clusters = calloc(file->count ? file->count : 1, sizeof(u16));
+	file->data = calloc(file->count ? file->count : 1, CLUSTER_DATA);
+
+	cluster = __nand_get16(fst + 0x0E);
+	for (i = 0; i < file->count; i++) {
+		if (cluster == FAT_LAST || cluster >= SUPERBLOCK_FIRST) {
+			free(file->data);
+			file->data = NULL;
+			return -1;
+		}
+		file->clusters[i] = cluster;
+
+		__read_cluster(cluster, cipher);
+		memset(iv, 0, sizeof(iv));
+		aes_cbc_decrypt(&__aes, iv, cipher, &file->data[i * CLUSTER_DATA], CLUSTER_DATA);
+		__bytesDecrypted += CLUSTER_DATA;
+
+		__cluster_hmac(&file->data[i * CLUSTER_DATA], file->entry, i, hmac);
+		if (memcmp(hmac, __page(cluster, 6) + PAGE_DATA + 1, 20)) file->hmacBad++;
+
+		cluster = __nand_get16(&__superblock[FAT_OFFSET + cluster * 2]);
+	}
+	return 0;
+}
+
+static void __write_cluster(nand_file *file, int index) {
+	u8 iv[16], hmac[20], cipher[CLUSTER_DATA];
+	const u8 *plain = &file->data[index * CLUSTER_DATA];
+	u16 cluster = file->clusters[index];
+	u8 *page, *spare;
+	int i, j;
+
+	memset(iv, 0, sizeof(iv));
+	aes_cbc_encrypt(&__aes, iv, plain, cipher, CLUSTER_DATA);
+	__cluster_hmac(plain, file->entry, index, hmac);
+
+	for (i = 0; i < CLUSTER_PAGES; i++) {
+		page = __page(cluster, i);
+		spare = page + PAGE_DATA;
+		memcpy(page, &cipher[i * PAGE_DATA], PAGE_DATA);
+
+		// The HMAC is stored twice, straddling the spare areas of the last two pages
+		if (i == 6) {
+			memcpy(spare + 1, hmac, 20);
+			memcpy(spare + 0x15, hmac, 12);
+		} else if (i == 7) {
+			memcpy(spare + 1, hmac + 12, 8);
+		}
+		for (j = 0; j < 4; j++) __ecc(&page[j * 512], &spare[0x30 + j * 4]);
+	}
+	__bytesWritten += CLUSTER_PAGES * PAGE_SIZE;
+	__clustersWritten++;
+}
+
+// Writes back the clusters of file whose plain data no longer matches new
+static void __store_file(nand_file *file, const u8 *data, u32 length) {
+	u32 offset, n;
+	int i;
+
+	for (i = 0; i < file->count; i++) {
+		offset = i * CLUSTER_DATA;
+		if (offset >= length) break;
+		n = length - offset < CLUSTER_DATA ? length - offset : CLUSTER_DATA;
+		if (!memcmp(&file->data[offset], &data[offset], n)) continue;
+		memcpy(&file->data[offset], &data[offset], n);
+		__write_cluster(file, i);
+	}
+}
+
+static int __load_keys(const char *path, off_t nandSize) {
+	u8 keys[KEYS_SIZE];
+	FILE *fp;
+
+	if (!path) {
+		if (nandSize < (off_t)(NAND_SIZE + KEYS_SIZE)) {
+			fprintf(stderr, "nand.bin has no keys appended, give keys.bin with -k\n");
+			return -1;
+		}
+		memcpy(keys, &__nand[NAND_SIZE], KEYS_SIZE);
+	} else {
+		fp = fopen(path, "rb");
+		if (!fp || fread(keys, 1, KEYS_SIZE, fp) != KEYS_SIZE) {
+			fprintf(stderr, "%s: not a keys.bin\n", path);
+			if (fp) fclose(fp);
+			return -1;
+		}
+		fclose(fp);
+	}
+
+	memcpy(__hmacKey, &keys[KEYS_HMAC], sizeof(__hmacKey));
+	aes_set_key(&__aes, &keys[KEYS_AES]);
+	return 0;
+}
+
+int main(int argc, char **argv) {
+	nand_file sysconf = { SYSCONF_PATH }, txt = { SETTING_TXT_PATH };
+	const char *keysPath = NULL, *key = NULL, *value = NULL;
+	u8 image[0x4000], text[0x101];
+	struct timespec start, end;
+	struct stat st;
+	int opt, fd, cmd, sb, ret = 0;
+	u32 rtc = 0;
+	double ms;
+
+	while ((opt = getopt(argc, argv, "k:r:")) != -1) {
+		switch (opt) {
+			case 'k': keysPath = optarg; break;
+			case 'r': rtc = strtoul(optarg, NULL, 0); break;
+			default: __usage();
+		}
+	}
+	argv += optind;
+	argc -= optind;
+	if (argc < 2) __usage();
+
+	if (!strcmp(argv[1], "dump") && argc == 2) {
+		cmd = CMD_DUMP;
+	} else if (!strcmp(argv[1], "get") && argc == 3) {
+		cmd = CMD_GET;
+		key = argv[2];
+	} else if (!strcmp(argv[1], "set") && argc == 4) {
+		cmd = CMD_SET;
+		key = argv[2];
+		value = argv[3];
+	} else {
+		__usage();
+	}
+
+	fd = open(argv[0], cmd == CMD_SET ? O_RDWR : O_RDONLY);
+	if (fd < 0 || fstat(fd, &st)) {
+		fprintf(stderr, "%s: %s\n", argv[0], strerror(errno));
+		return 1;
+	}
+	if (st.st_size < (off_t)NAND_SIZE) {
+		fprintf(stderr, "%s: not a BootMii NAND dump with spare data\n", argv[0]);
+		return 1;
+	}
+	__nand = mmap(NULL, st.st_size, cmd == CMD_SET ? PROT_READ | PROT_WRITE : PROT_READ, MAP_SHARED, fd, 0);
+	if (__nand == MAP_FAILED) {
+		fprintf(stderr, "%s: %s\n", argv[0], strerror(errno));
+		return 1;
+	}
+	if (__load_keys(keysPath, st.st_size) < 0) return 1;
+
+	clock_gettime(CLOCK_MONOTONIC, &start);
+
+	sb = __load_superblock();
+	if (sb < 0) {
+		fprintf(stderr, "%s: no superblock found\n", argv[0]);
+		return 1;
+	}
+	if (__load_file(&sysconf) < 0) fprintf(stderr, "%s not found\n", sysconf.path);
+	if (__load_file(&txt) < 0) fprintf(stderr, "%s not found\n", txt.path);
+	if (sysconf.hmacBad || txt.hmacBad) {
+		fprintf(stderr, "HMAC mismatch, keys.bin may be from another console\n");
+		if (cmd == CMD_SET) return 1;
+	}
+
+	ret = SYSCONF_InitFromMemory(sysconf.data, txt.data);
+	if (ret < 0) {
+		fprintf(stderr, "SYSCONF not readable (%d)\n", ret);
+		return 1;
+	}
+
+	switch (cmd) {
+		case CMD_DUMP:
+			SYSCONF_DumpSettings(stdout);
+			if (SYSCONF_GetTxtPlain((char *)text, sizeof(text)) >= 0) fputs((char *)text, stdout);
+			break;
+
+		case CMD_GET:
+			tool_print_value(stdout, argv[0], key, rtc);
+			break;
+
+		case CMD_SET:
+			ret = tool_set_value(key, value, rtc);
+			if (ret < 0) {
+				fprintf(stderr, "%s not set (%d)\n", key, ret);
+				return 1;
+			}
+			// Only the file the key lives in is exported, so the other is left exactly as it was
+			if (tool_is_sysconf_key(key)) {
+				SYSCONF_ExportToMemory(image, NULL);
+				__store_file(&sysconf, image, 0x4000);
+			} else {
+				SYSCONF_ExportToMemory(NULL, image);
+				__store_file(&txt, image, 0x100);
+			}
+			msync(__nand, st.st_size, MS_SYNC);
+			break;
+	}
+
+	clock_gettime(CLOCK_MONOTONIC, &end);
+	ms = (end.tv_sec - start.tv_sec) * 1e3 + (end.tv_nsec - start.tv_nsec) / 1e6;
+	fprintf(stderr, "superblock %d of %d; read %llu KiB of the %llu MiB image, decrypted %llu KiB, in %.2f ms (%.1f MiB/s)\n",
+		sb, SUPERBLOCK_COUNT, (unsigned long long)__bytesRead / 1024, (unsigned long long)st.st_size >> 20,
+		(unsigned long long)__bytesDecrypted / 1024, ms, ms > 0 ? __bytesRead / (ms * 1e3 * 1.048576) : 0.0);
+	if (cmd == CMD_SET)
+		fprintf(stderr, "wrote %d cluster(s), %llu bytes with spare\n", __clustersWritten, (unsigned long long)__bytesWritten);
+
+	munmap(__nand, st.st_size);
+	close(fd);
+	return 0;
+}
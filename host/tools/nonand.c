@@ -0,0 +1,76 @@
+#include <time.h>
+
+#include <gccore.h>
+
+/*
+ * The tools only ever hand sysconf.c images already in memory, so there is no NAND behind it.
+ * Anything that would reach for one fails the way a missing file does.
+ */
+#define FS_ENOENT -106
+
+s32 IOS_Open(const char *filepath, u32 mode) {
+	return FS_ENOENT;
+}
+
+s32 IOS_Close(s32 fd) {
+	return IPC_EINVAL;
+}
+
+s32 IOS_Seek(s32 fd, s32 where, s32 whence) {
+	return IPC_EINVAL;
+}
+
+s32 IOS_Read(s32 fd, void *buf, s32 len) {
+	return IPC_EINVAL;
+}
+
+s32 IOS_Write(s32 fd, const void *buf, s32 len) {
+	return IPC_EINVAL;
+}
+
+s32 IOS_OpenAsync(const char *filepath, u32 mode, ipccallback ipc_cb, void *usrdata) {
+	return FS_ENOENT;
+}
+
+s32 IOS_CloseAsync(s32 fd, ipccallback ipc_cb, void *usrdata) {
+	return IPC_EINVAL;
+}
+
+s32 IOS_ReadAsync(s32 fd, void *buf, s32 len, ipccallback ipc_cb, void *usrdata) {
+	return IPC_EINVAL;
+}
+
+// With no request ever in flight, nothing waits on a queue either
+s32 LWP_InitQueue(lwpq_t *thequeue) {
+	*thequeue = 0;
+	return 0;
+}
+
+s32 LWP_ThreadSleep(lwpq_t thequeue) {
+	return 0;
+}
+
+void LWP_ThreadSignal(lwpq_t thequeue) {
+}
+
+s32 ISFS_SetAttr(const char *filepath, u32 ownerID, u16 groupID, u8 attributes, u8 ownerperm, u8 groupperm, u8 otherperm) {
+	return FS_ENOENT;
+}
+
+s32 ES_GetTitleID(u64 *titleID) {
+	*titleID = 0;
+	return 0;
+}
+
+// provision.c times its transaction; a tool has a real clock to read
+u64 gettime(void) {
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return secs_to_ticks(ts.tv_sec) + nanosecs_to_ticks(ts.tv_nsec);
+}
+
+// Each worker thread has sysconf.c state of its own, so the only thread that state ever sees is itself
+lwp_t LWP_GetSelf(void) {
+	return 0;
+}
@@ -0,0 +1,623 @@
+/*
+ * sysconftool: inspect and patch archived SYSCONF and setting.txt files in bulk.
+ *
+ * Everything format-related goes through sysconf.c (see values.c), built with
+ * SYSCONF_PER_THREAD so every worker thread has its own library instance.
+ * Files are recognised by size: 0x4000 bytes starting with SCv0 is a SYSCONF, 0x100 is a setting.txt.
+ */
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <gccore.h>
+
+#include "sysconf.h"
+#include "values.h"
+
+#define MAX_THREADS 64
+
+enum { CMD_DUMP, CMD_JSON, CMD_GET, CMD_SET, CMD_APPLY };
+
+enum { FILE_SKIPPED, FILE_SYSCONF, FILE_TXT, FILE_ERROR };
+
+typedef struct _tool_file {
+	char *path;
+	int kind;
+	char *out; // What this file printed, shown in path order once every worker is done
+	size_t outSize;
+} tool_file;
+
+// One worker's share of the files: it takes from the front, thieves take half from the back
+typedef struct _tool_queue {
+	pthread_mutex_t lock;
+	int head;
+	int tail;
+} tool_queue;
+
+static int __cmd;
+static const char *__key;
+static const char *__value;
+static u32 __rtc;
+static u8 *__delta;
+static size_t __deltaSize;
+
+static tool_file *__files;
+static int __fileCount;
+static int __fileCap;
+
+static tool_queue __queues[MAX_THREADS];
+static int __threads;
+
+static void __usage(void) {
+	fprintf(stderr,
+		"usage: sysconftool [-j threads] [-r rtc] dump <path>...\n"
+		"       sysconftool [-j threads] json <path>...\n"
+		"       sysconftool [-j threads] [-r rtc] get <key> <path>...\n"
+		"       sysconftool [-j threads] [-r rtc] set <key> <value> <path>...\n"
+		"       sysconftool decrypt <setting.txt> <plain.txt>\n"
+		"       sysconftool encrypt <plain.txt> <setting.txt>\n"
+		"       sysconftool delta <old SYSCONF> <new SYSCONF> <delta>\n"
+		"       sysconftool [-j threads] apply <delta> <path>...\n"
+		"\n"
+		"Paths may be files or directories, which are walked recursively.\n"
+		"json prints one line of JSON per file: {\"path\":...,\"config\":{\"sysconf\":[...],\"setting.txt\":{...}}}\n"
+		"Keys with a dot (IPL.CB) are SYSCONF entries, others (GAME, AREA) setting.txt lines.\n"
+		"IPL.CB is shown and may be set as a UTC date, YYYY-MM-DD HH:MM:SS, taking\n"
+		"the console's RTC to read -r (default 0).\n"
+		"delta writes what changed between two SYSCONFs by entry name, with the old values as guards;\n"
+		"apply makes those changes to every SYSCONF whose entries still hold the old values.\n");
+	exit(2);
+}
+
+static void __add_file(const char *path) {
+	if (__fileCount == __fileCap) {
+		__fileCap = __fileCap ? __fileCap * 2 : 256;
+		__files = realloc(__files, __fileCap * sizeof(*__files));
+	}
+	memset(&__files[__fileCount], 0, sizeof(*__files));
+	__files[__fileCount++].path = strdup(path);
+}
+
+static void __walk(const char *path) {
+	struct stat st;
+	struct dirent *de;
+	DIR *dir;
+	char *child;
+
+	if (stat(path, &st)) {
+		fprintf(stderr, "%s: %s\n", path, strerror(errno));
+		return;
+	}
+	if (S_ISREG(st.st_mode)) {
+		__add_file(path);
+		return;
+	}
+	if (!S_ISDIR(st.st_mode)) return;
+
+	dir = opendir(path);
+	if (!dir) {
+		fprintf(stderr, "%s: %s\n", path, strerror(errno));
+		return;
+	}
+	while ((de = readdir(dir))) {
+		if (!strcmp(de->d_name, ".") || !strcmp(de->d_name, "..")) continue;
+		if (asprintf(&child, "%s/%s", path, de->d_name) < 0) continue;
+		__walk(child);
+		free(child);
+	}
+	closedir(dir);
+}
+
+static void __process(tool_file *file) {
+	FILE *out = open_memstream(&file->out, &file->outSize);
+	u8 image[0x4000];
+	char text[0x101];
+	struct stat st;
+	const char *p;
+	u8 *map;
+	int fd, writable = __cmd == CMD_SET || __cmd == CMD_APPLY;
+	s32 ret;
+
+	fd = open(file->path, writable ? O_RDWR : O_RDONLY);
+	if (fd < 0 || fstat(fd, &st)) {
+		fprintf(out, "%s: %s\n", file->path, strerror(errno));
+		file->kind = FILE_ERROR;
+		goto done;
+	}
+	if (st.st_size != 0x4000 && st.st_size != 0x100) goto done;
+
+	map = mmap(NULL, st.st_size, writable ? PROT_READ | PROT_WRITE : PROT_READ, MAP_SHARED, fd, 0);
+	if (map == MAP_FAILED) {
+		fprintf(out, "%s: %s\n", file->path, strerror(errno));
+		file->kind = FILE_ERROR;
+		goto done;
+	}
+
+	if (st.st_size == 0x4000) {
+		if (memcmp(map, "SCv0", 4)) goto unmap;
+		file->kind = FILE_SYSCONF;
+		ret = SYSCONF_InitFromMemory(map, NULL);
+	} else {
+		file->kind = FILE_TXT;
+		ret = SYSCONF_InitFromMemory(NULL, map);
+	}
+	if (ret < 0) {
+		fprintf(out, "%s: not readable (%d)\n", file->path, ret);
+		file->kind = FILE_ERROR;
+		goto unmap;
+	}
+
+	// Keys only apply to their own kind of file, and deltas to SYSCONFs; the others in the tree are passed over
+	if (__cmd == CMD_APPLY ? file->kind != FILE_SYSCONF :
+		__cmd != CMD_DUMP && __cmd != CMD_JSON && tool_is_sysconf_key(__key) != (file->kind == FILE_SYSCONF)) {
+		file->kind = FILE_SKIPPED;
+		goto unmap;
+	}
+
+	switch (__cmd) {
+		case CMD_DUMP:
+			fprintf(out, "%s:\n", file->path);
+			if (file->kind == FILE_SYSCONF) {
+				SYSCONF_DumpSettings(out);
+			} else if (SYSCONF_GetTxtPlain(text, sizeof(text)) >= 0) {
+				fputs(text, out);
+			}
+			break;
+
+		case CMD_JSON:
+			// Paths are the tool's own, so only quotes and backslashes need escaping
+			fputs("{\"path\":\"", out);
+			for (p = file->path; *p; p++) fprintf(out, *p == '"' || *p == '\\' ? "\\%c" : "%c", *p);
+			fputs("\",\"config\":", out);
+			SYSCONF_ExportJSON(out);
+			fputs("}\n", out);
+			break;
+
+		case CMD_GET:
+			tool_print_value(out, file->path, __key, __rtc);
+			break;
+
+		case CMD_SET:
+		case CMD_APPLY:
+			ret = __cmd == CMD_SET ? tool_set_value(__key, __value, __rtc) : SYSCONF_ApplyDelta(__delta, __deltaSize);
+			if (ret < 0) {
+				if (__cmd == CMD_SET) fprintf(out, "%s: %s not set (%d)\n", file->path, __key, ret);
+				else fprintf(out, "%s: delta not applied (%d)%s\n", file->path, ret, ret == SYSCONF_EGUARD ? ", an entry doesn't hold the old value" : "");
+				file->kind = FILE_ERROR;
+				break;
+			}
+			// Write back only when something changed, so an archive's timestamps stay meaningful
+			if (file->kind == FILE_SYSCONF) {
+				SYSCONF_ExportToMemory(image, NULL);
+			} else {
+				SYSCONF_ExportToMemory(NULL, image);
+			}
+			if (memcmp(map, image, st.st_size)) {
+				memcpy(map, image, st.st_size);
+				if (__cmd == CMD_SET) fprintf(out, "%s: %s set\n", file->path, __key);
+				else fprintf(out, "%s: %d changes applied\n", file->path, ret);
+			}
+			break;
+	}
+
+unmap:
+	munmap(map, st.st_size);
+done:
+	if (fd >= 0) close(fd);
+	fclose(out);
+}
+
+static int __take(int self) {
+	tool_queue *q = &__queues[self];
+	int i, victim, best, n, index = -1;
+
+	pthread_mutex_lock(&q->lock);
+	if (q->head < q->tail) index = q->head++;
+	pthread_mutex_unlock(&q->lock);
+	if (index >= 0) return index;
+
+	// Out of work: steal the back half of whichever queue has the most left
+	for (;;) {
+		victim = -1;
+		best = 0;
+		for (i = 0; i < __threads; i++) {
+			if (i == self) continue;
+			pthread_mutex_lock(&__queues[i].lock);
+			n = __queues[i].tail - __queues[i].head;
+			pthread_mutex_unlock(&__queues[i].lock);
+			if (n > best) {
+				best = n;
+				victim = i;
+			}
+		}
+		if (victim < 0) return -1;
+
+		pthread_mutex_lock(&__queues[victim].lock);
+		n = __queues[victim].tail - __queues[victim].head;
+		if (n > 0) {
+			n = (n + 1) / 2;
+			__queues[victim].tail -= n;
+			index = __queues[victim].tail;
+		}
+		pthread_mutex_unlock(&__queues[victim].lock);
+		if (n <= 0) continue;
+
+		// Keep the first stolen file, queue the rest as our own
+		pthread_mutex_lock(&q->lock);
+		q->head = index + 1;
+		q->tail = index + n;
+		pthread_mutex_unlock(&q->lock);
+		return index;
+	}
+}
+
+static void *__worker(void *arg) {
+	int self = (int)(long)arg;
+	int index;
+
+	while ((index = __take(self)) >= 0) __process(&__files[index]);
+	return NULL;
+}
+
+static int __convert(const char *in, const char *out, int encrypt) {
+	char text[0x101];
+	u8 txt[0x101];
+	FILE *fp;
+	size_t len;
+	s32 ret;
+
+	fp = fopen(in, "rb");
+	if (!fp) {
+		fprintf(stderr, "%s: %s\n", in, strerror(errno));
+		return 1;
+	}
+	len = fread(encrypt ? (void *)text : (void *)txt, 1, 0x101, fp);
+	fclose(fp);
+
+	if (encrypt) {
+		if (len > 0x100) {
+			fprintf(stderr, "%s: setting.txt holds at most 256 bytes\n", in);
+			return 1;
+		}
+		SYSCONF_InitFromMemory(NULL, NULL);
+		ret = SYSCONF_SetTxtPlain(text, len);
+		if (ret >= 0) ret = SYSCONF_ExportToMemory(NULL, txt);
+	} else {
+		if (len != 0x100) {
+			fprintf(stderr, "%s: not a setting.txt\n", in);
+			return 1;
+		}
+		SYSCONF_InitFromMemory(NULL, txt);
+		ret = SYSCONF_GetTxtPlain(text, sizeof(text));
+	}
+	if (ret < 0) {
+		fprintf(stderr, "%s: failed (%d)\n", in, ret);
+		return 1;
+	}
+
+	fp = fopen(out, "wb");
+	if (!fp) {
+		fprintf(stderr, "%s: %s\n", out, strerror(errno));
+		return 1;
+	}
+	if (encrypt) fwrite(txt, 1, 0x100, fp);
+	else fwrite(text, 1, ret, fp);
+	fclose(fp);
+	return 0;
+}
+
+// One entry of an image, copied out so the next image can be loaded
+typedef struct _tool_entry {
+	char name[17];
+	u8 type;
+	u16 length;
+	u8 *data;
+} tool_entry;
+
+static void __free_entries(tool_entry *entries, int count) {
+	int i;
+
+	for (i = 0; i < count; i++) free(entries[i].data);
+	free(entries);
+}
+
+static int __load_entries(const char *path, tool_entry **entries) {
+	sysconf_iter iter;
+	sysconf_entry entry;
+	u8 image[0x4000];
+	FILE *fp;
+	int n = 0;
+
+	fp = fopen(path, "rb");
+	if (!fp) {
+		fprintf(stderr, "%s: %s\n", path, strerror(errno));
+		return -1;
+	}
+	if (fread(image, 1, sizeof(image), fp) != sizeof(image) || SYSCONF_InitFromMemory(image, NULL) < 0) {
+		fprintf(stderr, "%s: not a SYSCONF\n", path);
+		fclose(fp);
+		return -1;
+	}
+	fclose(fp);
+
+	if (SYSCONF_IterBegin(&iter) < 0) {
+		fprintf(stderr, "%s: out of memory\n", path);
+		return -1;
+	}
+	*entries = calloc(iter.count ? iter.count : 1, sizeof(tool_entry));
+	while (*entries && SYSCONF_IterNext(&iter, &entry) > 0) {
+		tool_entry *e = &(*entries)[n++];
+
+		memcpy(e->name, entry.name, entry.name_length);
+		e->type = entry.type;
+		e->length = entry.length;
+		e->data = malloc(entry.length);
+		if (!e->data) {
+			__free_entries(*entries, n);
+			*entries = NULL;
+			break;
+		}
+		memcpy(e->data, entry.data, entry.length);
+	}
+	SYSCONF_IterEnd(&iter);
+	if (!*entries) {
+		fprintf(stderr, "%s: out of memory\n", path);
+		return -1;
+	}
+	return n;
+}
+
+static tool_entry *__find_entry(tool_entry *entries, int count, const char *name) {
+	int i;
+
+	for (i = 0; i < count; i++)
+		if (!strcmp(entries[i].name, name)) return &entries[i];
+	return NULL;
+}
+
+// FNV-1a, which is what sysconf.c checks deltas with
+static u32 __fnv(u32 hash, const void *data, size_t length) {
+	const u8 *p = data;
+
+	while (length--) hash = (hash ^ *p++) * 0x01000193;
+	return hash;
+}
+
+static void __put16(FILE *fp, u32 v) {
+	fputc(v >> 8, fp);
+	fputc(v, fp);
+}
+
+// Writes one record and folds what it leaves in SYSCONF into the result hash
+static void __put_record(FILE *fp, u32 *result, u8 op, const tool_entry *from, const tool_entry *to) {
+	const tool_entry *e = to ? to : from;
+
+	fputc(op, fp);
+	fputc(e->type, fp);
+	fputc(strlen(e->name), fp);
+	fputs(e->name, fp);
+	__put16(fp, from ? from->length : 0);
+	if (from) fwrite(from->data, 1, from->length, fp);
+	__put16(fp, to ? to->length : 0);
+	if (to) fwrite(to->data, 1, to->length, fp);
+
+	*result = __fnv(*result, e->name, strlen(e->name));
+	if (to) {
+		*result = __fnv(*result, &to->type, 1);
+		*result = __fnv(*result, to->data, to->length);
+	}
+}
+
+static int __make_delta(const char *oldPath, const char *newPath, const char *outPath) {
+	tool_entry *from = NULL, *to = NULL, *e;
+	int fromCount = 0, toCount = 0, records = 0, ret = 1, i;
+	u32 result = 0x811C9DC5, body;
+	char *buf = NULL;
+	size_t size = 0;
+	u8 header[14] = { 'S', 'C', 'd', 'l' };
+	FILE *fp;
+
+	fromCount = __load_entries(oldPath, &from);
+	if (fromCount < 0) return 1;
+	toCount = __load_entries(newPath, &to);
+	if (toCount < 0) goto out;
+
+	// A delta can't both remove and add one name, so a change of type can't be carried
+	for (i = 0; i < toCount; i++) {
+		e = __find_entry(from, fromCount, to[i].name);
+		if (e && e->type != to[i].type) {
+			fprintf(stderr, "%s changes type, which a delta can't carry\n", to[i].name);
+			goto out;
+		}
+	}
+
+	// Removes go first and adds last, so the space freed is there for whatever grows
+	fp = open_memstream(&buf, &size);
+	if (!fp) {
+		fprintf(stderr, "%s: %s\n", outPath, strerror(errno));
+		goto out;
+	}
+	for (i = 0; i < fromCount; i++) {
+		if (__find_entry(to, toCount, from[i].name)) continue;
+		__put_record(fp, &result, SYSCONF_DELTA_REMOVE, &from[i], NULL);
+		records++;
+	}
+	for (i = 0; i < toCount; i++) {
+		e = __find_entry(from, fromCount, to[i].name);
+		if (!e || (e->length == to[i].length && !memcmp(e->data, to[i].data, e->length))) continue;
+		__put_record(fp, &result, SYSCONF_DELTA_SET, e, &to[i]);
+		records++;
+	}
+	for (i = 0; i < toCount; i++) {
+		if (__find_entry(from, fromCount, to[i].name)) continue;
+		__put_record(fp, &result, SYSCONF_DELTA_ADD, NULL, &to[i]);
+		records++;
+	}
+	if (fclose(fp)) {
+		fprintf(stderr, "%s: %s\n", outPath, strerror(errno));
+		goto out;
+	}
+
+	// The header counts records in 16 bits
+	if (records > 0xFFFF) {
+		fprintf(stderr, "%d changes, more than one delta can hold\n", records);
+		goto out;
+	}
+
+	body = __fnv(0x811C9DC5, buf, size);
+	header[4] = records >> 8;
+	header[5] = records;
+	for (i = 0; i < 4; i++) {
+		header[6 + i] = body >> (24 - i * 8);
+		header[10 + i] = result >> (24 - i * 8);
+	}
+
+	fp = fopen(outPath, "wb");
+	if (!fp) {
+		fprintf(stderr, "%s: %s\n", outPath, strerror(errno));
+		goto out;
+	}
+	fwrite(header, 1, sizeof(header), fp);
+	fwrite(buf, 1, size, fp);
+	if (fclose(fp)) {
+		fprintf(stderr, "%s: %s\n", outPath, strerror(errno));
+		goto out;
+	}
+
+	fprintf(stderr, "%d changes in %zu bytes, against %d bytes of SYSCONF\n", records, sizeof(header) + size, 0x4000);
+	ret = 0;
+out:
+	free(buf);
+	if (to) __free_entries(to, toCount);
+	__free_entries(from, fromCount);
+	return ret;
+}
+
+static int __load_delta(const char *path) {
+	FILE *fp = fopen(path, "rb");
+	struct stat st;
+	long size;
+
+	if (!fp) {
+		fprintf(stderr, "%s: %s\n", path, strerror(errno));
+		return -1;
+	}
+	if (fstat(fileno(fp), &st) < 0) st.st_mode = 0;
+	else if (!S_ISREG(st.st_mode)) errno = S_ISDIR(st.st_mode) ? EISDIR : EINVAL;
+	if (!S_ISREG(st.st_mode)) {
+		fprintf(stderr, "%s: %s\n", path, strerror(errno));
+		fclose(fp);
+		return -1;
+	}
+	size = st.st_size;
+
+	__delta = malloc(size > 0 ? size : 1);
+	if (!__delta) {
+		fprintf(stderr, "%s: out of memory\n", path);
+		fclose(fp);
+		return -1;
+	}
+	__deltaSize = fread(__delta, 1, size, fp);
+	if (__deltaSize != (size_t)size) {
+		fprintf(stderr, "%s: %s\n", path, ferror(fp) ? strerror(errno) : "short read");
+		fclose(fp);
+		free(__delta);
+		__delta = NULL;
+		return -1;
+	}
+	fclose(fp);
+	return 0;
+}
+
+int main(int argc, char **argv) {
+	pthread_t threads[MAX_THREADS];
+	struct timespec start, end;
+	int counts[4] = { 0 };
+	double elapsed;
+	int opt, i, per;
+
+	__threads = sysconf(_SC_NPROCESSORS_ONLN);
+	while ((opt = getopt(argc, argv, "+j:r:")) != -1) {
+		switch (opt) {
+			case 'j': __threads = atoi(optarg); break;
+			case 'r': __rtc = strtoul(optarg, NULL, 0); break;
+			default: __usage();
+		}
+	}
+	if (__threads < 1) __threads = 1;
+	if (__threads > MAX_THREADS) __threads = MAX_THREADS;
+
+	argv += optind;
+	argc -= optind;
+	if (argc < 1) __usage();
+
+	if (!strcmp(argv[0], "decrypt") || !strcmp(argv[0], "encrypt")) {
+		if (argc != 3) __usage();
+		return __convert(argv[1], argv[2], argv[0][0] == 'e');
+	}
+
+	if (!strcmp(argv[0], "delta")) {
+		if (argc != 4) __usage();
+		return __make_delta(argv[1], argv[2], argv[3]);
+	}
+
+	if (!strcmp(argv[0], "dump") || !strcmp(argv[0], "json")) {
+		__cmd = argv[0][0] == 'd' ? CMD_DUMP : CMD_JSON;
+		argv += 1;
+		argc -= 1;
+	} else if (!strcmp(argv[0], "get") && argc >= 2) {
+		__cmd = CMD_GET;
+		__key = argv[1];
+		argv += 2;
+		argc -= 2;
+	} else if (!strcmp(argv[0], "apply") && argc >= 2) {
+		__cmd = CMD_APPLY;
+		if (__load_delta(argv[1]) < 0) return 1;
+		argv += 2;
+		argc -= 2;
+	} else if (!strcmp(argv[0], "set") && argc >= 3) {
+		__cmd = CMD_SET;
+		__key = argv[1];
+		__value = argv[2];
+		argv += 3;
+		argc -= 3;
+	} else {
+		__usage();
+	}
+	if (argc < 1) __usage();
+
+	for (i = 0; i < argc; i++) __walk(argv[i]);
+	if (__threads > __fileCount) __threads = __fileCount ? __fileCount : 1;
+
+	// Deal the files out in contiguous runs; stealing evens out whatever this gets wrong
+	per = (__fileCount + __threads - 1) / __threads;
+	for (i = 0; i < __threads; i++) {
+		pthread_mutex_init(&__queues[i].lock, NULL);
+		__queues[i].head = i * per < __fileCount ? i * per : __fileCount;
+		__queues[i].tail = (i + 1) * per < __fileCount ? (i + 1) * per : __fileCount;
+	}
+
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	for (i = 0; i < __threads; i++) pthread_create(&threads[i], NULL, __worker, (void *)(long)i);
+	for (i = 0; i < __threads; i++) pthread_join(threads[i], NULL);
+	clock_gettime(CLOCK_MONOTONIC, &end);
+
+	for (i = 0; i < __fileCount; i++) {
+		fwrite(__files[i].out, 1, __files[i].outSize, stdout);
+		counts[__files[i].kind]++;
+	}
+
+	elapsed = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+	fprintf(stderr, "%d files (%d SYSCONF, %d setting.txt, %d skipped, %d failed) in %.3f s on %d threads, %.0f files/s\n",
+		__fileCount, counts[FILE_SYSCONF], counts[FILE_TXT], counts[FILE_SKIPPED], counts[FILE_ERROR],
+		elapsed, __threads, elapsed > 0 ? __fileCount / elapsed : 0.0);
+	return counts[FILE_ERROR] ? 1 : 0;
+}
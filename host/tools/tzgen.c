@@ -0,0 +1,184 @@
+/*
+ * tzgen: turns the host's tzdata into the time zone table wiirtc is built with.
+ *
+ * Reads a list of zone names (see source/tzzones.txt) and writes C source with, for each zone,
+ * every UTC offset change between 2000 and 2036 -- the years the console can be set to.
+ * The host's own time zone code does the tzdata parsing: each zone is sampled hourly through
+ * localtime_r and every change is narrowed down to the second.
+ *
+ * Only needs a C library, so the console build can compile it with the host compiler.
+ */
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#define TABLE_START 946684800 // 2000-01-01 00:00 UTC; times in the table count from here
+#define TABLE_END 2082758400  // 2036-01-01 00:00 UTC
+#define MAX_ZONES 64
+#define MAX_ENTRIES 65535
+
+typedef struct _tz_state {
+	long offset;
+	int dst;
+} tz_state;
+
+static char *__names[MAX_ZONES];
+static int __zoneCount;
+static uint16_t __first[MAX_ZONES + 1];
+static uint32_t __times[MAX_ENTRIES];
+static uint8_t __info[MAX_ENTRIES];
+static int __entries;
+
+static void __usage(void) {
+	fprintf(stderr, "usage: tzgen [-d zoneinfo] <zone list> > tzdata.c\n");
+	exit(2);
+}
+
+static tz_state __state(time_t t) {
+	tz_state state;
+	struct tm tm;
+
+	localtime_r(&t, &tm);
+	state.offset = tm.tm_gmtoff;
+	state.dst = tm.tm_isdst > 0;
+	return state;
+}
+
+static int __same(tz_state a, tz_state b) {
+	return a.offset == b.offset && a.dst == b.dst;
+}
+
+static int __add(const char *zone, time_t at, tz_state state) {
+	long quarters = state.offset / 900;
+
+	if (state.offset % 900 || quarters < -64 || quarters > 63) {
+		fprintf(stderr, "tzgen: %s: offset %ld s can't be stored in quarter hours\n", zone, state.offset);
+		return -1;
+	}
+	if (__entries == MAX_ENTRIES) {
+		fprintf(stderr, "tzgen: too many offset changes\n");
+		return -1;
+	}
+
+	__times[__entries] = (uint32_t)(at - TABLE_START);
+	__info[__entries] = (uint8_t)((quarters & 0x7f) | (state.dst << 7));
+	__entries++;
+	return 0;
+}
+
+static int __zone(const char *dir, const char *zone) {
+	char path[1024], tz[1024];
+	tz_state prev, next;
+	time_t t, lo, hi;
+
+	// The C library quietly falls back to UTC for a zone it can't find
+	snprintf(path, sizeof(path), "%s/%s", dir, zone);
+	if (access(path, R_OK)) {
+		fprintf(stderr, "tzgen: no zone %s in %s\n", zone, dir);
+		return -1;
+	}
+
+	snprintf(tz, sizeof(tz), ":%s", zone);
+	setenv("TZ", tz, 1);
+	tzset();
+
+	__first[__zoneCount] = (uint16_t)__entries;
+	prev = __state(TABLE_START);
+	if (__add(zone, TABLE_START, prev) < 0) return -1;
+
+	for (t = TABLE_START + 3600; t <= TABLE_END; t += 3600) {
+		next = __state(t);
+		if (__same(next, prev)) continue;
+
+		// Find the first second of the new offset within the hour
+		lo = t - 3600;
+		hi = t;
+		while (hi - lo > 1) {
+			time_t mid = lo + (hi - lo) / 2;
+			if (__same(__state(mid), prev)) lo = mid;
+			else hi = mid;
+		}
+		if (__add(zone, hi, next) < 0) return -1;
+		prev = next;
+	}
+
+	__names[__zoneCount++] = strdup(zone);
+	return 0;
+}
+
+static void __print(FILE *out, const char *dir) {
+	int i;
+
+	fprintf(out, "/* Generated by tzgen from %s; do not edit */\n", dir);
+	fprintf(out, "#include <stdint.h>\n\n");
+
+	fprintf(out, "const uint32_t __tzone_count = %d;\n\n", __zoneCount);
+
+	fprintf(out, "const char *const __tzone_names[%d] = {\n", __zoneCount);
+	for (i = 0; i < __zoneCount; i++) fprintf(out, "\t\"%s\",\n", __names[i]);
+	fprintf(out, "};\n\n");
+
+	fprintf(out, "const uint16_t __tzone_first[%d] = {", __zoneCount + 1);
+	for (i = 0; i <= __zoneCount; i++) fprintf(out, "%s%u", i ? ", " : " ", __first[i]);
+	fprintf(out, " };\n\n");
+
+	fprintf(out, "const uint32_t __tzone_times[%d] = {", __entries);
+	for (i = 0; i < __entries; i++) fprintf(out, "%s%u,", i % 8 ? " " : "\n\t", __times[i]);
+	fprintf(out, "\n};\n\n");
+
+	fprintf(out, "const uint8_t __tzone_info[%d] = {", __entries);
+	for (i = 0; i < __entries; i++) fprintf(out, "%s0x%02x,", i % 12 ? " " : "\n\t", __info[i]);
+	fprintf(out, "\n};\n");
+}
+
+int main(int argc, char **argv) {
+	const char *dir = getenv("TZDIR");
+	char line[256];
+	FILE *list;
+	int opt, i, size;
+
+	if (!dir) dir = "/usr/share/zoneinfo";
+
+	while ((opt = getopt(argc, argv, "d:")) != -1) {
+		if (opt == 'd') dir = optarg;
+		else __usage();
+	}
+	if (optind != argc - 1) __usage();
+	setenv("TZDIR", dir, 1);
+
+	list = fopen(argv[optind], "r");
+	if (!list) {
+		perror(argv[optind]);
+		return 1;
+	}
+
+	// One zone name a line; '#' starts a comment
+	while (fgets(line, sizeof(line), list)) {
+		char *name = line + strspn(line, " \t");
+		name[strcspn(name, "# \t\r\n")] = '\0';
+		if (!*name) continue;
+
+		if (__zoneCount == MAX_ZONES) {
+			fprintf(stderr, "tzgen: more than %d zones\n", MAX_ZONES);
+			return 1;
+		}
+		if (__zone(dir, name) < 0) return 1;
+	}
+	fclose(list);
+
+	if (!__zoneCount) {
+		fprintf(stderr, "tzgen: %s lists no zones\n", argv[optind]);
+		return 1;
+	}
+	__first[__zoneCount] = (uint16_t)__entries;
+
+	__print(stdout, dir);
+
+	size = __entries * 5 + (__zoneCount + 1) * 2 + 4;
+	for (i = 0; i < __zoneCount; i++) size += 4 + strlen(__names[i]) + 1;
+	fprintf(stderr, "tzgen: %d zones, %d entries, %d bytes of table\n", __zoneCount, __entries, size);
+	return 0;
+}
@@ -0,0 +1,82 @@
+#include <string.h>
+#include <time.h>
+
+#include <gccore.h>
+
+#include "provision.h"
+#include "sysconf.h"
+#include "values.h"
+
+int tool_is_sysconf_key(const char *key) {
+	return strchr(key, '.') != NULL;
+}
+
+void tool_print_value(FILE *out, const char *path, const char *key, u32 rtc) {
+	u8 buf[0x4000];
+	char date[32];
+	s32 type, len, i;
+	time_t t;
+
+	if (!tool_is_sysconf_key(key)) {
+		if (SYSCONF_GetTxt(key, (char *)buf, sizeof(buf)) >= 0) fprintf(out, "%s: %s = %s\n", path, key, buf);
+		else fprintf(out, "%s: %s not found\n", path, key);
+		return;
+	}
+
+	type = SYSCONF_GetType(key);
+	len = SYSCONF_Get(key, buf, sizeof(buf));
+	if (type < 0 || len < 0) {
+		fprintf(out, "%s: %s not found\n", path, key);
+		return;
+	}
+
+	fprintf(out, "%s: %s =", path, key);
+	switch (type) {
+		case SYSCONF_BYTE:
+		case SYSCONF_BOOL:
+			fprintf(out, " %u", buf[0]);
+			break;
+		case SYSCONF_SHORT:
+			fprintf(out, " %u", *(u16 *)buf);
+			break;
+		case SYSCONF_LONG:
+			fprintf(out, " %u", *(u32 *)buf);
+			break;
+		default:
+			for (i = 0; i < len; i++) fprintf(out, " %02X", buf[i]);
+	}
+	if (!strcmp(key, "IPL.CB")) {
+		t = (time_t)*(u32 *)buf + rtc + EPOCH;
+		strftime(date, sizeof(date), "%Y-%m-%d %H:%M:%S", gmtime(&t));
+		fprintf(out, " (%s UTC at RTC %u)", date, rtc);
+	}
+	fprintf(out, "\n");
+}
+
+s32 tool_set_value(const char *key, const char *value, u32 rtc) {
+	u8 buf[0x4000];
+	u32 length, bias;
+	s32 ret;
+	struct tm tm;
+	const char *end;
+	long long t;
+
+	if (!tool_is_sysconf_key(key)) return SYSCONF_SetTxt(key, value);
+
+	// A date for the counter bias is turned into the bias that makes the console show it
+	if (!strcmp(key, "IPL.CB") && strchr(value, '-')) {
+		memset(&tm, 0, sizeof(tm));
+		end = strptime(value, "%Y-%m-%d %H:%M:%S", &tm);
+		if (!end || *end) return SYSCONF_EBADVALUE;
+		t = (long long)timegm(&tm) - EPOCH - rtc;
+		if (t < 0 || t > 0xFFFFFFFFLL) return SYSCONF_EBADVALUE;
+		bias = t;
+		return SYSCONF_SetCounterBias(bias);
+	}
+
+	length = 0;
+	ret = PROVISION_Encode(key, value, buf, sizeof(buf), &length);
+	if (ret == SYSCONF_ETOOBIG) return ret;
+	if (ret < 0) return SYSCONF_EBADVALUE;
+	return SYSCONF_Set(key, buf, length);
+}
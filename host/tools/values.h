@@ -0,0 +1,21 @@
+#ifndef __TOOLS_VALUES_H__
+#define __TOOLS_VALUES_H__
+
+#include <stdio.h>
+
+#include <gctypes.h>
+
+// Reading and writing single keys as text, shared by the tools. Works on whatever sysconf.c holds.
+
+#define EPOCH 946684800 // GameCube epoch (2000-01-01) as a Unix time
+
+// Keys with a dot (IPL.CB) are SYSCONF entries, anything else a setting.txt line
+int tool_is_sysconf_key(const char *key);
+
+// Prints "<path>: <key> = <value>"; IPL.CB also as the UTC date it gives at the RTC value rtc
+void tool_print_value(FILE *out, const char *path, const char *key, u32 rtc);
+
+// Numbers, hex bytes for arrays, text for setting.txt, or a YYYY-MM-DD HH:MM:SS date for IPL.CB
+s32 tool_set_value(const char *key, const char *value, u32 rtc);
+
+#endif
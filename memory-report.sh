@@ -0,0 +1,147 @@
+#!/bin/sh
+# Adds up what each object file and archive member puts into text, rodata, data and bss, from a
+# GNU ld link map, and checks the sums against a budget.
+#
+# Usage: memory-report.sh [-q] <link map> [<budget>]
+#
+# The budget has lines of "<module> <section> <max bytes>", '#' starting a comment. A module is an
+# object (wiirtc.o), an archive member (libsysconf.a(sysconf.o)), a whole archive (libogc.a) or '*'
+# for the program; a section is text, rodata, data, bss or all. The exit status is 1 if anything is
+# over. -q leaves out the table and only prints what is over budget.
+#
+# The heap isn't in the map: wiirtc-sim's bench output and --memory on the console give that.
+
+QUIET=0
+if [ "$1" = "-q" ]; then
+	QUIET=1
+	shift
+fi
+
+MAP=$1
+BUDGET=$2
+
+if [ -z "$MAP" ]; then
+	echo "Usage: $0 [-q] <link map> [<budget>]" >&2
+	exit 1
+fi
+if [ ! -r "$MAP" ]; then
+	echo "$0: can't read $MAP" >&2
+	exit 1
+fi
+if [ -n "$BUDGET" ] && [ ! -r "$BUDGET" ]; then
+	echo "$0: can't read $BUDGET" >&2
+	exit 1
+fi
+
+awk -v quiet="$QUIET" -v budget="$BUDGET" '
+# Not every awk has strtonum
+function hex(s,    n, i) {
+	n = 0
+	s = tolower(substr(s, 3))
+	for (i = 1; i <= length(s); i++) n = n * 16 + index("0123456789abcdef", substr(s, i, 1)) - 1
+	return n
+}
+
+# Output sections, by the first line of the memory map that names them
+function kind(sect) {
+	if (sect ~ /^\.(text|init|fini|plt|iplt)($|\.)/) return "text"
+	if (sect ~ /^\.(rodata|sdata2|eh_frame|eh_frame_hdr|gcc_except_table)($|\.)/) return "rodata"
+	if (sect ~ /^\.(data|sdata|got|got2|data\.rel\.ro|init_array|fini_array|ctors|dtors|tdata)($|\.)/) return "data"
+	if (sect ~ /^\.(bss|sbss|sbss2|tbss)($|\.)/) return "bss"
+	return ""
+}
+
+# build/libsysconf.a(sysconf.o) -> libsysconf.a(sysconf.o)
+function module(file) {
+	if (file ~ /\(/) {
+		archive = substr(file, 1, index(file, "(") - 1)
+		sub(/.*\//, "", archive)
+		return archive substr(file, index(file, "("))
+	}
+	sub(/.*\//, "", file)
+	return file
+}
+
+function add(file, size) {
+	if (current == "" || size == 0 || file == "") return
+	m = module(file)
+	if (!(m in seen)) {
+		seen[m] = 1
+		order[++modules] = m
+	}
+	bytes[m, current] += size
+	bytes[m, "all"] += size
+	total[current] += size
+	total["all"] += size
+}
+
+# A budgeted module also covers the members of an archive of that name
+function used(m, sect,    n, i, prefix) {
+	if (m == "*") return total[sect]
+	if (m in seen) return bytes[m, sect]
+	n = 0
+	prefix = m "("
+	for (i = 1; i <= modules; i++)
+		if (substr(order[i], 1, length(prefix)) == prefix) n += bytes[order[i], sect]
+	return n
+}
+
+/^Linker script and memory map/ { inmap = 1; next }
+!inmap { next }
+
+# An output section starts in the first column
+/^\.[^ ]/ { current = kind($1); next }
+/^[^ ]/ { current = ""; next }
+
+# Input sections: " .name 0xaddr 0xsize file", with long names on a line of their own
+# and the address, size and file on the next
+$1 ~ /^\./ && NF == 4 && $2 ~ /^0x/ && $3 ~ /^0x/ { add($4, hex($3)); next }
+$1 ~ /^\./ && NF == 1 { pending = 1; next }
+pending && NF == 3 && $1 ~ /^0x/ && $2 ~ /^0x/ { add($3, hex($2)); pending = 0; next }
+$1 == "COMMON" && NF == 4 { add($4, hex($3)); next }
+{ pending = 0 }
+
+END {
+	if (!quiet) {
+		printf "%-40s %8s %8s %8s %8s %8s\n", "module", "text", "rodata", "data", "bss", "all"
+		# Biggest first
+		for (i = 1; i <= modules; i++) {
+			for (j = i + 1; j <= modules; j++) {
+				if (bytes[order[j], "all"] > bytes[order[i], "all"]) {
+					t = order[i]; order[i] = order[j]; order[j] = t
+				}
+			}
+		}
+		for (i = 1; i <= modules; i++) {
+			m = order[i]
+			printf "%-40s %8d %8d %8d %8d %8d\n", m, bytes[m, "text"], bytes[m, "rodata"], bytes[m, "data"], bytes[m, "bss"], bytes[m, "all"]
+		}
+		printf "%-40s %8d %8d %8d %8d %8d\n", "total", total["text"], total["rodata"], total["data"], total["bss"], total["all"]
+	}
+
+	if (budget == "") exit 0
+
+	over = bad = checked = 0
+	while ((getline line < budget) > 0) {
+		lineNo++
+		if (line ~ /^[ \t]*(#|$)/) continue
+		if (split(line, f, /[ \t]+/) < 3 || f[2] !~ /^(text|rodata|data|bss|all)$/ || f[3] !~ /^[0-9]+$/) {
+			printf "%s:%d: bad line: %s\n", budget, lineNo, line
+			bad++
+			continue
+		}
+		checked++
+		n = used(f[1], f[2])
+		if (n > f[3] + 0) {
+			printf "%s %s is %d bytes, over the budget of %d\n", f[1], f[2], n, f[3]
+			over++
+		}
+	}
+	close(budget)
+
+	if (over || bad) {
+		printf "%d of %d memory budgets exceeded\n", over, checked
+		exit 1
+	}
+	printf "Within all %d memory budgets in %s\n", checked, budget
+}' "$MAP"
@@ -0,0 +1,64 @@
+#!/bin/sh
+# Compares wiirtc linked with --gc-sections against the same objects linked without it, and shows
+# how much of libsysconf.a made it into the binary.
+#
+# Usage: size-report.sh <libsysconf.a> <gc elf> <full elf> [<gc dol> <full dol>]
+#
+# SIZE and NM name the binutils to use (the console build passes powerpc-eabi-size and -nm).
+# The load time is the DOL size over SD_KBPS, the rate the Homebrew Channel reads the SD card at.
+# The default is a rough figure; set it to what your console measures. Without DOLs (the host
+# build), the text and data sizes stand in for what would be loaded.
+
+LIB=$1
+GCELF=$2
+FULLELF=$3
+GCDOL=$4
+FULLDOL=$5
+
+SIZE=${SIZE:-size}
+NM=${NM:-nm}
+SD_KBPS=${SD_KBPS:-1024}
+
+if [ -z "$FULLELF" ]; then
+	echo "Usage: $0 <libsysconf.a> <gc elf> <full elf> [<gc dol> <full dol>]" >&2
+	exit 1
+fi
+
+# text + data of an ELF, what ends up in a DOL
+loaded() {
+	"$SIZE" "$1" | awk 'NR == 2 { print $1 + $2 }'
+}
+
+bytes() {
+	wc -c < "$1" | tr -d ' '
+}
+
+echo "Sections:"
+"$SIZE" "$FULLELF" "$GCELF"
+
+# Functions libsysconf.a defines, and how many of them the linker kept
+"$NM" "$LIB" 2>/dev/null | awk '$2 ~ /^[Tt]$/ { print $3 }' | sort -u > "$GCELF.lib.syms"
+"$NM" "$GCELF" | awk '$2 ~ /^[Tt]$/ { print $3 }' | sort -u > "$GCELF.syms"
+total=$(wc -l < "$GCELF.lib.syms" | tr -d ' ')
+kept=$(comm -12 "$GCELF.lib.syms" "$GCELF.syms" | wc -l | tr -d ' ')
+rm -f "$GCELF.lib.syms" "$GCELF.syms"
+
+echo
+echo "libsysconf.a: $kept of $total functions linked"
+
+if [ -n "$FULLDOL" ]; then
+	full=$(bytes "$FULLDOL")
+	gc=$(bytes "$GCDOL")
+	what="DOL"
+else
+	full=$(loaded "$FULLELF")
+	gc=$(loaded "$GCELF")
+	what="text+data"
+fi
+
+awk -v full="$full" -v gc="$gc" -v kbps="$SD_KBPS" -v what="$what" 'BEGIN {
+	printf "%s without --gc-sections: %8d bytes, %6.1f ms to load\n", what, full, full * 1000 / (kbps * 1024)
+	printf "%s with --gc-sections:    %8d bytes, %6.1f ms to load\n", what, gc, gc * 1000 / (kbps * 1024)
+	printf "Saved: %d bytes (%.1f%%), %.1f ms at %d KiB/s\n", full - gc, full ? (full - gc) * 100 / full : 0,
+		(full - gc) * 1000 / (kbps * 1024), kbps
+}'
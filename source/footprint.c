@@ -0,0 +1,172 @@
+#include <malloc.h>
+#include <string.h>
+#include <ogc/machine/processor.h>
+
+#include "footprint.h"
+#include "sysconf.h"
+
+#define FOOTPRINT_MAX_BUFFERS 16
+#define FOOTPRINT_MAX_SYSCONF 10
+
+typedef struct _footprint_buffer
+{
+	const char *module;
+	const char *name;
+	const void *data;
+	u32 size;
+	BOOL heap;
+} footprint_buffer;
+
+static footprint_heap __footprint_heap;
+static footprint_buffer __footprint_buffers[FOOTPRINT_MAX_BUFFERS];
+static u32 __footprint_count = 0;
+
+// The allocator's own, which -Wl,--wrap points the unwrapped names at
+void *__real_malloc(size_t size);
+void *__real_calloc(size_t count, size_t size);
+void *__real_realloc(void *ptr, size_t size);
+void *__real_memalign(size_t align, size_t size);
+void __real_free(void *ptr);
+
+// Allocations come from the saver thread too, so the counters change with interrupts off
+static void __FOOTPRINT_Change(u32 added, u32 removed, u32 allocations, u32 frees, u32 failures)
+{
+	u32 level;
+
+	_CPU_ISR_Disable(level);
+	__footprint_heap.inUse += added - removed;
+	if (__footprint_heap.inUse > __footprint_heap.peak)
+		__footprint_heap.peak = __footprint_heap.inUse;
+	__footprint_heap.allocations += allocations;
+	__footprint_heap.frees += frees;
+	__footprint_heap.failures += failures;
+	_CPU_ISR_Restore(level);
+}
+
+static void *__FOOTPRINT_Allocated(void *ptr, size_t size)
+{
+	if (ptr)
+		__FOOTPRINT_Change(malloc_usable_size(ptr), 0, 1, 0, 0);
+	else if (size)
+		__FOOTPRINT_Change(0, 0, 0, 0, 1);
+	return ptr;
+}
+
+void *__wrap_malloc(size_t size)
+{
+	return __FOOTPRINT_Allocated(__real_malloc(size), size);
+}
+
+void *__wrap_calloc(size_t count, size_t size)
+{
+	return __FOOTPRINT_Allocated(__real_calloc(count, size), count * size);
+}
+
+void *__wrap_memalign(size_t align, size_t size)
+{
+	return __FOOTPRINT_Allocated(__real_memalign(align, size), size);
+}
+
+void *__wrap_realloc(void *ptr, size_t size)
+{
+	u32 before = ptr ? malloc_usable_size(ptr) : 0;
+	void *ret;
+
+	if (!ptr)
+		return __wrap_malloc(size);
+
+	ret = __real_realloc(ptr, size);
+	if (ret)
+		__FOOTPRINT_Change(malloc_usable_size(ret), before, 0, 0, 0);
+	else if (size)
+		__FOOTPRINT_Change(0, 0, 0, 0, 1);
+	else
+		__FOOTPRINT_Change(0, before, 0, 1, 0); // realloc to nothing frees
+	return ret;
+}
+
+void __wrap_free(void *ptr)
+{
+	if (ptr)
+		__FOOTPRINT_Change(0, malloc_usable_size(ptr), 0, 1, 0);
+	__real_free(ptr);
+}
+
+void FOOTPRINT_GetHeap(footprint_heap *heap)
+{
+	u32 level;
+
+	_CPU_ISR_Disable(level);
+	*heap = __footprint_heap;
+	_CPU_ISR_Restore(level);
+}
+
+s32 FOOTPRINT_Register(const char *module, const char *name, const void *data, u32 size, BOOL heap)
+{
+	u32 i;
+
+	for (i = 0; i < __footprint_count; i++)
+	{
+		if (!strcmp(__footprint_buffers[i].module, module) && !strcmp(__footprint_buffers[i].name, name))
+			break;
+	}
+
+	if (!data)
+	{
+		if (i < __footprint_count)
+		{
+			memmove(&__footprint_buffers[i], &__footprint_buffers[i + 1], (__footprint_count - i - 1) * sizeof(footprint_buffer));
+			__footprint_count--;
+		}
+		return FOOTPRINT_ERR_OK;
+	}
+
+	if (i == __footprint_count)
+	{
+		if (__footprint_count == FOOTPRINT_MAX_BUFFERS)
+			return FOOTPRINT_EFULL;
+		__footprint_count++;
+	}
+
+	__footprint_buffers[i].module = module;
+	__footprint_buffers[i].name = name;
+	__footprint_buffers[i].data = data;
+	__footprint_buffers[i].size = size;
+	__footprint_buffers[i].heap = heap;
+	return FOOTPRINT_ERR_OK;
+}
+
+static void __FOOTPRINT_PrintBuffer(FILE *fp, const char *module, const char *name, u32 size, BOOL heap, u32 *total, u32 *onHeap)
+{
+	fprintf(fp, "  %-10s %-22s %8u %s\n", module, name, size, heap ? "heap" : "static");
+	*total += size;
+	if (heap)
+		*onHeap += size;
+}
+
+void FOOTPRINT_Report(FILE *fp)
+{
+	footprint_heap heap;
+	sysconf_buffer sysconf[FOOTPRINT_MAX_SYSCONF];
+	s32 count;
+	u32 i, total = 0, onHeap = 0;
+
+	FOOTPRINT_GetHeap(&heap);
+	fprintf(fp, "Heap: %u bytes in use, %u at most; %u allocations, %u frees, %u failed\n", heap.inUse, heap.peak,
+		heap.allocations, heap.frees, heap.failures);
+
+	fprintf(fp, "Buffers:\n");
+	for (i = 0; i < __footprint_count; i++)
+	{
+		footprint_buffer *b = &__footprint_buffers[i];
+		__FOOTPRINT_PrintBuffer(fp, b->module, b->name, b->size, b->heap, &total, &onHeap);
+	}
+
+	count = SYSCONF_GetBuffers(sysconf, FOOTPRINT_MAX_SYSCONF);
+	if (count > FOOTPRINT_MAX_SYSCONF)
+		count = FOOTPRINT_MAX_SYSCONF;
+	for (i = 0; i < count; i++)
+		__FOOTPRINT_PrintBuffer(fp, "sysconf", sysconf[i].name, sysconf[i].size, sysconf[i].heap, &total, &onHeap);
+
+	fprintf(fp, "Total: %u bytes in buffers, %u of them on the heap\n", total, onHeap);
+}
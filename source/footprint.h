@@ -0,0 +1,44 @@
+#ifndef __FOOTPRINT_H__
+#define __FOOTPRINT_H__
+
+#include <stdio.h>
+#include <gctypes.h>
+
+#define FOOTPRINT_EFULL -0x6401
+#define FOOTPRINT_ERR_OK 0
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif /* __cplusplus */
+
+	/*
+	 * What wiirtc holds in memory while it runs. Text, data and BSS come from the link map instead,
+	 * see memory-report.sh.
+	 *
+	 * The heap figures count every malloc, calloc, realloc, memalign and free made by wiirtc and
+	 * the libraries it links, which the Makefiles route through here with -Wl,--wrap. The C
+	 * library's own allocations (stdio buffers and the like) call its internal allocator
+	 * directly and aren't seen.
+	 */
+
+	typedef struct _footprint_heap
+	{
+		u32 inUse; /* Bytes, as the allocator rounds them */
+		u32 peak;
+		u32 allocations;
+		u32 frees;
+		u32 failures;
+	} footprint_heap;
+
+	void FOOTPRINT_GetHeap(footprint_heap *heap);
+	/* Records a buffer owned by module. The same module and name again replaces the entry, NULL data drops it */
+	s32 FOOTPRINT_Register(const char *module, const char *name, const void *data, u32 size, BOOL heap);
+	/* The heap figures and every registered buffer by module, followed by sysconf.c's own */
+	void FOOTPRINT_Report(FILE *fp);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif
@@ -0,0 +1,314 @@
+#include <malloc.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ogc/ipc.h>
+#include <ogc/lwp_watchdog.h>
+#include <ogc/pad.h>
+#include <ogc/video.h>
+#include <wiiuse/wpad.h>
+
+#include "platbench.h"
+
+extern u32 __SYS_GetRTC(u32 *gctime);
+
+#define PLATBENCH_IPC_SAMPLES 64
+#define PLATBENCH_RTC_SAMPLES 1000
+#define PLATBENCH_VSYNC_SAMPLES 120
+#define PLATBENCH_SCAN_SAMPLES 200
+#define PLATBENCH_GLYPH_SAMPLES 100
+#define PLATBENCH_LINE_GLYPHS 64
+// Buckets to each doubling of the time, so none is wider than an eighth of what it holds
+#define PLATBENCH_SUB_BUCKETS 8
+
+static const char __platbench_sysconf[] ATTRIBUTE_ALIGN(32) = "/shared2/sys/SYSCONF";
+
+static const struct
+{
+	const char *name;
+	u32 samples;
+} __platbench_tests[PLATBENCH_TESTS] = {
+	{ "ipc_open", PLATBENCH_IPC_SAMPLES },
+	{ "ipc_read", PLATBENCH_IPC_SAMPLES },
+	{ "ipc_close", PLATBENCH_IPC_SAMPLES },
+	{ "rtc_read", PLATBENCH_RTC_SAMPLES },
+	{ "vsync_jitter", PLATBENCH_VSYNC_SAMPLES },
+	{ "wpad_scan", PLATBENCH_SCAN_SAMPLES },
+	{ "pad_scan", PLATBENCH_SCAN_SAMPLES },
+	{ "glyph_line", PLATBENCH_GLYPH_SAMPLES },
+};
+
+static u32 __PLATBENCH_Ns(u64 start, u64 end)
+{
+	u64 ns = ticks_to_nanosecs(diff_ticks(start, end));
+
+	return ns > 0xFFFFFFFF ? 0xFFFFFFFF : ns;
+}
+
+static s32 __PLATBENCH_Ipc(u32 *open, u32 *read, u32 *close)
+{
+	u8 *buffer = memalign(32, 0x4000);
+	u64 t0, t1, t2, t3;
+	s32 fd, ret = PLATBENCH_ERR_OK;
+	u32 i;
+
+	if (!buffer)
+		return PLATBENCH_ENOMEM;
+
+	for (i = 0; i < PLATBENCH_IPC_SAMPLES; i++)
+	{
+		t0 = gettime();
+		fd = IOS_Open(__platbench_sysconf, 1);
+		t1 = gettime();
+		if (fd < 0)
+		{
+			ret = PLATBENCH_EIPC;
+			break;
+		}
+		ret = IOS_Read(fd, buffer, 0x4000);
+		t2 = gettime();
+		IOS_Close(fd);
+		t3 = gettime();
+		if (ret != 0x4000)
+		{
+			ret = PLATBENCH_EIPC;
+			break;
+		}
+		ret = PLATBENCH_ERR_OK;
+
+		open[i] = __PLATBENCH_Ns(t0, t1);
+		read[i] = __PLATBENCH_Ns(t1, t2);
+		close[i] = __PLATBENCH_Ns(t2, t3);
+	}
+
+	free(buffer);
+	return ret;
+}
+
+static s32 __PLATBENCH_Rtc(u32 *samples)
+{
+	u64 start;
+	u32 i, rtc;
+
+	for (i = 0; i < PLATBENCH_RTC_SAMPLES; i++)
+	{
+		start = gettime();
+		if (!__SYS_GetRTC(&rtc))
+			return PLATBENCH_ERTC;
+		samples[i] = __PLATBENCH_Ns(start, gettime());
+	}
+	return PLATBENCH_ERR_OK;
+}
+
+static void __PLATBENCH_VSync(u32 *samples)
+{
+	u64 last, now;
+	u32 i;
+
+	// Start on a vsync, so the first period is a whole one
+	VIDEO_WaitVSync();
+	last = gettime();
+	for (i = 0; i < PLATBENCH_VSYNC_SAMPLES; i++)
+	{
+		VIDEO_WaitVSync();
+		now = gettime();
+		samples[i] = __PLATBENCH_Ns(last, now);
+		last = now;
+	}
+}
+
+static void __PLATBENCH_Scans(u32 *wpad, u32 *pad)
+{
+	u64 t0, t1, t2;
+	u32 i;
+
+	for (i = 0; i < PLATBENCH_SCAN_SAMPLES; i++)
+	{
+		t0 = gettime();
+		WPAD_ScanPads();
+		t1 = gettime();
+		PAD_ScanPads();
+		t2 = gettime();
+
+		wpad[i] = __PLATBENCH_Ns(t0, t1);
+		pad[i] = __PLATBENCH_Ns(t1, t2);
+	}
+}
+
+// Redraws the same console line over and over, so the screen doesn't scroll
+static void __PLATBENCH_Glyphs(u32 *samples)
+{
+	char line[PLATBENCH_LINE_GLYPHS + 1];
+	u64 start;
+	u32 i;
+
+	for (i = 0; i < PLATBENCH_LINE_GLYPHS; i++)
+		line[i] = '!' + i % 94;
+	line[PLATBENCH_LINE_GLYPHS] = '\0';
+
+	for (i = 0; i < PLATBENCH_GLYPH_SAMPLES; i++)
+	{
+		putchar('\r');
+		start = gettime();
+		fputs(line, stdout);
+		fflush(stdout);
+		samples[i] = __PLATBENCH_Ns(start, gettime());
+	}
+	printf("\r%*s\r", PLATBENCH_LINE_GLYPHS, "");
+	fflush(stdout);
+}
+
+static int __PLATBENCH_Compare(const void *a, const void *b)
+{
+	u32 x = *(const u32 *)a, y = *(const u32 *)b;
+
+	return (x > y) - (x < y);
+}
+
+// Bucket n covers [n, n + 1) below PLATBENCH_SUB_BUCKETS ns, then each doubling is split in PLATBENCH_SUB_BUCKETS
+static u32 __PLATBENCH_Bucket(u32 ns)
+{
+	u32 octave = 0;
+
+	if (ns < PLATBENCH_SUB_BUCKETS)
+		return ns;
+	while ((ns >> octave) >= 2 * PLATBENCH_SUB_BUCKETS)
+		octave++;
+	return (octave + 1) * PLATBENCH_SUB_BUCKETS + (ns >> octave) - PLATBENCH_SUB_BUCKETS;
+}
+
+static u64 __PLATBENCH_BucketStart(u32 bucket)
+{
+	u32 octave;
+
+	if (bucket < PLATBENCH_SUB_BUCKETS)
+		return bucket;
+	octave = bucket / PLATBENCH_SUB_BUCKETS - 1;
+	return (u64)(PLATBENCH_SUB_BUCKETS + bucket % PLATBENCH_SUB_BUCKETS) << octave;
+}
+
+// The samples are sorted, so each bucket is a run of them
+static void __PLATBENCH_WriteHistogram(FILE *fp, const char *name, const u32 *samples, u32 count)
+{
+	u32 i, run, bucket;
+
+	for (i = 0; i < count; i += run)
+	{
+		bucket = __PLATBENCH_Bucket(samples[i]);
+		for (run = 1; i + run < count && __PLATBENCH_Bucket(samples[i + run]) == bucket; run++)
+			;
+		fprintf(fp, "%s,%llu,%llu,%u\n", name, (unsigned long long)__PLATBENCH_BucketStart(bucket),
+			(unsigned long long)__PLATBENCH_BucketStart(bucket + 1), run);
+	}
+}
+
+static s32 __PLATBENCH_Write(const char *histogramPath, const char *summaryPath, platbench_report *report, u32 **samples)
+{
+	platbench_result *result;
+	FILE *fp;
+	u32 i;
+
+	if (histogramPath)
+	{
+		fp = fopen(histogramPath, "w");
+		if (!fp)
+			return PLATBENCH_EFILE;
+		fprintf(fp, "test,from_ns,to_ns,count\n");
+		for (i = 0; i < PLATBENCH_TESTS; i++)
+			__PLATBENCH_WriteHistogram(fp, report->results[i].name, samples[i], report->results[i].samples);
+		if (fclose(fp))
+			return PLATBENCH_EFILE;
+	}
+
+	if (summaryPath)
+	{
+		fp = fopen(summaryPath, "w");
+		if (!fp)
+			return PLATBENCH_EFILE;
+		fprintf(fp, "test,samples,min_ns,median_ns,p99_ns,max_ns,detail,detail_value\n");
+		for (i = 0; i < PLATBENCH_TESTS; i++)
+		{
+			result = &report->results[i];
+			fprintf(fp, "%s,%u,%u,%u,%u,%u,", result->name, result->samples, result->minNs, result->medianNs, result->p99Ns, result->maxNs);
+			if (result->detailName)
+				fprintf(fp, "%s,%u\n", result->detailName, result->detail);
+			else
+				fprintf(fp, ",\n");
+		}
+		if (fclose(fp))
+			return PLATBENCH_EFILE;
+	}
+	return PLATBENCH_ERR_OK;
+}
+
+s32 PLATBENCH_Run(const char *histogramPath, const char *summaryPath, platbench_report *report)
+{
+	u32 *samples[PLATBENCH_TESTS];
+	u32 *all, total = 0, i, j, median;
+	u64 start = gettime();
+	platbench_result *result;
+	s32 ret;
+
+	memset(report, 0, sizeof(*report));
+
+	for (i = 0; i < PLATBENCH_TESTS; i++)
+		total += __platbench_tests[i].samples;
+	all = malloc(total * sizeof(u32));
+	if (!all)
+		return PLATBENCH_ENOMEM;
+	for (i = 0, total = 0; i < PLATBENCH_TESTS; total += __platbench_tests[i].samples, i++)
+		samples[i] = &all[total];
+
+	ret = __PLATBENCH_Ipc(samples[PLATBENCH_IPC_OPEN], samples[PLATBENCH_IPC_READ], samples[PLATBENCH_IPC_CLOSE]);
+	if (ret >= 0)
+		ret = __PLATBENCH_Rtc(samples[PLATBENCH_RTC_READ]);
+	if (ret < 0)
+	{
+		free(all);
+		return ret;
+	}
+	__PLATBENCH_VSync(samples[PLATBENCH_VSYNC]);
+	__PLATBENCH_Scans(samples[PLATBENCH_WPAD_SCAN], samples[PLATBENCH_PAD_SCAN]);
+	__PLATBENCH_Glyphs(samples[PLATBENCH_GLYPHS]);
+
+	for (i = 0; i < PLATBENCH_TESTS; i++)
+	{
+		result = &report->results[i];
+		result->name = __platbench_tests[i].name;
+		result->samples = __platbench_tests[i].samples;
+		qsort(samples[i], result->samples, sizeof(u32), __PLATBENCH_Compare);
+
+		// What varies from one period to the next is the interesting part, not the period itself
+		if (i == PLATBENCH_VSYNC)
+		{
+			median = samples[i][result->samples / 2];
+			for (j = 0; j < result->samples; j++)
+				samples[i][j] = samples[i][j] > median ? samples[i][j] - median : median - samples[i][j];
+			qsort(samples[i], result->samples, sizeof(u32), __PLATBENCH_Compare);
+			result->detailName = "period_ns";
+			result->detail = median;
+		}
+
+		result->minNs = samples[i][0];
+		result->medianNs = samples[i][result->samples / 2];
+		result->p99Ns = samples[i][result->samples * 99 / 100];
+		result->maxNs = samples[i][result->samples - 1];
+	}
+
+	// A read that had to try again made twice the EXI transfers of the fastest; allow for some noise
+	result = &report->results[PLATBENCH_RTC_READ];
+	result->detailName = "retried_reads";
+	for (j = 0; j < result->samples; j++)
+		if (samples[PLATBENCH_RTC_READ][j] >= result->minNs / 4 * 7)
+			result->detail++;
+
+	result = &report->results[PLATBENCH_GLYPHS];
+	result->detailName = "glyphs_per_sec";
+	if (result->medianNs)
+		result->detail = (u64)PLATBENCH_LINE_GLYPHS * 1000000000 / result->medianNs;
+
+	ret = __PLATBENCH_Write(histogramPath, summaryPath, report, samples);
+	free(all);
+	report->elapsedMs = ticks_to_millisecs(diff_ticks(start, gettime()));
+	return ret;
+}
@@ -0,0 +1,68 @@
+#ifndef __PLATBENCH_H__
+#define __PLATBENCH_H__
+
+#include <gctypes.h>
+
+#define PLATBENCH_ENOMEM -0x6601
+#define PLATBENCH_EIPC -0x6602
+#define PLATBENCH_ERTC -0x6603
+#define PLATBENCH_EFILE -0x6604
+#define PLATBENCH_ERR_OK 0
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif /* __cplusplus */
+
+	/*
+	 * Measures what the console itself costs, apart from anything wiirtc does: IOS round trips on
+	 * SYSCONF, RTC reads over EXI, the display period, controller scans and console text. Every
+	 * sample is a timebase difference, in nanoseconds.
+	 *
+	 * The histograms have fixed buckets, eight to each doubling of the time, so files from different
+	 * consoles line up bucket for bucket.
+	 */
+
+	enum
+	{
+		PLATBENCH_IPC_OPEN = 0,
+		PLATBENCH_IPC_READ, /* All 16 KiB of SYSCONF */
+		PLATBENCH_IPC_CLOSE,
+		PLATBENCH_RTC_READ,
+		PLATBENCH_VSYNC,     /* How far each period is from the median one */
+		PLATBENCH_WPAD_SCAN,
+		PLATBENCH_PAD_SCAN,
+		PLATBENCH_GLYPHS,    /* One line of text, drawn and flushed */
+		PLATBENCH_TESTS
+	};
+
+	typedef struct _platbench_result
+	{
+		const char *name;
+		u32 samples;
+		u32 minNs;
+		u32 medianNs;
+		u32 p99Ns;
+		u32 maxNs;
+		/* One more figure for some tests, or NULL: RTC reads that took a retry, going by how long
+		   they took since libogc doesn't say; the median display period; glyphs drawn a second */
+		const char *detailName;
+		u32 detail;
+	} platbench_result;
+
+	typedef struct _platbench_report
+	{
+		platbench_result results[PLATBENCH_TESTS];
+		u32 elapsedMs;
+	} platbench_report;
+
+	/* Runs every test, for a few seconds in all, drawing on the current console line as it goes.
+	   The histograms and the summary are written as CSV to either path that isn't NULL; report is
+	   filled in even if writing them fails. */
+	s32 PLATBENCH_Run(const char *histogramPath, const char *summaryPath, platbench_report *report);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif
@@ -0,0 +1,31 @@
+#ifndef __PROFILE_H__
+#define __PROFILE_H__
+
+/*
+ * Frame time accounting for benchmark builds. Each PROFILE_Enter charges everything from
+ * then until the next PROFILE_Enter (or the next VSync wait) to that section, so early
+ * continues in the main loop can't leave a section open.
+ * PROFILE_Sync hands over what an SNTP sync made of the time, which the simulator checks
+ * against the true time it gave its stand-in server.
+ * Compiled out unless WIIRTC_PROFILE is defined; the host build supplies the implementation.
+ */
+
+enum
+{
+	PROFILE_NONE = 0,
+	PROFILE_INPUT,
+	PROFILE_FORMAT,
+	PROFILE_RENDER,
+	PROFILE_SAVE,
+	PROFILE_SECTIONS
+};
+
+#ifdef WIIRTC_PROFILE
+void PROFILE_Enter(int section);
+void PROFILE_Sync(long long offsetUs, unsigned elapsedMs);
+#else
+#define PROFILE_Enter(section) do { } while (0)
+#define PROFILE_Sync(offsetUs, elapsedMs) do { } while (0)
+#endif
+
+#endif
@@ -0,0 +1,290 @@
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <ogc/lwp_watchdog.h>
+
+#include "provision.h"
+#include "sysconf.h"
+
+static const char *__provision_games[] = {"JP", "US", "EU", "KR", "CN", NULL};
+static const char *__provision_areas[] = {"JPN", "USA", "EUR", "AUS", "BRA", "TWN", "ROC", "KOR", "HKG", "ASI", "LTN", "SAF", NULL};
+static const char *__provision_videos[] = {"NTSC", "PAL", "MPAL", NULL};
+
+static int __PROVISION_InList(const char *value, const char **list)
+{
+	for (; *list; list++)
+		if (!strcmp(value, *list))
+			return 1;
+	return 0;
+}
+
+static char *__PROVISION_Trim(char *str)
+{
+	char *end;
+
+	while (isspace((unsigned char)*str))
+		str++;
+
+	end = str + strlen(str);
+	while (end > str && isspace((unsigned char)end[-1]))
+		*--end = 0;
+
+	return str;
+}
+
+static s32 __PROVISION_Parse(const char *path, provision_report *report)
+{
+	char line[128];
+	char *name, *value, *eq;
+	FILE *fp;
+
+	fp = fopen(path, "r");
+	if (!fp)
+		return PROVISION_EOPEN;
+
+	while (fgets(line, sizeof(line), fp))
+	{
+		name = __PROVISION_Trim(line);
+		if (!*name || *name == '#')
+			continue;
+
+		eq = strchr(name, '=');
+		if (!eq)
+		{
+			fclose(fp);
+			return PROVISION_ESYNTAX;
+		}
+		*eq = 0;
+		name = __PROVISION_Trim(name);
+		value = __PROVISION_Trim(eq + 1);
+
+		if (!*name || strlen(name) >= sizeof(report->keys[0].name) || strlen(value) >= sizeof(report->keys[0].value))
+		{
+			fclose(fp);
+			return PROVISION_ESYNTAX;
+		}
+
+		if (report->count == PROVISION_MAX_KEYS)
+		{
+			fclose(fp);
+			return PROVISION_ETOOMANY;
+		}
+
+		strcpy(report->keys[report->count].name, name);
+		strcpy(report->keys[report->count].value, value);
+		report->keys[report->count].result = SYSCONF_ERR_OK;
+		report->count++;
+	}
+
+	fclose(fp);
+	return PROVISION_ERR_OK;
+}
+
+static int __PROVISION_IsSysconfKey(const char *name)
+{
+	return strchr(name, '.') != NULL;
+}
+
+static int __PROVISION_HexNibble(char c)
+{
+	if (c >= '0' && c <= '9')
+		return c - '0';
+	if (c >= 'a' && c <= 'f')
+		return c - 'a' + 10;
+	if (c >= 'A' && c <= 'F')
+		return c - 'A' + 10;
+	return -1;
+}
+
+/* Turns a value into exactly the bytes SYSCONF_Set wants for this entry */
+s32 PROVISION_Encode(const char *name, const char *value, u8 *buf, u32 size, u32 *length)
+{
+	s32 type, len;
+	unsigned long long num;
+	char *end;
+	const char *p;
+	u32 i;
+
+	type = SYSCONF_GetType(name);
+	if (type < 0)
+		return type;
+	len = SYSCONF_GetLength(name);
+	if (len < 0)
+		return len;
+	if ((u32)len > size)
+		return SYSCONF_ETOOBIG;
+
+	switch (type)
+	{
+	case SYSCONF_BIGARRAY:
+	case SYSCONF_SMALLARRAY:
+		/* Arrays are given as hex, whitespace allowed between bytes, and must fill the entry exactly */
+		for (i = 0, p = value; *p; i++)
+		{
+			while (isspace((unsigned char)*p))
+				p++;
+			if (!*p)
+				break;
+			if (i == len || __PROVISION_HexNibble(p[0]) < 0 || __PROVISION_HexNibble(p[1]) < 0)
+				return SYSCONF_EBADVALUE;
+			buf[i] = (__PROVISION_HexNibble(p[0]) << 4) | __PROVISION_HexNibble(p[1]);
+			p += 2;
+		}
+		if (i != len)
+			return SYSCONF_EBADVALUE;
+		break;
+
+	case SYSCONF_BYTE:
+	case SYSCONF_SHORT:
+	case SYSCONF_LONG:
+	case SYSCONF_BOOL:
+		num = strtoull(value, &end, 0);
+		if (!*value || *end || value[0] == '-')
+			return SYSCONF_EBADVALUE;
+		if ((type == SYSCONF_BOOL && num > 1) || (len < 8 && num >> (len * 8)))
+			return SYSCONF_EBADVALUE;
+
+		if (len == 1)
+			buf[0] = num;
+		else if (len == 2)
+		{
+			u16 v = num;
+			memcpy(buf, &v, 2);
+		}
+		else
+		{
+			u32 v = num;
+			memcpy(buf, &v, 4);
+		}
+		break;
+
+	default:
+		return SYSCONF_ENOTIMPL;
+	}
+
+	*length = len;
+	return SYSCONF_ERR_OK;
+}
+
+static s32 __PROVISION_ValidateTxt(const provision_key *key)
+{
+	char current[64];
+	const char *p;
+	s32 ret;
+
+	/* Only lines the console already has can be changed */
+	ret = SYSCONF_GetTxt(key->name, current, sizeof(current));
+	if (ret < 0)
+		return ret;
+
+	if (!*key->value)
+		return SYSCONF_EBADVALUE;
+	for (p = key->value; *p; p++)
+		if (*p < 0x20 || *p > 0x7E || *p == '=')
+			return SYSCONF_EBADVALUE;
+
+	if (!strcmp(key->name, "GAME") && !__PROVISION_InList(key->value, __provision_games))
+		return SYSCONF_EBADVALUE;
+	if (!strcmp(key->name, "AREA") && !__PROVISION_InList(key->value, __provision_areas))
+		return SYSCONF_EBADVALUE;
+	if (!strcmp(key->name, "VIDEO") && !__PROVISION_InList(key->value, __provision_videos))
+		return SYSCONF_EBADVALUE;
+
+	return SYSCONF_ERR_OK;
+}
+
+/* Whether the key's value is what SYSCONF now holds, after a commit that only partly went through */
+static int __PROVISION_Saved(const provision_key *key, u8 *buf, u32 size)
+{
+	u8 current[0x461];
+	char text[64];
+	u32 length;
+	s32 len;
+
+	if (!__PROVISION_IsSysconfKey(key->name))
+		return SYSCONF_GetTxt(key->name, text, sizeof(text)) >= 0 && !strcmp(text, key->value);
+
+	if (PROVISION_Encode(key->name, key->value, buf, size, &length) < 0)
+		return 0;
+	len = SYSCONF_Get(key->name, current, sizeof(current));
+	return len == (s32)length && !memcmp(current, buf, length);
+}
+
+s32 PROVISION_Apply(const char *path, provision_report *report)
+{
+	u8 buf[0x461];
+	u32 length;
+	u64 start = gettime();
+	int i, invalid = 0;
+	s32 ret;
+
+	memset(report, 0, sizeof(*report));
+
+	ret = __PROVISION_Parse(path, report);
+	if (ret < 0)
+		goto out;
+
+	/* Check every key before touching anything */
+	for (i = 0; i < report->count; i++)
+	{
+		provision_key *key = &report->keys[i];
+
+		if (__PROVISION_IsSysconfKey(key->name))
+			key->result = PROVISION_Encode(key->name, key->value, buf, sizeof(buf), &length);
+		else
+			key->result = __PROVISION_ValidateTxt(key);
+
+		if (key->result < 0)
+			invalid = 1;
+	}
+	if (invalid)
+	{
+		ret = PROVISION_EINVALID;
+		goto out;
+	}
+
+	ret = SYSCONF_BeginTransaction();
+	if (ret < 0)
+		goto out;
+
+	for (i = 0; i < report->count; i++)
+	{
+		provision_key *key = &report->keys[i];
+
+		if (__PROVISION_IsSysconfKey(key->name))
+		{
+			PROVISION_Encode(key->name, key->value, buf, sizeof(buf), &length);
+			key->result = SYSCONF_Set(key->name, buf, length);
+		}
+		else
+		{
+			key->result = SYSCONF_SetTxt(key->name, key->value);
+		}
+
+		if (key->result < 0)
+		{
+			ret = key->result;
+			SYSCONF_AbortTransaction();
+			goto out;
+		}
+	}
+
+	ret = SYSCONF_CommitTransaction();
+	if (ret == SYSCONF_ECOMMITTED)
+	{
+		/* Some of it is on NAND and the transaction is over; mark the keys that didn't make it */
+		for (i = 0; i < report->count; i++)
+			if (!__PROVISION_Saved(&report->keys[i], buf, sizeof(buf)))
+				report->keys[i].result = SYSCONF_EBADWRITE;
+	}
+	else if (ret < 0)
+	{
+		SYSCONF_AbortTransaction();
+	}
+
+out:
+	report->elapsedMs = ticks_to_millisecs(diff_ticks(start, gettime()));
+	return ret;
+}
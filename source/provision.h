@@ -0,0 +1,51 @@
+#ifndef __PROVISION_H__
+#define __PROVISION_H__
+
+#include <gctypes.h>
+
+#define PROVISION_EOPEN -0x6201
+#define PROVISION_ESYNTAX -0x6202
+#define PROVISION_ETOOMANY -0x6203
+#define PROVISION_EINVALID -0x6204
+#define PROVISION_ERR_OK 0
+
+#define PROVISION_MAX_KEYS 32
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif /* __cplusplus */
+
+	typedef struct _provision_key
+	{
+		char name[16];
+		char value[64];
+		s32 result; /* SYSCONF_ERR_OK, or why this key failed */
+	} provision_key;
+
+	typedef struct _provision_report
+	{
+		int count;
+		provision_key keys[PROVISION_MAX_KEYS];
+		u32 elapsedMs;
+	} provision_report;
+
+	/*
+	 * Applies a profile of key=value lines in one transaction.
+	 * Names with a dot (IPL.CB, NET.WCFG) are SYSCONF entries and take a number, or hex bytes for arrays.
+	 * Anything else (GAME, AREA, VIDEO) is a setting.txt line and takes its text value.
+	 * Every value is checked before anything is staged, and nothing is written unless all of them pass.
+	 * If the commit fails after writing a file, it returns SYSCONF_ECOMMITTED and marks each key whose
+	 * value isn't saved with SYSCONF_EBADWRITE; the rest stay saved.
+	 */
+	s32 PROVISION_Apply(const char *path, provision_report *report);
+
+	/* Turns one SYSCONF value from its profile text into what SYSCONF_Set takes, in buf of size bytes.
+	   An entry longer than that is refused with SYSCONF_ETOOBIG. */
+	s32 PROVISION_Encode(const char *name, const char *value, u8 *buf, u32 size, u32 *length);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif
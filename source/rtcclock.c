@@ -0,0 +1,162 @@
+#include <ogc/lwp_watchdog.h>
+
+#include "rtcclock.h"
+
+extern u32 __SYS_GetRTC(u32 *gctime);
+
+// Every so often, spend one EXI read confirming the timebase still agrees with the RTC
+#define RTCCLOCK_CHECK_INTERVAL_SECS 60
+// Re-anchor from scratch after this long regardless, so crystal drift between the two never builds up
+#define RTCCLOCK_RESYNC_INTERVAL_SECS (30 * 60)
+// With no anchor to predict the tick from, read the RTC this often until it ticks
+#define RTCCLOCK_POLL_INTERVAL_MS 1
+
+static int __rtcclock_inited = 0;
+static u32 __rtcclock_anchor_rtc;
+static u64 __rtcclock_anchor_ticks;
+static u32 __rtcclock_anchor_window;
+static u64 __rtcclock_checked_ticks;
+static u32 __rtcclock_reads = 0;
+
+static s32 __RTCCLOCK_Read(u32 *rtc)
+{
+	__rtcclock_reads++;
+	if (__SYS_GetRTC(rtc) == 0)
+		return RTCCLOCK_ERTC;
+	return RTCCLOCK_ERR_OK;
+}
+
+// Polls the RTC until it moves on from the second it read first, a read every interval ticks or back to back for 0
+static s32 __RTCCLOCK_PollTick(u64 interval, u32 *rtc, u64 *edgeTicks, u32 *windowUs)
+{
+	u64 lastOldTicks, readStart, readEnd, deadline;
+	u32 old;
+	s32 ret;
+
+	lastOldTicks = gettime();
+	ret = __RTCCLOCK_Read(&old);
+	if (ret < 0)
+		return ret;
+	deadline = lastOldTicks + secs_to_ticks(2); // It ticks once a second, so something is wrong past this
+
+	while (1)
+	{
+		readStart = gettime();
+		while (readStart < lastOldTicks + interval)
+			readStart = gettime();
+		ret = __RTCCLOCK_Read(rtc);
+		if (ret < 0)
+			return ret;
+		readEnd = gettime();
+
+		if (*rtc != old)
+		{
+			// The tick happened somewhere between the start of the last read that still saw the old second and the end of this one
+			*edgeTicks = readEnd;
+			*windowUs = ticks_to_microsecs(diff_ticks(lastOldTicks, readEnd));
+			return RTCCLOCK_ERR_OK;
+		}
+
+		if (readEnd > deadline)
+			return RTCCLOCK_ETIMEOUT;
+		lastOldTicks = readStart;
+	}
+}
+
+static void __RTCCLOCK_Anchor(u32 rtc, u64 ticks, u32 windowUs)
+{
+	__rtcclock_anchor_rtc = rtc;
+	__rtcclock_anchor_ticks = ticks;
+	__rtcclock_anchor_window = windowUs;
+	__rtcclock_checked_ticks = ticks;
+	__rtcclock_inited = 1;
+}
+
+s32 RTCCLOCK_Resync(void)
+{
+	u32 rtc, windowUs;
+	u64 edgeTicks;
+	s32 ret;
+
+	// Nothing says where in its second the RTC is, so this can take a whole one; reading it every
+	// millisecond instead of back to back finds the tick to about that, with a fortieth of the reads
+	ret = __RTCCLOCK_PollTick(millisecs_to_ticks(RTCCLOCK_POLL_INTERVAL_MS), &rtc, &edgeTicks, &windowUs);
+	if (ret < 0)
+		return ret;
+
+	__RTCCLOCK_Anchor(rtc, edgeTicks, windowUs);
+	return RTCCLOCK_ERR_OK;
+}
+
+s32 RTCCLOCK_Init(void)
+{
+	if (__rtcclock_inited)
+		return RTCCLOCK_ERR_OK;
+
+	return RTCCLOCK_Resync();
+}
+
+static void __RTCCLOCK_Predict(u64 now, u32 *rtc, u32 *msec)
+{
+	u64 elapsedMs = ticks_to_millisecs(diff_ticks(__rtcclock_anchor_ticks, now));
+
+	*rtc = __rtcclock_anchor_rtc + (u32)(elapsedMs / 1000);
+	if (msec)
+		*msec = elapsedMs % 1000;
+}
+
+s32 RTCCLOCK_Now(u32 *rtc, u32 *msec)
+{
+	u64 now;
+	u32 predicted, actual;
+	s32 ret;
+
+	if (!__rtcclock_inited)
+		return RTCCLOCK_ENOTINIT;
+
+	now = gettime();
+
+	if (diff_ticks(__rtcclock_anchor_ticks, now) >= secs_to_ticks(RTCCLOCK_RESYNC_INTERVAL_SECS))
+	{
+		ret = RTCCLOCK_Resync();
+		if (ret < 0)
+			return ret;
+		now = gettime();
+	}
+	else if (diff_ticks(__rtcclock_checked_ticks, now) >= secs_to_ticks(RTCCLOCK_CHECK_INTERVAL_SECS))
+	{
+		ret = __RTCCLOCK_Read(&actual);
+		if (ret < 0)
+			return ret;
+		__RTCCLOCK_Predict(now, &predicted, NULL);
+
+		// Being one off is just a read that straddled a tick; anything more and the anchor can't be trusted
+		if (actual > predicted + 1 || actual + 1 < predicted)
+		{
+			ret = RTCCLOCK_Resync();
+			if (ret < 0)
+				return ret;
+			now = gettime();
+		}
+		__rtcclock_checked_ticks = now;
+	}
+
+	__RTCCLOCK_Predict(now, rtc, msec);
+	return RTCCLOCK_ERR_OK;
+}
+
+s32 RTCCLOCK_TickEdge(u32 rtc, u64 *edgeTicks, u32 *windowUs)
+{
+	if (!__rtcclock_inited)
+		return RTCCLOCK_ENOTINIT;
+
+	// Whole seconds on from the anchored tick, the same count RTCCLOCK_Now predicts from
+	*edgeTicks = __rtcclock_anchor_ticks + (s64)(s32)(rtc - __rtcclock_anchor_rtc) * (s64)secs_to_ticks(1);
+	*windowUs = __rtcclock_anchor_window;
+	return RTCCLOCK_ERR_OK;
+}
+
+u32 RTCCLOCK_GetReadCount(void)
+{
+	return __rtcclock_reads;
+}
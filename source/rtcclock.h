@@ -0,0 +1,32 @@
+#ifndef __RTCCLOCK_H__
+#define __RTCCLOCK_H__
+
+#include <gctypes.h>
+
+#define RTCCLOCK_ERTC -0x6101
+#define RTCCLOCK_ENOTINIT -0x6102
+#define RTCCLOCK_ETIMEOUT -0x6103
+#define RTCCLOCK_ERR_OK 0
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif /* __cplusplus */
+
+	/* Reads the RTC over EXI once a millisecond until it ticks, and anchors that tick to the CPU timebase */
+	s32 RTCCLOCK_Init(void);
+	/* Current RTC seconds and milliseconds into that second, served from the timebase */
+	s32 RTCCLOCK_Now(u32 *rtc, u32 *msec);
+	/* Throws away the anchor and takes a new one, blocking for up to a second */
+	s32 RTCCLOCK_Resync(void);
+	/* Where the tick that began RTC second rtc fell, from the anchor, without touching the RTC.
+	   edgeTicks is the timebase when it was seen, windowUs how far before that it could have happened */
+	s32 RTCCLOCK_TickEdge(u32 rtc, u64 *edgeTicks, u32 *windowUs);
+	/* Number of __SYS_GetRTC calls made so far, for checking the per-frame cost really is zero */
+	u32 RTCCLOCK_GetReadCount(void);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif
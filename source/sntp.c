@@ -0,0 +1,226 @@
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include <network.h>
+#include <ogc/lwp_watchdog.h>
+
+#include "sntp.h"
+
+#define SNTP_PORT 123
+#define SNTP_PACKET_SIZE 48
+#define SNTP_TIMEOUT_MS 1000
+// Seconds from 1900-01-01, where NTP counts from, to the Unix epoch
+#define SNTP_NTP_TO_UNIX 2208988800ull
+
+typedef struct _sntp_sample
+{
+	s64 offsetUs;
+	s64 delayUs;
+} sntp_sample;
+
+static BOOL __sntp_inited = FALSE;
+
+s32 SNTP_Init(void)
+{
+	s32 ret;
+
+	if (__sntp_inited)
+		return SNTP_ERR_OK;
+
+	// libogc hands back -EAGAIN until IOS has the interface up
+	while ((ret = net_init()) == -EAGAIN)
+		;
+	if (ret < 0)
+		return SNTP_ENET;
+
+	__sntp_inited = TRUE;
+	return SNTP_ERR_OK;
+}
+
+static u32 __SNTP_Get32(const u8 *p)
+{
+	return ((u32)p[0] << 24) | ((u32)p[1] << 16) | ((u32)p[2] << 8) | p[3];
+}
+
+static void __SNTP_Put32(u8 *p, u32 value)
+{
+	p[0] = value >> 24;
+	p[1] = value >> 16;
+	p[2] = value >> 8;
+	p[3] = value;
+}
+
+// An NTP timestamp as Unix microseconds. Era 0 ends in 2036, past anything the console takes
+static s64 __SNTP_ToUnixUs(const u8 *p)
+{
+	u64 secs = __SNTP_Get32(p);
+	u64 frac = __SNTP_Get32(p + 4);
+
+	return (s64)(secs - SNTP_NTP_TO_UNIX) * 1000000 + (s64)((frac * 1000000) >> 32);
+}
+
+static s32 __SNTP_Resolve(const char *server, struct sockaddr_in *addr)
+{
+	char host[64];
+	const char *colon = strchr(server, ':');
+	size_t length = colon ? (size_t)(colon - server) : strlen(server);
+	struct hostent *entry;
+
+	if (!length || length >= sizeof(host))
+		return SNTP_ERESOLVE;
+	memcpy(host, server, length);
+	host[length] = '\0';
+
+	memset(addr, 0, sizeof(*addr));
+	addr->sin_len = sizeof(*addr);
+	addr->sin_family = AF_INET;
+	addr->sin_port = htons(colon ? atoi(colon + 1) : SNTP_PORT);
+
+	if (inet_aton(host, &addr->sin_addr))
+		return SNTP_ERR_OK;
+
+	entry = net_gethostbyname(host);
+	if (!entry || entry->h_addrtype != AF_INET || !entry->h_addr_list || !entry->h_addr_list[0])
+		return SNTP_ERESOLVE;
+	memcpy(&addr->sin_addr, entry->h_addr_list[0], sizeof(addr->sin_addr));
+	return SNTP_ERR_OK;
+}
+
+// One request and its reply. The transmit timestamp sent is just the timebase, which the server
+// echoes back as the originate timestamp; that is enough to tell a late reply from the current one
+static s32 __SNTP_Sample(s32 sock, struct sockaddr_in *addr, sntp_sample *sample, u32 *stratum)
+{
+	u8 packet[SNTP_PACKET_SIZE];
+	struct pollsd sd;
+	u64 sent, received, deadline;
+	s64 t1, t2, t3, t4;
+	s32 ret;
+
+	memset(packet, 0, sizeof(packet));
+	packet[0] = (4 << 3) | 3; // Version 4, client
+
+	sent = gettime();
+	__SNTP_Put32(&packet[40], sent >> 32);
+	__SNTP_Put32(&packet[44], (u32)sent);
+	if (net_sendto(sock, packet, sizeof(packet), 0, (struct sockaddr *)addr, sizeof(*addr)) != sizeof(packet))
+		return SNTP_ESOCKET;
+	deadline = sent + millisecs_to_ticks(SNTP_TIMEOUT_MS);
+
+	while (1)
+	{
+		u64 now = gettime();
+
+		if (now >= deadline)
+			return SNTP_ETIMEOUT;
+
+		sd.socket = sock;
+		sd.events = POLLIN;
+		sd.revents = 0;
+		ret = net_poll(&sd, 1, ticks_to_millisecs(deadline - now) + 1);
+		if (ret < 0)
+			return SNTP_ESOCKET;
+		if (ret == 0 || !(sd.revents & POLLIN))
+			continue;
+
+		ret = net_recvfrom(sock, packet, sizeof(packet), 0, NULL, NULL);
+		received = gettime();
+		if (ret < 0)
+			return SNTP_ESOCKET;
+
+		// Anything that isn't the answer to this request is dropped and the wait goes on
+		if (ret < SNTP_PACKET_SIZE || (packet[0] & 7) != 4 || __SNTP_Get32(&packet[24]) != (u32)(sent >> 32) ||
+			__SNTP_Get32(&packet[28]) != (u32)sent)
+			continue;
+		break;
+	}
+
+	// Leap indicator 3 is an unsynchronised server, stratum 0 a kiss-o'-death
+	if ((packet[0] >> 6) == 3 || packet[1] == 0 || packet[1] > 15)
+		return SNTP_EBADREPLY;
+
+	t1 = ticks_to_microsecs(sent);
+	t2 = __SNTP_ToUnixUs(&packet[32]);
+	t3 = __SNTP_ToUnixUs(&packet[40]);
+	t4 = ticks_to_microsecs(received);
+	if (t3 < t2)
+		return SNTP_EBADREPLY;
+
+	sample->offsetUs = ((t2 - t1) + (t3 - t4)) / 2;
+	sample->delayUs = (t4 - t1) - (t3 - t2);
+	*stratum = packet[1];
+	return SNTP_ERR_OK;
+}
+
+static int __SNTP_ByDelay(const void *a, const void *b)
+{
+	const sntp_sample *x = a, *y = b;
+
+	return (x->delayUs > y->delayUs) - (x->delayUs < y->delayUs);
+}
+
+s32 SNTP_Query(const char *server, sntp_result *result)
+{
+	struct sockaddr_in addr;
+	sntp_sample samples[SNTP_SAMPLES];
+	s64 sum = 0, lowest, highest;
+	u64 start = gettime();
+	s32 sock, ret, lastError = SNTP_ETIMEOUT;
+	u32 i, stratum = 0;
+
+	memset(result, 0, sizeof(*result));
+
+	if (!__sntp_inited)
+		return SNTP_ENET;
+
+	ret = __SNTP_Resolve(server, &addr);
+	if (ret < 0)
+		return ret;
+
+	sock = net_socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+	if (sock < 0)
+		return SNTP_ESOCKET;
+
+	for (i = 0; i < SNTP_SAMPLES; i++)
+	{
+		result->sent++;
+		ret = __SNTP_Sample(sock, &addr, &samples[result->received], &stratum);
+		if (ret < 0)
+		{
+			// A lost packet or an odd reply is what the extra samples are for
+			lastError = ret;
+			if (ret == SNTP_ESOCKET)
+				break;
+			continue;
+		}
+		if (samples[result->received].delayUs < 0)
+			continue;
+		result->stratum = stratum;
+		result->received++;
+	}
+	net_close(sock);
+
+	if (!result->received)
+	{
+		result->elapsedMs = ticks_to_millisecs(diff_ticks(start, gettime()));
+		return lastError;
+	}
+
+	qsort(samples, result->received, sizeof(samples[0]), __SNTP_ByDelay);
+	result->kept = result->received < SNTP_KEEP ? result->received : SNTP_KEEP;
+
+	lowest = highest = samples[0].offsetUs;
+	for (i = 0; i < result->kept; i++)
+	{
+		sum += samples[i].offsetUs;
+		if (samples[i].offsetUs < lowest)
+			lowest = samples[i].offsetUs;
+		if (samples[i].offsetUs > highest)
+			highest = samples[i].offsetUs;
+	}
+
+	result->offsetUs = sum / (s64)result->kept;
+	result->delayUs = samples[0].delayUs;
+	result->spreadUs = highest - lowest;
+	result->elapsedMs = ticks_to_millisecs(diff_ticks(start, gettime()));
+	return SNTP_ERR_OK;
+}
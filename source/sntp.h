@@ -0,0 +1,48 @@
+#ifndef __SNTP_H__
+#define __SNTP_H__
+
+#include <gctypes.h>
+
+#define SNTP_ENET -0x6501
+#define SNTP_ERESOLVE -0x6502
+#define SNTP_ESOCKET -0x6503
+#define SNTP_ETIMEOUT -0x6504
+#define SNTP_EBADREPLY -0x6505
+#define SNTP_ERR_OK 0
+
+#define SNTP_SAMPLES 8 /* Requests sent per query */
+#define SNTP_KEEP 3    /* Lowest-delay replies the offset is averaged over */
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif /* __cplusplus */
+
+	/*
+	 * An SNTP (RFC 4330) client. A query sends a handful of requests one after another and keeps
+	 * only the replies that took the shortest round trip: a slow reply was most likely held up on
+	 * one leg more than the other, which is exactly what skews its offset.
+	 */
+
+	typedef struct _sntp_result
+	{
+		s64 offsetUs; /* Unix time in microseconds, less the timebase in microseconds */
+		u32 delayUs;  /* Round trip of the fastest reply, less the server's own time */
+		u32 spreadUs; /* How far the kept offsets are apart, a rough error bound */
+		u32 sent;
+		u32 received;
+		u32 kept;
+		u32 stratum;
+		u32 elapsedMs; /* The whole query, name lookup included */
+	} sntp_result;
+
+	/* Brings up the network, which on the console can take a few seconds */
+	s32 SNTP_Init(void);
+	/* Queries server, a name or dotted address with an optional ":port" */
+	s32 SNTP_Query(const char *server, sntp_result *result);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif
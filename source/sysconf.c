@@ -36,6 +36,10 @@ distribution.
 #include <ogc/ipc.h>
 #include <ogc/isfs.h>
 #include <ogc/es.h>
+#include <ogc/mutex.h>
+#include <ogc/cond.h>
+#include <ogc/lwp.h>
+#include <ogc/machine/processor.h>
 
 #include "sysconf.h"
 
@@ -45,51 +49,304 @@ distribution.
 #include "wiibasics.h"
 #endif
 
-static int __sysconf_inited = 0;
-static int __sysconf_buffer_txt_decrypted = 0;
-static u8 __sysconf_buffer[0x4000] ATTRIBUTE_ALIGN(32);
-static char __sysconf_txt_buffer[0x101] ATTRIBUTE_ALIGN(32);
-static int __sysconf_buffer_updated = 0;
-static int __sysconf_txt_buffer_updated = 0;
+/* Host tools that run one instance per worker thread build with SYSCONF_PER_THREAD */
+#ifdef SYSCONF_PER_THREAD
+#define SYSCONF_STATE static __thread
+#else
+#define SYSCONF_STATE static
+#endif
+
+SYSCONF_STATE int __sysconf_inited = 0;
+SYSCONF_STATE u8 __sysconf_buffer[0x4000] ATTRIBUTE_ALIGN(32);
+/* setting.txt is kept decrypted; it is only encrypted into the scratch buffer on its way out */
+SYSCONF_STATE char __sysconf_txt_buffer[0x101] ATTRIBUTE_ALIGN(32);
+SYSCONF_STATE char __sysconf_txt_scratch[0x100] ATTRIBUTE_ALIGN(32);
+SYSCONF_STATE int __sysconf_buffer_updated = 0;
+SYSCONF_STATE int __sysconf_txt_buffer_updated = 0;
+/* Byte range of __sysconf_buffer that differs from the file, so a save only writes what changed */
+SYSCONF_STATE u32 __sysconf_dirty_start = 0x4000;
+SYSCONF_STATE u32 __sysconf_dirty_end = 0;
+/* Counts changes; a background save that covered all of them leaves the buffers clean, see __SYSCONF_DropSaved */
+SYSCONF_STATE u32 __sysconf_changes = 0;
+SYSCONF_STATE u32 __sysconf_saved_changes = 0;
+
+/*
+ * What the files on NAND should hold, as an FNV-1a hash of each 512-byte block of SYSCONF and of
+ * setting.txt. Taken at init and updated by every write, so a write can tell from the blocks it is
+ * about to touch whether someone else changed them, and a verify can tell whether they came out right.
+ */
+#define SYSCONF_BLOCK 0x200
+SYSCONF_STATE u32 __sysconf_block_hash[0x4000 / SYSCONF_BLOCK];
+SYSCONF_STATE u32 __sysconf_txt_hash;
+/* Blocks written since the last verify, one bit each, and whether setting.txt was */
+SYSCONF_STATE u32 __sysconf_unverified = 0;
+SYSCONF_STATE int __sysconf_txt_unverified = 0;
+SYSCONF_STATE u8 __sysconf_readback[SYSCONF_BLOCK] ATTRIBUTE_ALIGN(32);
+
+/*
+ * After SYSCONF_InitPartial only these byte ranges of the buffer hold the file: the header and offset
+ * table first, then each entry loaded. Each is hashed on its own in place of the blocks, and
+ * __sysconf_unverified has a bit per range instead of per block.
+ */
+typedef struct _sysconf_range
+{
+	u16 start;
+	u16 end;
+	u32 hash;
+} sysconf_range;
+
+SYSCONF_STATE int __sysconf_partial = 0;
+SYSCONF_STATE sysconf_range __sysconf_ranges[SYSCONF_PARTIAL_MAX + 1];
+SYSCONF_STATE u32 __sysconf_range_count = 0;
+
+/*
+ * Readers never lock. Writers serialise on __sysconf_mutex and hold __sysconf_seq odd while the
+ * buffers change; a reader retries if it moved underneath it, and waits on the mutex if it is odd.
+ */
+SYSCONF_STATE mutex_t __sysconf_mutex = LWP_MUTEX_NULL;
+SYSCONF_STATE u32 __sysconf_seq = 0;
+/* Which thread holds the mutex and how many times, so a thread that is mid-write can still read */
+SYSCONF_STATE lwp_t __sysconf_owner = LWP_THREAD_NULL;
+SYSCONF_STATE u32 __sysconf_lock_depth = 0;
 
 static const char __sysconf_file[] ATTRIBUTE_ALIGN(32) = "/shared2/sys/SYSCONF";
 // static const char __sysconf_txt_file[] ATTRIBUTE_ALIGN(32) = "/title/00000001/00000002/data/setting.txt";
 static const char __sysconf_txt_file[] ATTRIBUTE_ALIGN(32) = "/title/00000001/00000002/data/setting.txt";
 
-int __SYSCONF_EndOfTextOffset(void)
+/*
+ * SYSCONF is big-endian and its fields sit at any byte offset. These compile to
+ * plain loads and stores on the PowerPC and to a byte swap on little-endian hosts.
+ */
+static inline u16 __SYSCONF_Load16(const u8 *p)
+{
+	u16 v;
+	memcpy(&v, p, sizeof(v));
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+	v = __builtin_bswap16(v);
+#endif
+	return v;
+}
+
+static inline u32 __SYSCONF_Load32(const u8 *p)
+{
+	u32 v;
+	memcpy(&v, p, sizeof(v));
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+	v = __builtin_bswap32(v);
+#endif
+	return v;
+}
+
+static inline void __SYSCONF_Store16(u8 *p, u16 v)
+{
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+	v = __builtin_bswap16(v);
+#endif
+	memcpy(p, &v, sizeof(v));
+}
+
+static inline void __SYSCONF_Store32(u8 *p, u32 v)
+{
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+	v = __builtin_bswap32(v);
+#endif
+	memcpy(p, &v, sizeof(v));
+}
+
+/* Header fields: entry count at 4, then the offset table at 6 */
+static inline u16 __SYSCONF_Count(void)
+{
+	return __SYSCONF_Load16(&__sysconf_buffer[4]);
+}
+
+static inline u16 __SYSCONF_Offset(int index)
+{
+	return __SYSCONF_Load16(&__sysconf_buffer[6 + index * 2]);
+}
+
+static inline void __SYSCONF_SetOffset(int index, u16 offset)
+{
+	__SYSCONF_Store16(&__sysconf_buffer[6 + index * 2], offset);
+}
+
+static void __SYSCONF_Lock(void)
+{
+	if (__sysconf_mutex != LWP_MUTEX_NULL)
+		LWP_MutexLock(__sysconf_mutex);
+	if (__sysconf_lock_depth++ == 0)
+		__atomic_store_n(&__sysconf_owner, LWP_GetSelf(), __ATOMIC_RELAXED);
+}
+
+static void __SYSCONF_Unlock(void)
+{
+	if (--__sysconf_lock_depth == 0)
+		__atomic_store_n(&__sysconf_owner, LWP_THREAD_NULL, __ATOMIC_RELAXED);
+	if (__sysconf_mutex != LWP_MUTEX_NULL)
+		LWP_MutexUnlock(__sysconf_mutex);
+}
+
+/* Only called with the mutex held */
+static inline void __SYSCONF_BeginWrite(void)
+{
+	__atomic_store_n(&__sysconf_seq, __sysconf_seq + 1, __ATOMIC_RELAXED);
+	__atomic_thread_fence(__ATOMIC_RELEASE);
+}
+
+static inline void __SYSCONF_EndWrite(void)
+{
+	__atomic_store_n(&__sysconf_seq, __sysconf_seq + 1, __ATOMIC_RELEASE);
+}
+
+static inline u32 __SYSCONF_ReadBegin(void)
+{
+	u32 seq;
+
+	while ((seq = __atomic_load_n(&__sysconf_seq, __ATOMIC_ACQUIRE)) & 1)
+	{
+		/* The writer may be this thread, with a write view open; it reads its own changes as they stand.
+		   Only the owner ever stores its own id, so no other thread can match it here */
+		if (__atomic_load_n(&__sysconf_owner, __ATOMIC_RELAXED) == LWP_GetSelf())
+			break;
+		/* Otherwise a writer is mid-change and holds the mutex; sleep on it rather than spin */
+		__SYSCONF_Lock();
+		__SYSCONF_Unlock();
+	}
+	return seq;
+}
+
+static inline int __SYSCONF_ReadRetry(u32 seq)
+{
+	__atomic_thread_fence(__ATOMIC_ACQUIRE);
+	return __atomic_load_n(&__sysconf_seq, __ATOMIC_RELAXED) != seq;
+}
+
+static s32 __SYSCONF_CreateMutex(void)
+{
+	if (__sysconf_mutex != LWP_MUTEX_NULL)
+		return 0;
+	return LWP_MutexInit(&__sysconf_mutex, true);
+}
+
+/* The buffers stay marked dirty until a save of them completes; once the background saver has
+   written everything up to the latest change, nothing is left to write */
+void __SYSCONF_DropSaved(void)
+{
+	if (__atomic_load_n(&__sysconf_saved_changes, __ATOMIC_ACQUIRE) != __sysconf_changes)
+		return;
+
+	__sysconf_buffer_updated = 0;
+	__sysconf_txt_buffer_updated = 0;
+	__sysconf_dirty_start = 0x4000;
+	__sysconf_dirty_end = 0;
+}
+
+void __SYSCONF_MarkDirty(u32 start, u32 end)
+{
+	__SYSCONF_DropSaved();
+	__sysconf_changes++;
+
+	/* Keep writes on cache line boundaries, the same as the buffer itself */
+	start &= ~31;
+	end = (end + 31) & ~31;
+
+	if (start < __sysconf_dirty_start)
+		__sysconf_dirty_start = start;
+	if (end > __sysconf_dirty_end)
+		__sysconf_dirty_end = end;
+	__sysconf_buffer_updated = 1;
+}
+
+void __SYSCONF_MarkTxtDirty(void)
+{
+	__SYSCONF_DropSaved();
+	__sysconf_changes++;
+	__sysconf_txt_buffer_updated = 1;
+}
+
+int __SYSCONF_EndOfTextOffset(const char *txt)
 {
 	int i;
 	int offset = 0;
 
 	for (i = 0; i < 0x100; i++)
-		if (!memcmp(__sysconf_txt_buffer + i, "\r\n", 2))
+		if (!memcmp(txt + i, "\r\n", 2))
 			offset = i;
 
 	offset += 2;
 	return offset;
 }
 
-void __SYSCONF_DecryptEncryptTextBuffer(void)
+void __SYSCONF_CryptText(const char *in, char *out)
 {
 	u32 key = 0x73B5DBFA;
 	int i;
-	char *end = (char *)__sysconf_txt_buffer;
-
-	if (__sysconf_buffer_txt_decrypted)
-		end += __SYSCONF_EndOfTextOffset();
 
 	for (i = 0; i < 0x100; i++)
 	{
-		__sysconf_txt_buffer[i] ^= key & 0xff;
+		out[i] = in[i] ^ (key & 0xff);
 		key = (key << 1) | (key >> 31);
 	}
+}
+
+/* Both directions zero whatever follows the last line, in the plaintext and in the file alike */
+void __SYSCONF_DecryptTxt(const char *in)
+{
+	int end;
+
+	__SYSCONF_CryptText(in, __sysconf_txt_buffer);
+	end = __SYSCONF_EndOfTextOffset(__sysconf_txt_buffer);
+	memset(__sysconf_txt_buffer + end, 0, 0x101 - end);
+}
+
+void __SYSCONF_EncryptTxt(char *out)
+{
+	int end = __SYSCONF_EndOfTextOffset(__sysconf_txt_buffer);
+
+	__SYSCONF_CryptText(__sysconf_txt_buffer, out);
+	if (end < 0x100)
+		memset(out + end, 0, 0x100 - end);
+}
+
+/* FNV-1a, carried on from hash so one can run over several pieces */
+u32 __SYSCONF_HashMore(u32 hash, const void *data, u32 length)
+{
+	const u8 *p = data;
 
-	__sysconf_buffer_txt_decrypted = !__sysconf_buffer_txt_decrypted;
+	while (length--)
+		hash = (hash ^ *p++) * 0x01000193;
+	return hash;
+}
+
+u32 __SYSCONF_Hash(const void *data, u32 length)
+{
+	return __SYSCONF_HashMore(0x811C9DC5, data, length);
+}
+
+/* Takes the hashes of both files as they were read */
+void __SYSCONF_HashFiles(const u8 *sysconf, const char *txt)
+{
+	int i;
+
+	for (i = 0; i < 0x4000 / SYSCONF_BLOCK; i++)
+		__sysconf_block_hash[i] = __SYSCONF_Hash(&sysconf[i * SYSCONF_BLOCK], SYSCONF_BLOCK);
+	__sysconf_txt_hash = __SYSCONF_Hash(txt, 0x100);
+	__sysconf_unverified = 0;
+	__sysconf_txt_unverified = 0;
+}
+
+/* Reads one block of an open SYSCONF into __sysconf_readback */
+int __SYSCONF_ReadBlock(int fd, u32 block)
+{
+	int ret;
 
-	if (__sysconf_buffer_txt_decrypted)
-		end += __SYSCONF_EndOfTextOffset();
+	ret = IOS_Seek(fd, block * SYSCONF_BLOCK, 0);
+	if (ret != block * SYSCONF_BLOCK)
+		return SYSCONF_EBADFILE;
 
-	memset(end, 0, (__sysconf_txt_buffer + 0x100) - end);
+	ret = IOS_Read(fd, __sysconf_readback, SYSCONF_BLOCK);
+	if (ret != SYSCONF_BLOCK)
+		return ret < 0 ? ret : SYSCONF_EBADFILE;
+	return 0;
 }
 
 #ifdef DEBUG_SYSCONF
@@ -110,224 +367,1524 @@ void SYSCONF_DumpTxtBuffer(void)
 
 void SYSCONF_DumpEncryptedTxtBuffer(void)
 {
+	char txt[0x100];
 	if (!__sysconf_inited)
 		return;
-	int was = __sysconf_buffer_txt_decrypted;
-	if (__sysconf_buffer_txt_decrypted)
-		__SYSCONF_DecryptEncryptTextBuffer();
-	hex_print_array16((u8 *)__sysconf_txt_buffer, 0x101);
-	if (was)
-		__SYSCONF_DecryptEncryptTextBuffer();
+	__SYSCONF_EncryptTxt(txt);
+	hex_print_array16((u8 *)txt, 0x100);
 }
 
 void SYSCONF_PrintAllSettings(void)
 {
-	if (!__sysconf_inited)
-		return;
-	u16 i, count;
-	u16 *offset;
-	char temp[33], typestring[20];
-	u8 nlen;
-	offset = (u16 *)&__sysconf_buffer[6];
-	count = *((u16 *)(&__sysconf_buffer[4]));
-	printf("Total: %u settings.\n", count);
-	for (i = 0; i < count; i++)
-	{
-		nlen = (__sysconf_buffer[*offset] & 0x0F) + 1;
-		memcpy(temp, &__sysconf_buffer[(*offset) + 1], nlen);
-		temp[nlen] = 0;
-		switch (__sysconf_buffer[*offset] >> 5)
-		{
-		case 1:
-			sprintf(typestring, "BIGARRAY[0x%X]", *((u16 *)&__sysconf_buffer[(*offset) + nlen + 1]) + 1);
-			break;
-		case 2:
-			sprintf(typestring, "SMALLARRAY[0x%X]", __sysconf_buffer[(*offset) + nlen + 1] + 1);
-			break;
-		case 3:
-			strcpy(typestring, "BYTE");
-			break;
-		case 4:
-			strcpy(typestring, "SHORT");
-			break;
-		case 5:
-			strcpy(typestring, "LONG");
-			break;
-		case 7:
-			strcpy(typestring, "BOOL");
-			break;
-		default:
-			sprintf(typestring, "Unknown %u", __sysconf_buffer[*offset] >> 5);
-		}
-		printf("%3u. 0x%04X: %-10s Type: %s\n", i + 1, *offset, temp, typestring);
-		offset++;
-	}
+	SYSCONF_DumpSettings(stdout);
 }
 #endif /* DEBUG_SYSCONF */
 
-s32 SYSCONF_Init(void)
+static const char *const __sysconf_type_names[8] = {NULL, "BIGARRAY", "SMALLARRAY", "BYTE", "SHORT", "LONG", NULL, "BOOL"};
+
+/* One step along the offset table of iter->image. The entry points into it, so when that is the live buffer
+   the caller holds the writer lock */
+int __SYSCONF_IterNext(sysconf_iter *iter, sysconf_entry *entry)
 {
-	int fd;
-	int ret;
+	const u8 *image = iter->image;
+	u32 offset, data, length;
+	u8 type;
 
-	if (__sysconf_inited)
+	if (iter->index >= iter->count)
 		return 0;
-
-	fd = IOS_Open(__sysconf_file, 1);
-	if (fd < 0)
-		return fd;
-
-	memset(__sysconf_buffer, 0, 0x4000);
-	memset(__sysconf_txt_buffer, 0, 0x101);
-
-	ret = IOS_Read(fd, __sysconf_buffer, 0x4000);
-	IOS_Close(fd);
-	if (ret != 0x4000)
+	if (6 + iter->index * 2 + 2 > 0x4000)
 		return SYSCONF_EBADFILE;
 
-	fd = IOS_Open(__sysconf_txt_file, 1);
-	if (fd < 0)
-		return fd;
-
-	ret = IOS_Read(fd, __sysconf_txt_buffer, 0x100);
-	IOS_Close(fd);
-	if (ret != 0x100)
+	offset = __SYSCONF_Load16(&image[6 + iter->index * 2]);
+	if (offset + 1 > 0x4000)
 		return SYSCONF_EBADFILE;
 
-	if (memcmp(__sysconf_buffer, "SCv0", 4))
-		return SYSCONF_EBADFILE;
+	type = image[offset] >> 5;
+	data = offset + 1 + (image[offset] & 0x0F) + 1;
 
-	__SYSCONF_DecryptEncryptTextBuffer();
+	/* Only the arrays have a length to read ahead of the payload */
+	switch (type)
+	{
+	case SYSCONF_BIGARRAY:
+		if (data + 2 > 0x4000)
+			return SYSCONF_EBADFILE;
+		length = __SYSCONF_Load16(&image[data]) + 1;
+		data += 2;
+		break;
+	case SYSCONF_SMALLARRAY:
+		if (data + 1 > 0x4000)
+			return SYSCONF_EBADFILE;
+		length = image[data] + 1;
+		data++;
+		break;
+	case SYSCONF_BYTE:
+	case SYSCONF_BOOL:
+		length = 1;
+		break;
+	case SYSCONF_SHORT:
+		length = 2;
+		break;
+	case SYSCONF_LONG:
+		length = 4;
+		break;
+	default:
+		length = 0;
+	}
+	if (data + length > 0x4000)
+		return SYSCONF_EBADFILE;
 
-	__sysconf_inited = 1;
-	return 0;
+	entry->name = (const char *)&image[offset + 1];
+	entry->name_length = (image[offset] & 0x0F) + 1;
+	entry->type = type;
+	entry->data = &image[data];
+	entry->length = length;
+	entry->offset = offset;
+	iter->index++;
+	return 1;
 }
 
-int __SYSCONF_WriteTxtBuffer(void)
+/* The public walk is over a copy, taken like any other read, so nothing is locked while the caller works */
+s32 SYSCONF_IterBegin(sysconf_iter *iter)
 {
-	u64 tid;
-	int ret, fd;
+	u8 *image;
+	u32 seq;
 
 	if (!__sysconf_inited)
 		return SYSCONF_ENOTINIT;
+	if (__sysconf_partial)
+		return SYSCONF_EPARTIAL;
 
-	if (!__sysconf_txt_buffer_updated)
-		return 0;
-
-	ret = ES_GetTitleID(&tid);
-	if (ret < 0)
-		return ret;
+	image = malloc(0x4000);
+	if (!image)
+		return SYSCONF_ENOMEM;
+	do
+	{
+		seq = __SYSCONF_ReadBegin();
+		memcpy(image, __sysconf_buffer, 0x4000);
+	} while (__SYSCONF_ReadRetry(seq));
 
-	if (tid != 0x100000002LL)
-		return SYSCONF_EPERMS;
+	iter->image = image;
+	iter->index = 0;
+	iter->count = __SYSCONF_Load16(&image[4]);
+	return SYSCONF_ERR_OK;
+}
 
-	if (__sysconf_buffer_txt_decrypted)
-		__SYSCONF_DecryptEncryptTextBuffer();
+s32 SYSCONF_IterNext(sysconf_iter *iter, sysconf_entry *entry)
+{
+	return __SYSCONF_IterNext(iter, entry);
+}
 
-	ret = ISFS_SetAttr(__sysconf_txt_file, 0x1000, 1, 0, 3, 3, 3);
-	if (ret < 0)
-		return ret;
+void SYSCONF_IterEnd(sysconf_iter *iter)
+{
+	free((void *)iter->image);
+	iter->image = NULL;
+}
 
-	fd = IOS_Open(__sysconf_txt_file, 2);
-	if (fd < 0)
-		return fd;
+void __SYSCONF_DumpSettings(FILE *fp)
+{
+	sysconf_iter iter;
+	sysconf_entry entry;
+	const char *name;
+	int j, width;
 
-	ret = IOS_Write(fd, __sysconf_txt_buffer, 0x100);
-	IOS_Close(fd);
-	if (ret != 0x100)
-		return SYSCONF_EBADWRITE;
+	if (!__sysconf_inited || __sysconf_partial)
+		return;
 
-	ret = ISFS_SetAttr(__sysconf_txt_file, 0x1000, 1, 0, 1, 1, 1);
-	if (ret < 0)
-		return ret;
+	iter.image = __sysconf_buffer;
+	iter.index = 0;
+	iter.count = __SYSCONF_Count();
+	fprintf(fp, "Total: %u settings.\n", iter.count);
+	while (__SYSCONF_IterNext(&iter, &entry) > 0)
+	{
+		fprintf(fp, "%3u. 0x%04X: %-10.*s Type: ", iter.index, entry.offset, entry.name_length, entry.name);
 
-	__sysconf_buffer_updated = 0;
+		name = __sysconf_type_names[entry.type];
+		if (!name)
+			width = fprintf(fp, "Unknown %u", entry.type);
+		else if (entry.type == SYSCONF_BIGARRAY || entry.type == SYSCONF_SMALLARRAY)
+			width = fprintf(fp, "%s[0x%X]", name, entry.length);
+		else
+			width = fprintf(fp, "%s", name);
+		if (width < 18)
+			fprintf(fp, "%*s", 18 - width, "");
+
+		/* Numbers print as numbers, arrays as their first bytes in hex */
+		if (entry.type == SYSCONF_SHORT)
+			fprintf(fp, " %u", __SYSCONF_Load16(entry.data));
+		else if (entry.type == SYSCONF_LONG)
+			fprintf(fp, " %u", __SYSCONF_Load32(entry.data));
+		else if (entry.type == SYSCONF_BYTE || entry.type == SYSCONF_BOOL)
+			fprintf(fp, " %u", *entry.data);
+		else
+		{
+			for (j = 0; j < entry.length && j < 16; j++)
+				fprintf(fp, " %02X", entry.data[j]);
+			if (entry.length > 16)
+				fprintf(fp, " ...");
+		}
+		fprintf(fp, "\n");
+	}
+}
 
-	return 0;
+void SYSCONF_DumpSettings(FILE *fp)
+{
+	__SYSCONF_Lock();
+	__SYSCONF_DumpSettings(fp);
+	__SYSCONF_Unlock();
 }
 
-int __SYSCONF_WriteBuffer(void)
+static void __SYSCONF_JSONString(FILE *fp, const char *str, int length)
 {
-	int ret, fd;
+	int i;
 
-	if (!__sysconf_inited)
-		return SYSCONF_ENOTINIT;
+	fputc('"', fp);
+	for (i = 0; i < length; i++)
+	{
+		if (str[i] == '"' || str[i] == '\\')
+			fprintf(fp, "\\%c", str[i]);
+		else if ((u8)str[i] < 0x20)
+			fprintf(fp, "\\u%04x", (u8)str[i]);
+		else
+			fputc(str[i], fp);
+	}
+	fputc('"', fp);
+}
 
-	if (!__sysconf_buffer_updated)
-		return 0;
+/* {"sysconf":[{"name":"IPL.CB","type":"LONG","value":0},...],"setting.txt":{"AREA":"USA",...}}
+   Numbers are numbers, arrays a hex string, entries of an unknown type null */
+int __SYSCONF_ExportJSON(FILE *fp)
+{
+	sysconf_iter iter;
+	sysconf_entry entry;
+	const char *line, *eq, *end;
+	int ret, j, first = 1;
 
-	fd = IOS_Open(__sysconf_file, 2);
-	if (fd < 0)
-		return fd;
+	iter.image = __sysconf_buffer;
+	iter.index = 0;
+	iter.count = __SYSCONF_Count();
+	fprintf(fp, "{\"sysconf\":[");
+	while ((ret = __SYSCONF_IterNext(&iter, &entry)) > 0)
+	{
+		fprintf(fp, "%s{\"name\":", iter.index > 1 ? "," : "");
+		__SYSCONF_JSONString(fp, entry.name, entry.name_length);
+		if (__sysconf_type_names[entry.type])
+			fprintf(fp, ",\"type\":\"%s\",\"value\":", __sysconf_type_names[entry.type]);
+		else
+			fprintf(fp, ",\"type\":%u,\"value\":", entry.type);
+
+		if (entry.type == SYSCONF_SHORT)
+			fprintf(fp, "%u", __SYSCONF_Load16(entry.data));
+		else if (entry.type == SYSCONF_LONG)
+			fprintf(fp, "%u", __SYSCONF_Load32(entry.data));
+		else if (entry.type == SYSCONF_BYTE || entry.type == SYSCONF_BOOL)
+			fprintf(fp, "%u", *entry.data);
+		else if (entry.length)
+		{
+			fputc('"', fp);
+			for (j = 0; j < entry.length; j++)
+				fprintf(fp, "%02X", entry.data[j]);
+			fputc('"', fp);
+		}
+		else
+			fprintf(fp, "null");
+		fputc('}', fp);
+	}
+	if (ret < 0)
+		return ret;
 
-	ret = IOS_Write(fd, __sysconf_buffer, 0x4000);
-	IOS_Close(fd);
-	if (ret != 0x4000)
-		return SYSCONF_EBADFILE;
+	/* setting.txt is KEY=VALUE lines, each ended by \r\n */
+	fprintf(fp, "],\"setting.txt\":{");
+	for (line = __sysconf_txt_buffer; (end = strstr(line, "\r\n")); line = end + 2)
+	{
+		eq = memchr(line, '=', end - line);
+		if (!eq)
+			continue;
+		if (!first)
+			fputc(',', fp);
+		first = 0;
+		__SYSCONF_JSONString(fp, line, eq - line);
+		fputc(':', fp);
+		__SYSCONF_JSONString(fp, eq + 1, end - eq - 1);
+	}
+	fprintf(fp, "}}");
 
-	__sysconf_buffer_updated = 0;
-	return 0;
+	return ferror(fp) ? SYSCONF_EBADWRITE : iter.count;
 }
 
-s32 SYSCONF_SaveChanges(void)
+s32 SYSCONF_ExportJSON(FILE *fp)
 {
 	s32 ret;
+
 	if (!__sysconf_inited)
 		return SYSCONF_ENOTINIT;
-	ret = __SYSCONF_WriteBuffer();
-	if (ret < 0)
-		return ret;
-
-	ret = __SYSCONF_WriteTxtBuffer();
-	if (ret < 0)
-		return ret;
+	if (__sysconf_partial)
+		return SYSCONF_EPARTIAL;
 
-	return SYSCONF_ERR_OK;
+	__SYSCONF_Lock();
+	ret = __SYSCONF_ExportJSON(fp);
+	__SYSCONF_Unlock();
+	return ret;
 }
 
-int __SYSCONF_ShiftTxt(char *start, s32 delta)
+/* "SCpk", the entry count, every entry exactly as it sits in SYSCONF, then setting.txt's plain text
+   after its length; counts and lengths are big-endian u16s */
+int __SYSCONF_ExportPacked(FILE *fp)
 {
-	char *end;
-	char temp[0x100];
+	sysconf_iter iter;
+	sysconf_entry entry;
+	u8 header[6] = {'S', 'C', 'p', 'k'};
+	u16 txtLength;
+	int ret;
 
-	if (!__sysconf_buffer_txt_decrypted)
-		__SYSCONF_DecryptEncryptTextBuffer();
+	iter.image = __sysconf_buffer;
+	iter.index = 0;
+	iter.count = __SYSCONF_Count();
+	__SYSCONF_Store16(&header[4], iter.count);
+	fwrite(header, 1, sizeof(header), fp);
 
-	end = strchr((char *)__sysconf_txt_buffer, 0);
-	if (end == NULL || end > __sysconf_txt_buffer + 0x100)
-		return SYSCONF_EBADFILE;
+	while ((ret = __SYSCONF_IterNext(&iter, &entry)) > 0)
+		fwrite(&iter.image[entry.offset], 1, entry.data + entry.length - &iter.image[entry.offset], fp);
+	if (ret < 0)
+		return ret;
 
-	if (start < __sysconf_txt_buffer || start >= end)
-		return SYSCONF_EBADVALUE;
+	txtLength = strlen(__sysconf_txt_buffer);
+	__SYSCONF_Store16(header, txtLength);
+	fwrite(header, 1, 2, fp);
+	fwrite(__sysconf_txt_buffer, 1, txtLength, fp);
 
-	memcpy(temp, start, end - start);
-	memcpy(start + delta, temp, end - start);
-	// free (temp);
-	*(end + delta) = 0;
-	return 0;
+	return ferror(fp) ? SYSCONF_EBADWRITE : iter.count;
 }
 
-int __SYSCONF_GetTxt(const char *name, char *buf, int length)
+s32 SYSCONF_ExportPacked(FILE *fp)
 {
-	char *line = __sysconf_txt_buffer;
-	char *delim, *end;
-	int slen;
-	int nlen = strlen(name);
+	s32 ret;
 
 	if (!__sysconf_inited)
 		return SYSCONF_ENOTINIT;
+	if (__sysconf_partial)
+		return SYSCONF_EPARTIAL;
 
-	if (!__sysconf_buffer_txt_decrypted)
-		__SYSCONF_DecryptEncryptTextBuffer();
+	__SYSCONF_Lock();
+	ret = __SYSCONF_ExportPacked(fp);
+	__SYSCONF_Unlock();
+	return ret;
+}
 
-	while (line < (__sysconf_txt_buffer + 0x100))
-	{
-		delim = strchr(line, '=');
-		if (delim && ((delim - line) == nlen) && !memcmp(name, line, nlen))
-		{
+s32 SYSCONF_InitFromMemory(const void *sysconf, const void *txt)
+{
+	s32 ret = 0;
+
+	if (__SYSCONF_CreateMutex() < 0)
+		return SYSCONF_ENOMEM;
+
+	__SYSCONF_Lock();
+	__SYSCONF_BeginWrite();
+	memset(__sysconf_buffer, 0, 0x4000);
+	memset(__sysconf_txt_buffer, 0, 0x101);
+	__sysconf_buffer_updated = 0;
+	__sysconf_txt_buffer_updated = 0;
+	__sysconf_dirty_start = 0x4000;
+	__sysconf_dirty_end = 0;
+	__sysconf_inited = 0;
+	__sysconf_partial = 0;
+
+	if (sysconf)
+	{
+		memcpy(__sysconf_buffer, sysconf, 0x4000);
+		if (memcmp(__sysconf_buffer, "SCv0", 4))
+			ret = SYSCONF_EBADFILE;
+	}
+
+	if (txt && !ret)
+		__SYSCONF_DecryptTxt(txt);
+
+	if (!ret)
+	{
+		__SYSCONF_EncryptTxt(__sysconf_txt_scratch);
+		__SYSCONF_HashFiles(__sysconf_buffer, txt ? txt : __sysconf_txt_scratch);
+	}
+
+	__sysconf_inited = !ret;
+	__SYSCONF_EndWrite();
+	__SYSCONF_Unlock();
+	return ret;
+}
+
+s32 SYSCONF_ExportToMemory(void *sysconf, void *txt)
+{
+	u32 seq;
+
+	do
+	{
+		seq = __SYSCONF_ReadBegin();
+		if (!__sysconf_inited)
+			return SYSCONF_ENOTINIT;
+		if (__sysconf_partial)
+			return SYSCONF_EPARTIAL;
+
+		if (sysconf)
+			memcpy(sysconf, __sysconf_buffer, 0x4000);
+		if (txt)
+			__SYSCONF_EncryptTxt(txt);
+	} while (__SYSCONF_ReadRetry(seq));
+	return 0;
+}
+
+/*
+ * Split init. SYSCONF_InitBegin sends the opens of both files and returns. Each completion sends the
+ * next request straight from the IPC callback, open then read then close, so IOS works through
+ * both files while the caller does other things. SYSCONF_InitFinish sleeps until both are in.
+ */
+enum
+{
+	SYSCONF_LOAD_OPEN,
+	SYSCONF_LOAD_READ,
+	SYSCONF_LOAD_CLOSE,
+	SYSCONF_LOAD_DONE
+};
+
+typedef struct _sysconf_load
+{
+	const char *path;
+	void *buffer;
+	s32 length;
+	s32 fd;
+	s32 result; /* Bytes read, or the first error */
+	int stage;
+} sysconf_load;
+
+SYSCONF_STATE sysconf_load __sysconf_loads[2];
+SYSCONF_STATE volatile int __sysconf_loads_pending = 0;
+SYSCONF_STATE int __sysconf_loading = 0;
+SYSCONF_STATE lwpq_t __sysconf_load_queue = LWP_TQUEUE_NULL;
+
+/* Runs from the IPC interrupt */
+static s32 __SYSCONF_LoadStep(s32 result, void *usrdata)
+{
+	sysconf_load *load = (sysconf_load *)usrdata;
+
+	switch (load->stage)
+	{
+	case SYSCONF_LOAD_OPEN:
+		load->result = result;
+		if (result < 0)
+			break;
+		load->fd = result;
+		load->stage = SYSCONF_LOAD_READ;
+		result = IOS_ReadAsync(load->fd, load->buffer, load->length, __SYSCONF_LoadStep, load);
+		if (result >= 0)
+			return 0;
+		/* The read never went out; close with its error */
+	case SYSCONF_LOAD_READ:
+		load->result = result;
+		load->stage = SYSCONF_LOAD_CLOSE;
+		if (IOS_CloseAsync(load->fd, __SYSCONF_LoadStep, load) >= 0)
+			return 0;
+		break;
+	}
+
+	load->stage = SYSCONF_LOAD_DONE;
+	__sysconf_loads_pending--;
+	LWP_ThreadSignal(__sysconf_load_queue);
+	return 0;
+}
+
+s32 SYSCONF_InitBegin(void)
+{
+	u32 level;
+	int i;
+
+	if (__sysconf_inited || __sysconf_loading)
+		return 0;
+
+	if (__SYSCONF_CreateMutex() < 0)
+		return SYSCONF_ENOMEM;
+	if (__sysconf_load_queue == LWP_TQUEUE_NULL && LWP_InitQueue(&__sysconf_load_queue) < 0)
+		return SYSCONF_ENOMEM;
+
+	/* Nothing reads the buffers before __sysconf_inited is set, so IOS can fill them in place */
+	memset(__sysconf_buffer, 0, 0x4000);
+	memset(__sysconf_txt_scratch, 0, 0x100);
+	__sysconf_loads[0].path = __sysconf_file;
+	__sysconf_loads[0].buffer = __sysconf_buffer;
+	__sysconf_loads[0].length = 0x4000;
+	__sysconf_loads[1].path = __sysconf_txt_file;
+	__sysconf_loads[1].buffer = __sysconf_txt_scratch;
+	__sysconf_loads[1].length = 0x100;
+
+	_CPU_ISR_Disable(level);
+	__sysconf_loading = 1;
+	__sysconf_loads_pending = 2;
+	for (i = 0; i < 2; i++)
+	{
+		__sysconf_loads[i].stage = SYSCONF_LOAD_OPEN;
+		__sysconf_loads[i].result = IOS_OpenAsync(__sysconf_loads[i].path, 1, __SYSCONF_LoadStep, &__sysconf_loads[i]);
+		if (__sysconf_loads[i].result < 0)
+		{
+			__sysconf_loads[i].stage = SYSCONF_LOAD_DONE;
+			__sysconf_loads_pending--;
+		}
+	}
+	_CPU_ISR_Restore(level);
+	return 0;
+}
+
+s32 SYSCONF_InitFinish(void)
+{
+	u32 level;
+
+	if (__sysconf_inited)
+		return 0;
+	if (!__sysconf_loading)
+		return SYSCONF_ENOTINIT;
+
+	_CPU_ISR_Disable(level);
+	while (__sysconf_loads_pending)
+		LWP_ThreadSleep(__sysconf_load_queue);
+	_CPU_ISR_Restore(level);
+	__sysconf_loading = 0;
+
+	/* Report the way the one-file-after-the-other version did: SYSCONF's problems first */
+	if (__sysconf_loads[0].result < 0)
+		return __sysconf_loads[0].result;
+	if (__sysconf_loads[0].result != 0x4000)
+		return SYSCONF_EBADFILE;
+	if (__sysconf_loads[1].result < 0)
+		return __sysconf_loads[1].result;
+	if (__sysconf_loads[1].result != 0x100)
+		return SYSCONF_EBADFILE;
+	if (memcmp(__sysconf_buffer, "SCv0", 4))
+		return SYSCONF_EBADFILE;
+
+	__SYSCONF_Lock();
+	__SYSCONF_BeginWrite();
+	__SYSCONF_HashFiles(__sysconf_buffer, __sysconf_txt_scratch);
+	__SYSCONF_DecryptTxt(__sysconf_txt_scratch);
+	__sysconf_inited = 1;
+	__SYSCONF_EndWrite();
+	__SYSCONF_Unlock();
+	return 0;
+}
+
+s32 SYSCONF_Init(void)
+{
+	s32 ret;
+
+	ret = SYSCONF_InitBegin();
+	if (ret < 0)
+		return ret;
+
+	return SYSCONF_InitFinish();
+}
+
+/* Reads length bytes at start of an open SYSCONF into __sysconf_readback, seeking only if the file is elsewhere */
+int __SYSCONF_ReadAt(int fd, u32 *pos, u32 start, u32 length)
+{
+	int ret;
+
+	if (*pos != start)
+	{
+		ret = IOS_Seek(fd, start, 0);
+		if (ret != start)
+			return SYSCONF_EBADFILE;
+		*pos = start;
+	}
+
+	ret = IOS_Read(fd, __sysconf_readback, length);
+	if (ret != length)
+		return ret < 0 ? ret : SYSCONF_EBADFILE;
+	*pos += length;
+	return 0;
+}
+
+/* Reads [start, end) of an open SYSCONF into the same bytes of __sysconf_buffer */
+int __SYSCONF_LoadRange(int fd, u32 *pos, u32 start, u32 end)
+{
+	u32 length;
+	int ret;
+
+	for (; start < end; start += length)
+	{
+		length = end - start < SYSCONF_BLOCK ? end - start : SYSCONF_BLOCK;
+		ret = __SYSCONF_ReadAt(fd, pos, start, length);
+		if (ret < 0)
+			return ret;
+		memcpy(&__sysconf_buffer[start], __sysconf_readback, length);
+	}
+	return 0;
+}
+
+/*
+ * Finding an entry by name means reading its first bytes, since the table only has offsets. They are
+ * read a block at a time from the first entry not yet looked at, so runs of small entries cost one
+ * read between them and big ones are skipped over. Only the named entries are kept in the buffer.
+ */
+s32 SYSCONF_InitPartial(const char *const *names, u32 count)
+{
+	u8 found[SYSCONF_PARTIAL_MAX];
+	u32 pos = 0, window = 0, windowEnd = SYSCONF_BLOCK, left = count;
+	u32 entries, tableEnd, i, j, offset, next, head, nlen;
+	const u8 *entry;
+	sysconf_range *range;
+	s32 ret;
+	int fd;
+
+	if (__sysconf_inited || __sysconf_loading)
+		return 0;
+	if (count > SYSCONF_PARTIAL_MAX)
+		return SYSCONF_EBADVALUE;
+	if (__SYSCONF_CreateMutex() < 0)
+		return SYSCONF_ENOMEM;
+
+	/* Nothing reads the buffers before __sysconf_inited is set */
+	memset(__sysconf_buffer, 0, 0x4000);
+	memset(__sysconf_txt_buffer, 0, 0x101);
+	memset(found, 0, sizeof(found));
+	__sysconf_range_count = 0;
+
+	fd = IOS_Open(__sysconf_file, 1);
+	if (fd < 0)
+		return fd;
+
+	/* On any SYSCONF a console writes, the first block holds the whole table and the first few entries */
+	ret = __SYSCONF_ReadAt(fd, &pos, 0, SYSCONF_BLOCK);
+	if (ret < 0)
+		goto out;
+	entries = __SYSCONF_Load16(&__sysconf_readback[4]);
+	tableEnd = 6 + (entries + 1) * 2;
+	if (memcmp(__sysconf_readback, "SCv0", 4) || tableEnd > 0x4000)
+	{
+		ret = SYSCONF_EBADFILE;
+		goto out;
+	}
+
+	memcpy(__sysconf_buffer, __sysconf_readback, tableEnd < SYSCONF_BLOCK ? tableEnd : SYSCONF_BLOCK);
+	if (tableEnd > SYSCONF_BLOCK)
+	{
+		ret = __SYSCONF_LoadRange(fd, &pos, SYSCONF_BLOCK, tableEnd);
+		if (ret < 0)
+			goto out;
+		window = windowEnd = 0;
+	}
+	__sysconf_ranges[0].start = 0;
+	__sysconf_ranges[0].end = tableEnd;
+	__sysconf_ranges[0].hash = __SYSCONF_Hash(__sysconf_buffer, tableEnd);
+	__sysconf_range_count = 1;
+
+	for (i = 0; i < entries && left; i++)
+	{
+		offset = __SYSCONF_Offset(i);
+		next = __SYSCONF_Offset(i + 1);
+		if (offset < tableEnd || next <= offset || next > 0x4000)
+		{
+			ret = SYSCONF_EBADFILE;
+			goto out;
+		}
+
+		/* The type byte and the longest name there can be, or the whole entry if it is shorter */
+		head = next - offset < 17 ? next - offset : 17;
+		if (offset < window || offset + head > windowEnd)
+		{
+			window = offset;
+			windowEnd = offset + SYSCONF_BLOCK < 0x4000 ? offset + SYSCONF_BLOCK : 0x4000;
+			ret = __SYSCONF_ReadAt(fd, &pos, window, windowEnd - window);
+			if (ret < 0)
+				goto out;
+		}
+
+		entry = &__sysconf_readback[offset - window];
+		nlen = (*entry & 0x0F) + 1;
+		if (1 + nlen > head)
+			continue;
+		for (j = 0; j < count; j++)
+			if (!found[j] && strlen(names[j]) == nlen && !memcmp(names[j], entry + 1, nlen))
+				break;
+		if (j == count)
+			continue;
+
+		if (next <= windowEnd)
+		{
+			memcpy(&__sysconf_buffer[offset], entry, next - offset);
+		}
+		else
+		{
+			/* Runs past the window, so it is read on its own and the window is gone */
+			ret = __SYSCONF_LoadRange(fd, &pos, offset, next);
+			if (ret < 0)
+				goto out;
+			window = windowEnd = 0;
+		}
+
+		range = &__sysconf_ranges[__sysconf_range_count++];
+		range->start = offset;
+		range->end = next;
+		range->hash = __SYSCONF_Hash(&__sysconf_buffer[offset], next - offset);
+		found[j] = 1;
+		left--;
+	}
+	ret = 0;
+out:
+	IOS_Close(fd);
+	if (ret < 0)
+		return ret;
+
+	__SYSCONF_Lock();
+	__SYSCONF_BeginWrite();
+	__sysconf_buffer_updated = 0;
+	__sysconf_txt_buffer_updated = 0;
+	__sysconf_dirty_start = 0x4000;
+	__sysconf_dirty_end = 0;
+	__sysconf_unverified = 0;
+	__sysconf_txt_unverified = 0;
+	__sysconf_partial = 1;
+	__sysconf_inited = 1;
+	__SYSCONF_EndWrite();
+	__SYSCONF_Unlock();
+	return 0;
+}
+
+/* setting.txt is only ever written when running as the System Menu */
+int __SYSCONF_CheckTxtWritable(void)
+{
+	u64 tid;
+	int ret;
+
+	ret = ES_GetTitleID(&tid);
+	if (ret < 0)
+		return ret;
+
+	if (tid != 0x100000002LL)
+		return SYSCONF_EPERMS;
+
+	return 0;
+}
+
+/* setting.txt is read-only to everyone; open it up just long enough to write the encrypted image.
+   It is small enough to check whole against its hash first. */
+int __SYSCONF_WriteTxtFile(const char *txt)
+{
+	int ret, fd;
+
+	fd = IOS_Open(__sysconf_txt_file, 1);
+	if (fd < 0)
+		return fd;
+
+	ret = IOS_Read(fd, __sysconf_readback, 0x100);
+	IOS_Close(fd);
+	if (ret != 0x100)
+		return ret < 0 ? ret : SYSCONF_EBADFILE;
+	if (__SYSCONF_Hash(__sysconf_readback, 0x100) != __sysconf_txt_hash)
+		return SYSCONF_EMODIFIED;
+
+	ret = ISFS_SetAttr(__sysconf_txt_file, 0x1000, 1, 0, 3, 3, 3);
+	if (ret < 0)
+		return ret;
+
+	fd = IOS_Open(__sysconf_txt_file, 2);
+	if (fd < 0)
+		return fd;
+
+	ret = IOS_Write(fd, txt, 0x100);
+	IOS_Close(fd);
+	if (ret != 0x100)
+		return SYSCONF_EBADWRITE;
+
+	__sysconf_txt_hash = __SYSCONF_Hash(txt, 0x100);
+	__sysconf_txt_unverified = 1;
+
+	ret = ISFS_SetAttr(__sysconf_txt_file, 0x1000, 1, 0, 1, 1, 1);
+	if (ret < 0)
+		return ret;
+
+	return 0;
+}
+
+int __SYSCONF_WriteTxtBuffer(void)
+{
+	int ret;
+
+	if (!__sysconf_inited)
+		return SYSCONF_ENOTINIT;
+
+	if (!__sysconf_txt_buffer_updated)
+		return 0;
+
+	ret = __SYSCONF_CheckTxtWritable();
+	if (ret < 0)
+		return ret;
+
+	__SYSCONF_EncryptTxt(__sysconf_txt_scratch);
+	ret = __SYSCONF_WriteTxtFile(__sysconf_txt_scratch);
+	if (ret < 0)
+		return ret;
+
+	__sysconf_txt_buffer_updated = 0;
+
+	return 0;
+}
+
+/*
+ * Hashes what an open SYSCONF holds in range into *old and, if new is given, what it would hold with
+ * [start, end) of buffer written over it into *new.
+ */
+int __SYSCONF_HashRange(int fd, u32 *pos, const sysconf_range *range, const u8 *buffer, u32 start, u32 end, u32 *old, u32 *new)
+{
+	u32 chunk, length, from, to;
+	int ret;
+
+	*old = 0x811C9DC5;
+	if (new)
+		*new = 0x811C9DC5;
+
+	for (chunk = range->start; chunk < range->end; chunk += length)
+	{
+		length = range->end - chunk < SYSCONF_BLOCK ? range->end - chunk : SYSCONF_BLOCK;
+		ret = __SYSCONF_ReadAt(fd, pos, chunk, length);
+		if (ret < 0)
+			return ret;
+		*old = __SYSCONF_HashMore(*old, __sysconf_readback, length);
+		if (!new)
+			continue;
+
+		from = start > chunk ? start : chunk;
+		to = end < chunk + length ? end : chunk + length;
+		if (from < to)
+			memcpy(&__sysconf_readback[from - chunk], &buffer[from], to - from);
+		*new = __SYSCONF_HashMore(*new, __sysconf_readback, length);
+	}
+	return 0;
+}
+
+/*
+ * __SYSCONF_WriteRange after a partial init: [start, end) only goes out where it falls in a loaded
+ * entry, since the buffer has nothing valid elsewhere. The table and each entry written must still
+ * be as they were loaded; if an entry had moved, its offset here would point at something else.
+ */
+int __SYSCONF_WritePartial(const u8 *buffer, u32 start, u32 end)
+{
+	u32 hashes[SYSCONF_PARTIAL_MAX + 1];
+	u32 i, pos = 0, from, to, old;
+	sysconf_range *range;
+	int ret, fd;
+
+	fd = IOS_Open(__sysconf_file, 3);
+	if (fd < 0)
+		return fd;
+
+	for (i = 0; i < __sysconf_range_count; i++)
+	{
+		range = &__sysconf_ranges[i];
+		hashes[i] = range->hash;
+		if (i && (range->end <= start || range->start >= end))
+			continue;
+
+		/* Nothing is ever written to the table, so it is only checked */
+		ret = __SYSCONF_HashRange(fd, &pos, range, buffer, start, end, &old, i ? &hashes[i] : NULL);
+		if (ret < 0)
+			goto out;
+		if (old != range->hash)
+		{
+			ret = SYSCONF_EMODIFIED;
+			goto out;
+		}
+	}
+
+	for (i = 1; i < __sysconf_range_count; i++)
+	{
+		range = &__sysconf_ranges[i];
+		from = start > range->start ? start : range->start;
+		to = end < range->end ? end : range->end;
+		if (from >= to)
+			continue;
+
+		if (pos != from)
+		{
+			ret = IOS_Seek(fd, from, 0);
+			if (ret != from)
+			{
+				ret = SYSCONF_EBADFILE;
+				goto out;
+			}
+		}
+		ret = IOS_Write(fd, &buffer[from], to - from);
+		if (ret != to - from)
+		{
+			ret = SYSCONF_EBADFILE;
+			goto out;
+		}
+		pos = to;
+
+		range->hash = hashes[i];
+		__sysconf_unverified |= 1u << i;
+	}
+	ret = 0;
+out:
+	IOS_Close(fd);
+	return ret;
+}
+
+/* __SYSCONF_VerifyWritten after a partial init, a range at a time */
+int __SYSCONF_VerifyPartial(void)
+{
+	u32 i, pos = 0, hash;
+	int ret = 0, fd, bytes = 0;
+
+	if (!__sysconf_unverified)
+		return 0;
+
+	fd = IOS_Open(__sysconf_file, 1);
+	if (fd < 0)
+		return fd;
+
+	for (i = 0; i < __sysconf_range_count; i++)
+	{
+		if (!(__sysconf_unverified & (1u << i)))
+			continue;
+
+		ret = __SYSCONF_HashRange(fd, &pos, &__sysconf_ranges[i], NULL, 0, 0, &hash, NULL);
+		if (ret < 0)
+			break;
+		bytes += __sysconf_ranges[i].end - __sysconf_ranges[i].start;
+
+		if (hash != __sysconf_ranges[i].hash)
+		{
+			ret = SYSCONF_EBADWRITE;
+			break;
+		}
+		__sysconf_unverified &= ~(1u << i);
+	}
+	IOS_Close(fd);
+	if (__sysconf_unverified)
+		return ret;
+	return bytes;
+}
+
+/*
+ * Writes [start, end) of an image of SYSCONF over the same bytes of the file. The blocks it lands
+ * in are read first and must still match their hashes; the rest of the file is never touched.
+ * Only the bytes in range are taken from buffer, the rest of it need not be valid.
+ */
+int __SYSCONF_WriteRange(const u8 *buffer, u32 start, u32 end)
+{
+	u32 hashes[0x4000 / SYSCONF_BLOCK];
+	u32 first = start / SYSCONF_BLOCK, last = (end + SYSCONF_BLOCK - 1) / SYSCONF_BLOCK;
+	u32 block, from, to;
+	int ret, fd;
+
+	if (__sysconf_partial)
+		return __SYSCONF_WritePartial(buffer, start, end);
+
+	fd = IOS_Open(__sysconf_file, 3);
+	if (fd < 0)
+		return fd;
+
+	/* Work out what each block will hash to from what is there now plus the new bytes */
+	for (block = first; block < last; block++)
+	{
+		ret = __SYSCONF_ReadBlock(fd, block);
+		if (ret < 0)
+			goto out;
+
+		if (__SYSCONF_Hash(__sysconf_readback, SYSCONF_BLOCK) != __sysconf_block_hash[block])
+		{
+			ret = SYSCONF_EMODIFIED;
+			goto out;
+		}
+
+		from = block == first ? start : block * SYSCONF_BLOCK;
+		to = block == last - 1 ? end : (block + 1) * SYSCONF_BLOCK;
+		memcpy(&__sysconf_readback[from % SYSCONF_BLOCK], &buffer[from], to - from);
+		hashes[block] = __SYSCONF_Hash(__sysconf_readback, SYSCONF_BLOCK);
+	}
+
+	ret = IOS_Seek(fd, start, 0);
+	if (ret != start)
+	{
+		ret = SYSCONF_EBADFILE;
+		goto out;
+	}
+
+	ret = IOS_Write(fd, &buffer[start], end - start);
+	if (ret != end - start)
+	{
+		ret = SYSCONF_EBADFILE;
+		goto out;
+	}
+
+	for (block = first; block < last; block++)
+	{
+		__sysconf_block_hash[block] = hashes[block];
+		__sysconf_unverified |= 1u << block;
+	}
+	ret = 0;
+out:
+	IOS_Close(fd);
+	return ret;
+}
+
+/* Reads back what was written since the last verify and checks it against the hashes.
+   Returns the number of bytes read. */
+int __SYSCONF_VerifyWritten(void)
+{
+	int ret = 0, fd, bytes = 0;
+	u32 block;
+
+	if (__sysconf_partial)
+		return __SYSCONF_VerifyPartial();
+
+	if (__sysconf_unverified)
+	{
+		fd = IOS_Open(__sysconf_file, 1);
+		if (fd < 0)
+			return fd;
+
+		for (block = 0; block < 0x4000 / SYSCONF_BLOCK; block++)
+		{
+			if (!(__sysconf_unverified & (1u << block)))
+				continue;
+
+			ret = __SYSCONF_ReadBlock(fd, block);
+			if (ret < 0)
+				break;
+			bytes += SYSCONF_BLOCK;
+
+			if (__SYSCONF_Hash(__sysconf_readback, SYSCONF_BLOCK) != __sysconf_block_hash[block])
+			{
+				ret = SYSCONF_EBADWRITE;
+				break;
+			}
+			__sysconf_unverified &= ~(1u << block);
+		}
+		IOS_Close(fd);
+		if (__sysconf_unverified)
+			return ret;
+	}
+
+	if (__sysconf_txt_unverified)
+	{
+		fd = IOS_Open(__sysconf_txt_file, 1);
+		if (fd < 0)
+			return fd;
+
+		ret = IOS_Read(fd, __sysconf_readback, 0x100);
+		IOS_Close(fd);
+		if (ret != 0x100)
+			return ret < 0 ? ret : SYSCONF_EBADFILE;
+		bytes += 0x100;
+
+		if (__SYSCONF_Hash(__sysconf_readback, 0x100) != __sysconf_txt_hash)
+			return SYSCONF_EBADWRITE;
+		__sysconf_txt_unverified = 0;
+	}
+
+	return bytes;
+}
+
+int __SYSCONF_WriteBuffer(void)
+{
+	int ret;
+
+	if (!__sysconf_inited)
+		return SYSCONF_ENOTINIT;
+
+	if (!__sysconf_buffer_updated)
+		return 0;
+
+	ret = __SYSCONF_WriteRange(__sysconf_buffer, __sysconf_dirty_start, __sysconf_dirty_end);
+	if (ret < 0)
+		return ret;
+
+	__sysconf_buffer_updated = 0;
+	__sysconf_dirty_start = 0x4000;
+	__sysconf_dirty_end = 0;
+	return 0;
+}
+
+#ifndef SYSCONF_PER_THREAD
+/*
+ * Background saves. SYSCONF_SaveChangesAsync copies the dirty bytes into the queued image and wakes
+ * the saver thread, which writes the image out while the caller carries on. The buffers stay dirty
+ * until a save of them completes, so each image covers every earlier one: saves queued while one is
+ * being written simply replace the queued image, and a failed one is written again by the next.
+ */
+#define SYSCONF_SAVE_PRIO 48 /* Below the main thread's 64, so it runs while the UI waits for a vsync */
+#define SYSCONF_SAVE_STACK 0x2000
+
+typedef struct _sysconf_save_image
+{
+	u8 buffer[0x4000];
+	char txt[0x100];
+	u32 dirty_start;
+	u32 dirty_end;
+	int txt_updated;
+	u32 changes;
+} sysconf_save_image;
+
+static sysconf_save_image *__sysconf_save_queued = NULL;
+static sysconf_save_image *__sysconf_save_writing = NULL;
+static int __sysconf_save_pending = 0;
+static int __sysconf_save_busy = 0;
+static s32 __sysconf_save_result = SYSCONF_ERR_OK;
+static sysconf_save_cb __sysconf_save_cb = NULL;
+static void *__sysconf_save_usrdata = NULL;
+static mutex_t __sysconf_save_mutex = LWP_MUTEX_NULL;
+static cond_t __sysconf_save_work = LWP_COND_NULL;
+static cond_t __sysconf_save_done = LWP_COND_NULL;
+static lwp_t __sysconf_save_thread = LWP_THREAD_NULL;
+
+static void *__SYSCONF_SaveThread(void *arg)
+{
+	sysconf_save_image *image;
+	sysconf_save_cb cb;
+	void *usrdata;
+	s32 ret;
+
+	LWP_MutexLock(__sysconf_save_mutex);
+	while (1)
+	{
+		while (!__sysconf_save_pending)
+			LWP_CondWait(__sysconf_save_work, __sysconf_save_mutex);
+
+		image = __sysconf_save_queued;
+		__sysconf_save_queued = __sysconf_save_writing;
+		__sysconf_save_writing = image;
+		__sysconf_save_pending = 0;
+		__sysconf_save_busy = 1;
+		LWP_MutexUnlock(__sysconf_save_mutex);
+
+		ret = SYSCONF_ERR_OK;
+		if (image->dirty_start < image->dirty_end)
+			ret = __SYSCONF_WriteRange(image->buffer, image->dirty_start, image->dirty_end);
+		if (ret >= 0 && image->txt_updated)
+			ret = __SYSCONF_WriteTxtFile(image->txt);
+
+		LWP_MutexLock(__sysconf_save_mutex);
+		if (ret >= 0)
+			__atomic_store_n(&__sysconf_saved_changes, image->changes, __ATOMIC_RELEASE);
+		__sysconf_save_busy = 0;
+		__sysconf_save_result = ret;
+		cb = __sysconf_save_cb;
+		usrdata = __sysconf_save_usrdata;
+		LWP_CondBroadcast(__sysconf_save_done);
+
+		if (cb)
+		{
+			LWP_MutexUnlock(__sysconf_save_mutex);
+			cb(ret, usrdata);
+			LWP_MutexLock(__sysconf_save_mutex);
+		}
+	}
+	return NULL;
+}
+
+static s32 __SYSCONF_StartSaver(void)
+{
+	if (__sysconf_save_thread != LWP_THREAD_NULL)
+		return 0;
+
+	if (!__sysconf_save_queued)
+		__sysconf_save_queued = memalign(32, sizeof(sysconf_save_image));
+	if (!__sysconf_save_writing)
+		__sysconf_save_writing = memalign(32, sizeof(sysconf_save_image));
+	if (!__sysconf_save_queued || !__sysconf_save_writing)
+		return SYSCONF_ENOMEM;
+
+	if (__sysconf_save_mutex == LWP_MUTEX_NULL && LWP_MutexInit(&__sysconf_save_mutex, false) < 0)
+		return SYSCONF_ENOMEM;
+	if (__sysconf_save_work == LWP_COND_NULL && LWP_CondInit(&__sysconf_save_work) < 0)
+		return SYSCONF_ENOMEM;
+	if (__sysconf_save_done == LWP_COND_NULL && LWP_CondInit(&__sysconf_save_done) < 0)
+		return SYSCONF_ENOMEM;
+
+	if (LWP_CreateThread(&__sysconf_save_thread, __SYSCONF_SaveThread, NULL, NULL, SYSCONF_SAVE_STACK, SYSCONF_SAVE_PRIO) < 0)
+	{
+		__sysconf_save_thread = LWP_THREAD_NULL;
+		return SYSCONF_ENOMEM;
+	}
+	return 0;
+}
+
+/* Called with the writer lock held, before anything else touches the files */
+void __SYSCONF_FlushAsync(void)
+{
+	if (__sysconf_save_thread == LWP_THREAD_NULL)
+		return;
+
+	LWP_MutexLock(__sysconf_save_mutex);
+	while (__sysconf_save_pending || __sysconf_save_busy)
+		LWP_CondWait(__sysconf_save_done, __sysconf_save_mutex);
+	LWP_MutexUnlock(__sysconf_save_mutex);
+
+	__SYSCONF_DropSaved();
+}
+
+s32 SYSCONF_SaveChangesAsync(void)
+{
+	sysconf_save_image *image;
+	s32 ret;
+
+	__SYSCONF_Lock();
+	if (!__sysconf_inited)
+	{
+		ret = SYSCONF_ENOTINIT;
+		goto out;
+	}
+
+	ret = __SYSCONF_StartSaver();
+	if (ret < 0)
+		goto out;
+
+	/* Refuse up front, the same as SYSCONF_SaveChanges */
+	__SYSCONF_DropSaved();
+	if (__sysconf_txt_buffer_updated)
+	{
+		ret = __SYSCONF_CheckTxtWritable();
+		if (ret < 0)
+			goto out;
+	}
+
+	/* Only the dirty bytes are copied; the saver never looks at the rest of its image */
+	LWP_MutexLock(__sysconf_save_mutex);
+	image = __sysconf_save_queued;
+	image->dirty_start = __sysconf_buffer_updated ? __sysconf_dirty_start : 0x4000;
+	image->dirty_end = __sysconf_buffer_updated ? __sysconf_dirty_end : 0;
+	if (image->dirty_start < image->dirty_end)
+		memcpy(&image->buffer[image->dirty_start], &__sysconf_buffer[image->dirty_start], image->dirty_end - image->dirty_start);
+	image->txt_updated = __sysconf_txt_buffer_updated;
+	if (image->txt_updated)
+		__SYSCONF_EncryptTxt(image->txt);
+	image->changes = __sysconf_changes;
+	__sysconf_save_pending = 1;
+	LWP_CondSignal(__sysconf_save_work);
+	LWP_MutexUnlock(__sysconf_save_mutex);
+
+	ret = SYSCONF_ERR_OK;
+out:
+	__SYSCONF_Unlock();
+	return ret;
+}
+
+void SYSCONF_SetSaveCallback(sysconf_save_cb cb, void *usrdata)
+{
+	if (__sysconf_save_mutex == LWP_MUTEX_NULL && LWP_MutexInit(&__sysconf_save_mutex, false) < 0)
+		return;
+
+	LWP_MutexLock(__sysconf_save_mutex);
+	__sysconf_save_cb = cb;
+	__sysconf_save_usrdata = usrdata;
+	LWP_MutexUnlock(__sysconf_save_mutex);
+}
+
+s32 SYSCONF_GetSaveStatus(void)
+{
+	s32 ret;
+
+	if (__sysconf_save_thread == LWP_THREAD_NULL)
+		return SYSCONF_ERR_OK;
+
+	LWP_MutexLock(__sysconf_save_mutex);
+	ret = (__sysconf_save_pending || __sysconf_save_busy) ? SYSCONF_SAVE_BUSY : __sysconf_save_result;
+	LWP_MutexUnlock(__sysconf_save_mutex);
+	return ret;
+}
+
+s32 SYSCONF_WaitSave(void)
+{
+	s32 ret;
+
+	if (__sysconf_save_thread == LWP_THREAD_NULL)
+		return SYSCONF_ERR_OK;
+
+	LWP_MutexLock(__sysconf_save_mutex);
+	while (__sysconf_save_pending || __sysconf_save_busy)
+		LWP_CondWait(__sysconf_save_done, __sysconf_save_mutex);
+	ret = __sysconf_save_result;
+	LWP_MutexUnlock(__sysconf_save_mutex);
+	return ret;
+}
+#else
+static inline void __SYSCONF_FlushAsync(void)
+{
+}
+#endif /* SYSCONF_PER_THREAD */
+
+int __SYSCONF_SaveChanges(void)
+{
+	s32 ret;
+	if (!__sysconf_inited)
+		return SYSCONF_ENOTINIT;
+
+	/* A background save must not land on top of this one with older data */
+	__SYSCONF_FlushAsync();
+
+	/* Refuse up front rather than after SYSCONF has already gone out */
+	if (__sysconf_txt_buffer_updated)
+	{
+		ret = __SYSCONF_CheckTxtWritable();
+		if (ret < 0)
+			return ret;
+	}
+
+	ret = __SYSCONF_WriteBuffer();
+	if (ret < 0)
+		return ret;
+
+	ret = __SYSCONF_WriteTxtBuffer();
+	if (ret < 0)
+		return ret;
+
+	return SYSCONF_ERR_OK;
+}
+
+s32 SYSCONF_SaveChanges(void)
+{
+	s32 ret;
+
+	__SYSCONF_Lock();
+	ret = __SYSCONF_SaveChanges();
+	__SYSCONF_Unlock();
+	return ret;
+}
+
+s32 SYSCONF_VerifySaved(void)
+{
+	s32 ret;
+
+	__SYSCONF_Lock();
+	if (!__sysconf_inited)
+	{
+		__SYSCONF_Unlock();
+		return SYSCONF_ENOTINIT;
+	}
+
+	__SYSCONF_FlushAsync();
+	ret = __SYSCONF_VerifyWritten();
+	__SYSCONF_Unlock();
+	return ret;
+}
+
+typedef struct _sysconf_snapshot
+{
+	u8 buffer[0x4000];
+	char txt_buffer[0x101];
+	int buffer_updated;
+	int txt_buffer_updated;
+	u32 dirty_start;
+	u32 dirty_end;
+} sysconf_snapshot;
+
+SYSCONF_STATE sysconf_snapshot *__sysconf_transaction = NULL;
+
+sysconf_snapshot *__SYSCONF_TakeSnapshot(void)
+{
+	sysconf_snapshot *snapshot = malloc(sizeof(sysconf_snapshot));
+
+	if (!snapshot)
+		return NULL;
+
+	memcpy(snapshot->buffer, __sysconf_buffer, 0x4000);
+	memcpy(snapshot->txt_buffer, __sysconf_txt_buffer, 0x101);
+	snapshot->buffer_updated = __sysconf_buffer_updated;
+	snapshot->txt_buffer_updated = __sysconf_txt_buffer_updated;
+	snapshot->dirty_start = __sysconf_dirty_start;
+	snapshot->dirty_end = __sysconf_dirty_end;
+	return snapshot;
+}
+
+/* Puts the buffers back as they were and frees the snapshot. The caller has begun a write */
+void __SYSCONF_RestoreSnapshot(sysconf_snapshot *snapshot)
+{
+	memcpy(__sysconf_buffer, snapshot->buffer, 0x4000);
+	memcpy(__sysconf_txt_buffer, snapshot->txt_buffer, 0x101);
+	__sysconf_changes++;
+	__sysconf_buffer_updated = snapshot->buffer_updated;
+	__sysconf_txt_buffer_updated = snapshot->txt_buffer_updated;
+	__sysconf_dirty_start = snapshot->dirty_start;
+	__sysconf_dirty_end = snapshot->dirty_end;
+	free(snapshot);
+}
+
+/* A transaction holds the writer lock from Begin until Commit or Abort; readers carry on regardless */
+s32 SYSCONF_BeginTransaction(void)
+{
+	if (!__sysconf_inited)
+		return SYSCONF_ENOTINIT;
+
+	__SYSCONF_Lock();
+	if (__sysconf_transaction)
+	{
+		__SYSCONF_Unlock();
+		return SYSCONF_EBADVALUE;
+	}
+
+	__sysconf_transaction = __SYSCONF_TakeSnapshot();
+	if (!__sysconf_transaction)
+	{
+		__SYSCONF_Unlock();
+		return SYSCONF_ENOMEM;
+	}
+	return SYSCONF_ERR_OK;
+}
+
+s32 SYSCONF_AbortTransaction(void)
+{
+	__SYSCONF_Lock();
+	if (!__sysconf_transaction)
+	{
+		__SYSCONF_Unlock();
+		return SYSCONF_EBADVALUE;
+	}
+
+	__SYSCONF_BeginWrite();
+	__SYSCONF_RestoreSnapshot(__sysconf_transaction);
+	__SYSCONF_EndWrite();
+	__sysconf_transaction = NULL;
+	/* Once for this call, once for the Begin */
+	__SYSCONF_Unlock();
+	__SYSCONF_Unlock();
+	return SYSCONF_ERR_OK;
+}
+
+/* Writes everything staged since SYSCONF_BeginTransaction, each file at most once, then reads back what was written.
+   If it fails before writing anything the staged changes stay in memory, so the caller can retry or
+   SYSCONF_AbortTransaction them. Once a file has been written there is nothing left to abort: the
+   transaction ends with SYSCONF_ECOMMITTED, and a file that wasn't written goes back to what NAND holds. */
+s32 SYSCONF_CommitTransaction(void)
+{
+	sysconf_snapshot *snapshot;
+	int buffer_pending, txt_pending;
+	s32 ret;
+
+	__SYSCONF_Lock();
+	snapshot = __sysconf_transaction;
+	if (!snapshot)
+	{
+		__SYSCONF_Unlock();
+		return SYSCONF_EBADVALUE;
+	}
+
+	buffer_pending = __sysconf_buffer_updated;
+	txt_pending = __sysconf_txt_buffer_updated;
+
+	ret = __SYSCONF_SaveChanges();
+	if (ret >= 0)
+		ret = __SYSCONF_VerifyWritten();
+	if (ret >= 0)
+	{
+		ret = SYSCONF_ERR_OK;
+		goto done;
+	}
+
+	/* Each successful write clears its file's flag */
+	if ((!buffer_pending || __sysconf_buffer_updated) && (!txt_pending || __sysconf_txt_buffer_updated))
+		goto out;
+
+	__SYSCONF_BeginWrite();
+	if (__sysconf_buffer_updated)
+	{
+		memcpy(__sysconf_buffer, snapshot->buffer, 0x4000);
+		__sysconf_buffer_updated = snapshot->buffer_updated;
+		__sysconf_dirty_start = snapshot->dirty_start;
+		__sysconf_dirty_end = snapshot->dirty_end;
+	}
+	if (__sysconf_txt_buffer_updated)
+	{
+		memcpy(__sysconf_txt_buffer, snapshot->txt_buffer, 0x101);
+		__sysconf_txt_buffer_updated = snapshot->txt_buffer_updated;
+	}
+	__sysconf_changes++;
+	__SYSCONF_EndWrite();
+	ret = SYSCONF_ECOMMITTED;
+
+done:
+	free(snapshot);
+	__sysconf_transaction = NULL;
+	__SYSCONF_Unlock();
+out:
+	__SYSCONF_Unlock();
+	return ret;
+}
+
+static void __SYSCONF_AddBuffer(sysconf_buffer *buffers, u32 count, u32 *n, const char *name, const void *data, u32 size, BOOL heap)
+{
+	if (!data)
+		return;
+	if (*n < count)
+	{
+		buffers[*n].name = name;
+		buffers[*n].data = data;
+		buffers[*n].size = size;
+		buffers[*n].heap = heap;
+	}
+	(*n)++;
+}
+
+/* The save images only exist once something has been saved, the snapshot only during a transaction */
+s32 SYSCONF_GetBuffers(sysconf_buffer *buffers, u32 count)
+{
+	u32 n = 0;
+
+	__SYSCONF_Lock();
+	__SYSCONF_AddBuffer(buffers, count, &n, "SYSCONF image", __sysconf_buffer, sizeof(__sysconf_buffer), FALSE);
+	__SYSCONF_AddBuffer(buffers, count, &n, "setting.txt", __sysconf_txt_buffer, sizeof(__sysconf_txt_buffer), FALSE);
+	__SYSCONF_AddBuffer(buffers, count, &n, "setting.txt scratch", __sysconf_txt_scratch, sizeof(__sysconf_txt_scratch), FALSE);
+	__SYSCONF_AddBuffer(buffers, count, &n, "read-back block", __sysconf_readback, sizeof(__sysconf_readback), FALSE);
+	__SYSCONF_AddBuffer(buffers, count, &n, "block hashes", __sysconf_block_hash, sizeof(__sysconf_block_hash), FALSE);
+	__SYSCONF_AddBuffer(buffers, count, &n, "loaded ranges", __sysconf_ranges, sizeof(__sysconf_ranges), FALSE);
+#ifndef SYSCONF_PER_THREAD
+	if (__sysconf_save_mutex != LWP_MUTEX_NULL)
+	{
+		LWP_MutexLock(__sysconf_save_mutex);
+		__SYSCONF_AddBuffer(buffers, count, &n, "queued save", __sysconf_save_queued, sizeof(sysconf_save_image), TRUE);
+		__SYSCONF_AddBuffer(buffers, count, &n, "save in progress", __sysconf_save_writing, sizeof(sysconf_save_image), TRUE);
+		LWP_MutexUnlock(__sysconf_save_mutex);
+	}
+#endif
+	__SYSCONF_AddBuffer(buffers, count, &n, "transaction snapshot", __sysconf_transaction, sizeof(sysconf_snapshot), TRUE);
+	__SYSCONF_Unlock();
+
+	return n;
+}
+
+int __SYSCONF_ShiftTxt(char *start, s32 delta)
+{
+	char *end;
+	char temp[0x100];
+
+	end = strchr((char *)__sysconf_txt_buffer, 0);
+	if (end == NULL || end > __sysconf_txt_buffer + 0x100)
+		return SYSCONF_EBADFILE;
+
+	if (start < __sysconf_txt_buffer || start >= end)
+		return SYSCONF_EBADVALUE;
+
+	memcpy(temp, start, end - start);
+	memcpy(start + delta, temp, end - start);
+	// free (temp);
+	*(end + delta) = 0;
+	return 0;
+}
+
+int __SYSCONF_GetTxt(const char *name, char *buf, int length)
+{
+	char *line = __sysconf_txt_buffer;
+	char *delim, *end;
+	int slen;
+	int nlen = strlen(name);
+
+	if (!__sysconf_inited)
+		return SYSCONF_ENOTINIT;
+	if (__sysconf_partial)
+		return SYSCONF_EPARTIAL;
+
+	while (line < (__sysconf_txt_buffer + 0x100))
+	{
+		delim = strchr(line, '=');
+		if (delim && ((delim - line) == nlen) && !memcmp(name, line, nlen))
+		{
 			delim++;
 			end = strchr(line, '\r');
-			if (end)
+			if (end && end >= delim)
 			{
 				slen = end - delim;
 				if (slen < length)
@@ -344,247 +1901,1064 @@ int __SYSCONF_GetTxt(const char *name, char *buf, int length)
 			}
 		}
 
-		// skip to line end
-		while (line < (__sysconf_txt_buffer + 0x100) && *line++ != '\n')
-			;
+		// skip to line end
+		while (line < (__sysconf_txt_buffer + 0x100) && *line++ != '\n')
+			;
+	}
+	return SYSCONF_ENOENT;
+}
+
+/* This function should NOT be used, and was only added for emergency recovery at one point */
+int __SYSCONF_AddTxt(const char *name, const char *value)
+{
+	char *newline;
+	char temp[0x100];
+	char endline[10];
+	u32 length;
+
+	if (!__sysconf_inited)
+		return SYSCONF_ENOTINIT;
+	if (__sysconf_partial)
+		return SYSCONF_EPARTIAL;
+
+	newline = strchr((char *)__sysconf_txt_buffer, 0);
+	if (newline == NULL || newline > __sysconf_txt_buffer + 0x100)
+		return SYSCONF_EBADFILE;
+
+	newline--;
+	while (*--newline == '\r')
+		;
+	newline++;
+
+	strcpy(endline, newline);
+
+	newline += strlen(endline);
+
+	length = strlen(name) + strlen(value) + strlen(endline) + 1;
+
+	if (newline + length < __sysconf_txt_buffer + 0x100)
+	{
+		sprintf(temp, "%s=%s%s", name, value, endline);
+		strcpy(newline, temp);
+	}
+	else
+	{
+		printf("Not worth it!");
+		return SYSCONF_EBADFILE;
+	}
+
+	return 0;
+}
+
+int __SYSCONF_SetTxt(const char *name, const char *value)
+{
+	char *line = __sysconf_txt_buffer;
+	char *delim, *end;
+	int slen;
+	int nlen = strlen(name);
+	int vlen = strlen(value);
+
+	if (!__sysconf_inited)
+		return SYSCONF_ENOTINIT;
+	if (__sysconf_partial)
+		return SYSCONF_EPARTIAL;
+
+	while (line < (__sysconf_txt_buffer + 0x100))
+	{
+		delim = strchr(line, '=');
+		if (delim && ((delim - line) == nlen) && !memcmp(name, line, nlen))
+		{
+			delim++;
+			end = strchr(line, '\r');
+			if (end)
+			{
+				slen = end - delim;
+				if (slen == vlen)
+				{
+					// printf("vlen: %u slen: %u\n", vlen, slen);
+					memcpy(delim, value, vlen);
+					__SYSCONF_MarkTxtDirty();
+					return 0;
+				}
+				else if (vlen && (vlen < slen ||
+								  (strchr(end, '\n') + (vlen - slen)) < __sysconf_txt_buffer + 0x100))
+				{
+					// printf("vlen: %u slen: %u\n", vlen, slen);
+					if (__SYSCONF_ShiftTxt(end, vlen - slen))
+						return -1;
+					memcpy(delim, value, vlen);
+					__SYSCONF_MarkTxtDirty();
+					return 0;
+				}
+				else
+				{
+					return SYSCONF_EBADVALUE;
+				}
+			}
+		}
+
+		// skip to line end
+		while (line < (__sysconf_txt_buffer + 0x100) && *line++ != '\n')
+			;
+	}
+
+	return SYSCONF_ENOENT;
+}
+
+s32 SYSCONF_GetTxt(const char *name, char *buffer, u32 length)
+{
+	u32 seq;
+	s32 ret;
+
+	do
+	{
+		seq = __SYSCONF_ReadBegin();
+		ret = __SYSCONF_GetTxt(name, buffer, length);
+	} while (__SYSCONF_ReadRetry(seq));
+	return ret;
+}
+
+s32 SYSCONF_SetTxt(const char *name, const char *value)
+{
+	s32 ret;
+
+	__SYSCONF_Lock();
+	__SYSCONF_BeginWrite();
+	ret = __SYSCONF_SetTxt(name, value);
+	__SYSCONF_EndWrite();
+	__SYSCONF_Unlock();
+	return ret;
+}
+
+int __SYSCONF_GetTxtPlain(char *buffer, u32 length)
+{
+	u32 len;
+
+	if (!__sysconf_inited)
+		return SYSCONF_ENOTINIT;
+	if (__sysconf_partial)
+		return SYSCONF_EPARTIAL;
+
+	/* Byte 0x100 is never written, so this stops inside the buffer even mid-change */
+	len = strlen(__sysconf_txt_buffer);
+	if (length < len + 1)
+		return SYSCONF_ETOOBIG;
+
+	memcpy(buffer, __sysconf_txt_buffer, len);
+	buffer[len] = 0;
+	return len;
+}
+
+s32 SYSCONF_GetTxtPlain(char *buffer, u32 length)
+{
+	u32 seq;
+	s32 ret;
+
+	do
+	{
+		seq = __SYSCONF_ReadBegin();
+		ret = __SYSCONF_GetTxtPlain(buffer, length);
+	} while (__SYSCONF_ReadRetry(seq));
+	return ret;
+}
+
+s32 SYSCONF_SetTxtPlain(const char *text, u32 length)
+{
+	s32 ret = SYSCONF_ERR_OK;
+
+	if (length > 0x100 || memchr(text, 0, length))
+		return SYSCONF_EBADVALUE;
+
+	/* Checked under the lock, like the other setters, so a concurrent init can't slip in between */
+	__SYSCONF_Lock();
+	if (!__sysconf_inited)
+		ret = SYSCONF_ENOTINIT;
+	else if (__sysconf_partial)
+		ret = SYSCONF_EPARTIAL;
+	if (ret < 0)
+	{
+		__SYSCONF_Unlock();
+		return ret;
+	}
+
+	__SYSCONF_BeginWrite();
+	memset(__sysconf_txt_buffer, 0, 0x101);
+	memcpy(__sysconf_txt_buffer, text, length);
+	__SYSCONF_EndWrite();
+	__SYSCONF_MarkTxtDirty();
+	__SYSCONF_Unlock();
+	return 0;
+}
+
+u8 *__SYSCONF_Find(const char *name)
+{
+	u16 i, count, offset;
+	int nlen = strlen(name);
+	count = __SYSCONF_Count();
+
+	/* Readers can run into a half-moved table, so nothing here may step outside the buffer */
+	for (i = 0; i < count && 6 + i * 2 < 0x4000; i++)
+	{
+		offset = __SYSCONF_Offset(i);
+		if (offset + 1 + nlen + 2 > 0x4000)
+			continue;
+		if ((nlen == ((__sysconf_buffer[offset] & 0x0F) + 1)) && !memcmp(name, &__sysconf_buffer[offset + 1], nlen))
+			return &__sysconf_buffer[offset];
+	}
+	return NULL;
+}
+
+int __SYSCONF_GetLength(const char *name)
+{
+	u8 *entry;
+
+	if (!__sysconf_inited)
+		return SYSCONF_ENOTINIT;
+
+	entry = __SYSCONF_Find(name);
+	if (!entry)
+		return SYSCONF_ENOENT;
+
+	switch (*entry >> 5)
+	{
+	case 1:
+		return __SYSCONF_Load16(&entry[strlen(name) + 1]) + 1;
+	case 2:
+		return entry[strlen(name) + 1] + 1;
+	case 3:
+		return 1;
+	case 4:
+		return 2;
+	case 5:
+		return 4;
+	case 7:
+		return 1;
+	default:
+		return SYSCONF_ENOTIMPL;
+	}
+}
+
+s32 SYSCONF_GetLength(const char *name)
+{
+	u32 seq;
+	s32 ret;
+
+	do
+	{
+		seq = __SYSCONF_ReadBegin();
+		ret = __SYSCONF_GetLength(name);
+	} while (__SYSCONF_ReadRetry(seq));
+	return ret;
+}
+
+int __SYSCONF_GetType(const char *name)
+{
+	u8 *entry;
+	if (!__sysconf_inited)
+		return SYSCONF_ENOTINIT;
+
+	entry = __SYSCONF_Find(name);
+	if (!entry)
+		return SYSCONF_ENOENT;
+
+	return *entry >> 5;
+}
+
+s32 SYSCONF_GetType(const char *name)
+{
+	u32 seq;
+	s32 ret;
+
+	do
+	{
+		seq = __SYSCONF_ReadBegin();
+		ret = __SYSCONF_GetType(name);
+	} while (__SYSCONF_ReadRetry(seq));
+	return ret;
+}
+
+int __SYSCONF_Get(const char *name, void *buffer, u32 length)
+{
+	u8 *entry;
+	u16 value16;
+	u32 value32;
+	s32 len;
+	if (!__sysconf_inited)
+		return SYSCONF_ENOTINIT;
+
+	entry = __SYSCONF_Find(name);
+	if (!entry)
+		return SYSCONF_ENOENT;
+
+	len = __SYSCONF_GetLength(name);
+	if (len < 0)
+		return len;
+	if (len > length)
+		return SYSCONF_ETOOBIG;
+	if ((entry - __sysconf_buffer) + strlen(name) + 3 + len > 0x4000)
+		return SYSCONF_EBADFILE;
+
+	switch (*entry >> 5)
+	{
+	case SYSCONF_BIGARRAY:
+		memcpy(buffer, &entry[strlen(name) + 3], len);
+		break;
+	case SYSCONF_SMALLARRAY:
+		memcpy(buffer, &entry[strlen(name) + 2], len);
+		break;
+	case SYSCONF_BYTE:
+	case SYSCONF_BOOL:
+		memset(buffer, 0, length);
+		memcpy(buffer, &entry[strlen(name) + 1], len);
+		break;
+	case SYSCONF_SHORT:
+		memset(buffer, 0, length);
+		/* The caller's buffer needn't be aligned */
+		value16 = __SYSCONF_Load16(&entry[strlen(name) + 1]);
+		memcpy(buffer, &value16, sizeof(value16));
+		break;
+	case SYSCONF_LONG:
+		memset(buffer, 0, length);
+		value32 = __SYSCONF_Load32(&entry[strlen(name) + 1]);
+		memcpy(buffer, &value32, sizeof(value32));
+		break;
+	default:
+		return SYSCONF_ENOTIMPL;
 	}
-	return SYSCONF_ENOENT;
+	return len;
 }
 
-/* This function should NOT be used, and was only added for emergency recovery at one point */
-int __SYSCONF_AddTxt(const char *name, const char *value)
+s32 SYSCONF_Get(const char *name, void *buffer, u32 length)
 {
-	char *newline;
-	char *temp;
-	char endline[10];
-	u32 length;
+	u32 seq;
+	s32 ret;
+
+	do
+	{
+		seq = __SYSCONF_ReadBegin();
+		ret = __SYSCONF_Get(name, buffer, length);
+	} while (__SYSCONF_ReadRetry(seq));
+	return ret;
+}
+
+/* Numbers come in native order and are stored big-endian; arrays are copied as they are */
+void __SYSCONF_StoreValue(u8 *dest, u8 type, const void *value, u32 length)
+{
+	switch (type)
+	{
+	case SYSCONF_SHORT:
+		__SYSCONF_Store16(dest, *((const u16 *)value));
+		break;
+	case SYSCONF_LONG:
+		__SYSCONF_Store32(dest, *((const u32 *)value));
+		break;
+	default:
+		memcpy(dest, value, length);
+	}
+}
 
+int __SYSCONF_Set(const char *name, const void *value, u32 length)
+{
+	u8 *entry;
+	u8 type;
+	s32 len;
 	if (!__sysconf_inited)
 		return SYSCONF_ENOTINIT;
 
-	newline = strchr((char *)__sysconf_txt_buffer, 0);
-	if (newline == NULL || newline > __sysconf_txt_buffer + 0x100)
+	entry = __SYSCONF_Find(name);
+	if (!entry)
+		return SYSCONF_ENOENT;
+
+	len = __SYSCONF_GetLength(name);
+	if (len < 0)
+		return len;
+	if (length != len)
+		return SYSCONF_EBADVALUE;
+
+	type = *entry >> 5;
+	switch (type)
+	{
+	case SYSCONF_BIGARRAY:
+		entry += strlen(name) + 3;
+		break;
+	case SYSCONF_SMALLARRAY:
+		entry += strlen(name) + 2;
+		break;
+	case SYSCONF_BYTE:
+	case SYSCONF_SHORT:
+	case SYSCONF_LONG:
+	case SYSCONF_BOOL:
+		entry += strlen(name) + 1;
+		break;
+	default:
+		return SYSCONF_ENOTIMPL;
+	}
+	__SYSCONF_BeginWrite();
+	__SYSCONF_StoreValue(entry, type, value, len);
+	__SYSCONF_EndWrite();
+	__SYSCONF_MarkDirty(entry - __sysconf_buffer, entry - __sysconf_buffer + len);
+	return 0;
+}
+
+s32 SYSCONF_Set(const char *name, const void *value, u32 length)
+{
+	s32 ret;
+
+	__SYSCONF_Lock();
+	ret = __SYSCONF_Set(name, value, length);
+	__SYSCONF_Unlock();
+	return ret;
+}
+
+/* The payload of an array entry where it sits in the buffer, and its length */
+int __SYSCONF_FindArray(const char *name, u8 **data)
+{
+	u8 *entry;
+	u32 nlen = strlen(name), start;
+	s32 len;
+
+	if (!__sysconf_inited)
+		return SYSCONF_ENOTINIT;
+
+	entry = __SYSCONF_Find(name);
+	if (!entry)
+		return SYSCONF_ENOENT;
+
+	switch (*entry >> 5)
+	{
+	case SYSCONF_BIGARRAY:
+		len = __SYSCONF_Load16(&entry[nlen + 1]) + 1;
+		start = nlen + 3;
+		break;
+	case SYSCONF_SMALLARRAY:
+		len = entry[nlen + 1] + 1;
+		start = nlen + 2;
+		break;
+	default:
+		return SYSCONF_EBADVALUE;
+	}
+	if ((entry - __sysconf_buffer) + start + len > 0x4000)
 		return SYSCONF_EBADFILE;
 
-	newline--;
-	while (*--newline == '\r')
-		;
-	newline++;
+	*data = &entry[start];
+	return len;
+}
 
-	strcpy(endline, newline);
+/* The open write view, so releasing it knows what to mark dirty */
+SYSCONF_STATE u8 *__sysconf_write_view = NULL;
+SYSCONF_STATE u32 __sysconf_write_view_length = 0;
 
-	newline += strlen(endline);
+s32 SYSCONF_GetView(const char *name, const u8 **data)
+{
+	u8 *payload;
+	s32 ret;
 
-	length = strlen(name) + strlen(value) + strlen(endline) + 1;
+	__SYSCONF_Lock();
+	ret = __SYSCONF_FindArray(name, &payload);
+	if (ret < 0)
+	{
+		__SYSCONF_Unlock();
+		return ret;
+	}
 
-	if (newline + length < __sysconf_txt_buffer + 0x100)
+	*data = payload;
+	return ret;
+}
+
+void SYSCONF_ReleaseView(void)
+{
+	__SYSCONF_Unlock();
+}
+
+s32 SYSCONF_GetWriteView(const char *name, u8 **data)
+{
+	u8 *payload;
+	s32 ret;
+
+	__SYSCONF_Lock();
+	if (__sysconf_write_view)
 	{
-		temp = malloc(length + 1);
-		sprintf(temp, "%s=%s%s", name, value, endline);
-		strcpy(newline, temp);
+		__SYSCONF_Unlock();
+		return SYSCONF_EBADVALUE;
 	}
-	else
+
+	ret = __SYSCONF_FindArray(name, &payload);
+	if (ret < 0)
 	{
-		printf("Not worth it!");
+		__SYSCONF_Unlock();
+		return ret;
+	}
+
+	__SYSCONF_BeginWrite();
+	__sysconf_write_view = payload;
+	__sysconf_write_view_length = ret;
+	*data = payload;
+	return ret;
+}
+
+s32 SYSCONF_ReleaseWriteView(u32 offset, u32 length)
+{
+	u32 start;
+
+	/* The view comes with the writer lock, so only the thread that opened it can release it */
+	if (__atomic_load_n(&__sysconf_owner, __ATOMIC_RELAXED) != LWP_GetSelf())
+		return SYSCONF_EPERMS;
+	if (!__sysconf_write_view)
+		return SYSCONF_EBADVALUE;
+
+	/* A bad range still closes the view, with the whole payload marked */
+	if (offset > __sysconf_write_view_length || length > __sysconf_write_view_length - offset)
+	{
+		offset = 0;
+		length = __sysconf_write_view_length;
+	}
+
+	start = __sysconf_write_view - __sysconf_buffer;
+	__SYSCONF_EndWrite();
+	if (length)
+		__SYSCONF_MarkDirty(start + offset, start + offset + length);
+	__sysconf_write_view = NULL;
+	__SYSCONF_Unlock();
+	return SYSCONF_ERR_OK;
+}
+
+/*
+ * Layout engine. Entries sit back to back after the offset table, in table order,
+ * and the table ends with one extra offset marking the end of the data.
+ * Everything past that end up to the "SCed" footer at 0x3FFC is free space.
+ */
+
+/* Size of the entry at offset, header and name included */
+int __SYSCONF_EntrySize(u16 offset)
+{
+	u8 *entry = &__sysconf_buffer[offset];
+	int nlen = (*entry & 0x0F) + 1;
+
+	switch (*entry >> 5)
+	{
+	case SYSCONF_BIGARRAY:
+		return 1 + nlen + 2 + __SYSCONF_Load16(&entry[nlen + 1]) + 1;
+	case SYSCONF_SMALLARRAY:
+		return 1 + nlen + 1 + entry[nlen + 1] + 1;
+	case SYSCONF_BYTE:
+	case SYSCONF_BOOL:
+		return 1 + nlen + 1;
+	case SYSCONF_SHORT:
+		return 1 + nlen + 2;
+	case SYSCONF_LONG:
+		return 1 + nlen + 4;
+	default:
+		return SYSCONF_ENOTIMPL;
+	}
+}
+
+/* Checks the layout is what the engine expects and returns where the data ends */
+int __SYSCONF_DataEnd(void)
+{
+	u16 count = __SYSCONF_Count();
+	int i, size;
+	int end = 6 + (count + 1) * 2;
+
+	for (i = 0; i < count; i++)
+	{
+		if (__SYSCONF_Offset(i) != end)
+			return SYSCONF_EBADFILE;
+		size = __SYSCONF_EntrySize(end);
+		if (size < 0)
+			return size;
+		end += size;
+	}
+
+	if (__SYSCONF_Offset(count) != end || end > 0x3FFC)
 		return SYSCONF_EBADFILE;
+	return end;
+}
+
+/* Moves the bytes in [start, end) by delta and fixes up the offsets of entries that lived there */
+void __SYSCONF_MoveRange(int start, int end, int delta)
+{
+	u16 count = __SYSCONF_Count();
+	u16 offset;
+	int i;
+
+	if (start == end || !delta)
+		return;
+
+	memmove(&__sysconf_buffer[start + delta], &__sysconf_buffer[start], end - start);
+	for (i = 0; i < count; i++)
+	{
+		offset = __SYSCONF_Offset(i);
+		if (offset >= start && offset < end)
+			__SYSCONF_SetOffset(i, offset + delta);
 	}
 
-	return 0;
+	__SYSCONF_MarkDirty(delta < 0 ? start + delta : start, delta < 0 ? end : end + delta);
 }
 
-int __SYSCONF_SetTxt(const char *name, const char *value)
+int __SYSCONF_FindIndex(const char *name)
 {
-	char *line = __sysconf_txt_buffer;
-	char *delim, *end;
-	int slen;
+	u16 count = __SYSCONF_Count();
+	u16 offset;
 	int nlen = strlen(name);
-	int vlen = strlen(value);
+	int i;
+
+	for (i = 0; i < count; i++)
+	{
+		offset = __SYSCONF_Offset(i);
+		if ((nlen == ((__sysconf_buffer[offset] & 0x0F) + 1)) && !memcmp(name, &__sysconf_buffer[offset + 1], nlen))
+			return i;
+	}
+	return SYSCONF_ENOENT;
+}
+
+int __SYSCONF_Add(const char *name, u8 type, const void *value, u32 length)
+{
+	u16 count = __SYSCONF_Count();
+	int nlen = strlen(name);
+	int end, tableEnd, header, size;
+	u8 *entry;
 
 	if (!__sysconf_inited)
 		return SYSCONF_ENOTINIT;
+	if (__sysconf_partial)
+		return SYSCONF_EPARTIAL;
 
-	if (!__sysconf_buffer_txt_decrypted)
-		__SYSCONF_DecryptEncryptTextBuffer();
+	if (nlen < 1 || nlen > 16)
+		return SYSCONF_EBADVALUE;
+	if (__SYSCONF_FindIndex(name) >= 0)
+		return SYSCONF_EBADVALUE;
 
-	while (line < (__sysconf_txt_buffer + 0x100))
+	switch (type)
 	{
-		delim = strchr(line, '=');
-		if (delim && ((delim - line) == nlen) && !memcmp(name, line, nlen))
-		{
-			delim++;
-			end = strchr(line, '\r');
-			if (end)
-			{
-				slen = end - delim;
-				if (slen == vlen)
-				{
-					// printf("vlen: %u slen: %u\n", vlen, slen);
-					memcpy(delim, value, vlen);
-					__sysconf_txt_buffer_updated = 1;
-					return 0;
-				}
-				else if (vlen && (vlen < slen ||
-								  (strchr(end, '\n') + (vlen - slen)) < __sysconf_txt_buffer + 0x100))
-				{
-					// printf("vlen: %u slen: %u\n", vlen, slen);
-					if (__SYSCONF_ShiftTxt(end, vlen - slen))
-						return -1;
-					memcpy(delim, value, vlen);
-					__sysconf_txt_buffer_updated = 1;
-					return 0;
-				}
-				else
-				{
-					return SYSCONF_EBADVALUE;
-				}
-			}
-		}
+	case SYSCONF_BIGARRAY:
+		if (length < 1 || length > 0x10000)
+			return SYSCONF_EBADVALUE;
+		header = 2;
+		break;
+	case SYSCONF_SMALLARRAY:
+		if (length < 1 || length > 0x100)
+			return SYSCONF_EBADVALUE;
+		header = 1;
+		break;
+	case SYSCONF_BYTE:
+	case SYSCONF_BOOL:
+		if (length != 1)
+			return SYSCONF_EBADVALUE;
+		header = 0;
+		break;
+	case SYSCONF_SHORT:
+		if (length != 2)
+			return SYSCONF_EBADVALUE;
+		header = 0;
+		break;
+	case SYSCONF_LONG:
+		if (length != 4)
+			return SYSCONF_EBADVALUE;
+		header = 0;
+		break;
+	default:
+		return SYSCONF_ENOTIMPL;
+	}
 
-		// skip to line end
-		while (line < (__sysconf_txt_buffer + 0x100) && *line++ != '\n')
-			;
+	end = __SYSCONF_DataEnd();
+	if (end < 0)
+		return end;
+
+	size = 1 + nlen + header + length;
+	if (end + 2 + size > 0x3FFC)
+		return SYSCONF_ETOOBIG;
+
+	/* The table gains a slot, so all the data slides up two bytes and the new entry goes on the end */
+	tableEnd = 6 + (count + 1) * 2;
+	__SYSCONF_MoveRange(tableEnd, end, 2);
+	end += 2;
+
+	__SYSCONF_SetOffset(count, end);
+	__SYSCONF_SetOffset(count + 1, end + size);
+	__SYSCONF_Store16(&__sysconf_buffer[4], count + 1);
+
+	entry = &__sysconf_buffer[end];
+	*entry++ = (type << 5) | (nlen - 1);
+	memcpy(entry, name, nlen);
+	entry += nlen;
+	if (type == SYSCONF_BIGARRAY)
+	{
+		__SYSCONF_Store16(entry, length - 1);
+		entry += 2;
+	}
+	else if (type == SYSCONF_SMALLARRAY)
+	{
+		*entry++ = length - 1;
 	}
+	if (value)
+		__SYSCONF_StoreValue(entry, type, value, length);
+	else
+		memset(entry, 0, length);
 
-	return SYSCONF_ENOENT;
+	__SYSCONF_MarkDirty(4, tableEnd + 2);
+	__SYSCONF_MarkDirty(end, end + size);
+	return 0;
 }
 
-u8 *__SYSCONF_Find(const char *name)
+s32 SYSCONF_Add(const char *name, u8 type, const void *value, u32 length)
 {
-	u16 count;
-	u16 *offset;
-	int nlen = strlen(name);
-	count = *((u16 *)(&__sysconf_buffer[4]));
-	offset = (u16 *)&__sysconf_buffer[6];
+	s32 ret;
 
-	while (count--)
-	{
-		if ((nlen == ((__sysconf_buffer[*offset] & 0x0F) + 1)) && !memcmp(name, &__sysconf_buffer[*offset + 1], nlen))
-			return &__sysconf_buffer[*offset];
-		offset++;
-	}
-	return NULL;
+	__SYSCONF_Lock();
+	__SYSCONF_BeginWrite();
+	ret = __SYSCONF_Add(name, type, value, length);
+	__SYSCONF_EndWrite();
+	__SYSCONF_Unlock();
+	return ret;
 }
 
-s32 SYSCONF_GetLength(const char *name)
+int __SYSCONF_Resize(const char *name, u32 length)
 {
+	u16 count = __SYSCONF_Count();
+	int nlen = strlen(name);
+	int index, end, entryEnd, delta;
 	u8 *entry;
 
 	if (!__sysconf_inited)
 		return SYSCONF_ENOTINIT;
+	if (__sysconf_partial)
+		return SYSCONF_EPARTIAL;
 
-	entry = __SYSCONF_Find(name);
-	if (!entry)
-		return SYSCONF_ENOENT;
+	index = __SYSCONF_FindIndex(name);
+	if (index < 0)
+		return index;
 
+	end = __SYSCONF_DataEnd();
+	if (end < 0)
+		return end;
+
+	entry = &__sysconf_buffer[__SYSCONF_Offset(index)];
 	switch (*entry >> 5)
 	{
-	case 1:
-		return *((u16 *)&entry[strlen(name) + 1]) + 1;
-	case 2:
-		return entry[strlen(name) + 1] + 1;
-	case 3:
-		return 1;
-	case 4:
-		return 2;
-	case 5:
-		return 4;
-	case 7:
-		return 1;
+	case SYSCONF_BIGARRAY:
+		if (length < 1 || length > 0x10000)
+			return SYSCONF_EBADVALUE;
+		break;
+	case SYSCONF_SMALLARRAY:
+		if (length < 1 || length > 0x100)
+			return SYSCONF_EBADVALUE;
+		break;
 	default:
-		return SYSCONF_ENOTIMPL;
+		/* Only arrays have a length to change */
+		return SYSCONF_EBADVALUE;
 	}
+
+	entryEnd = (entry - __sysconf_buffer) + __SYSCONF_EntrySize(entry - __sysconf_buffer);
+	delta = length - __SYSCONF_GetLength(name);
+	if (!delta)
+		return 0;
+	if (end + delta > 0x3FFC)
+		return SYSCONF_ETOOBIG;
+
+	/* Everything after this entry slides along; grown space is zeroed, as is what a shrink leaves behind */
+	__SYSCONF_MoveRange(entryEnd, end, delta);
+	__SYSCONF_SetOffset(count, end + delta);
+	if (delta > 0)
+		memset(&__sysconf_buffer[entryEnd], 0, delta);
+	else
+		memset(&__sysconf_buffer[end + delta], 0, -delta);
+
+	if ((*entry >> 5) == SYSCONF_BIGARRAY)
+		__SYSCONF_Store16(&entry[nlen + 1], length - 1);
+	else
+		entry[nlen + 1] = length - 1;
+
+	__SYSCONF_MarkDirty(6 + count * 2, 6 + (count + 1) * 2);
+	__SYSCONF_MarkDirty(entry - __sysconf_buffer, delta > 0 ? entryEnd + delta : entryEnd);
+	return 0;
 }
 
-s32 SYSCONF_GetType(const char *name)
+s32 SYSCONF_Resize(const char *name, u32 length)
 {
-	u8 *entry;
+	s32 ret;
+
+	__SYSCONF_Lock();
+	__SYSCONF_BeginWrite();
+	ret = __SYSCONF_Resize(name, length);
+	__SYSCONF_EndWrite();
+	__SYSCONF_Unlock();
+	return ret;
+}
+
+int __SYSCONF_Remove(const char *name)
+{
+	u16 count = __SYSCONF_Count();
+	int index, end, tableEnd, start, size;
+
 	if (!__sysconf_inited)
 		return SYSCONF_ENOTINIT;
+	if (__sysconf_partial)
+		return SYSCONF_EPARTIAL;
+
+	index = __SYSCONF_FindIndex(name);
+	if (index < 0)
+		return index;
+
+	end = __SYSCONF_DataEnd();
+	if (end < 0)
+		return end;
+
+	tableEnd = 6 + (count + 1) * 2;
+	start = __SYSCONF_Offset(index);
+	size = __SYSCONF_EntrySize(start);
+
+	/* Drop the slot from the table, then close both gaps: the data before the entry moves down by
+	   the slot, the data after it by the slot and the entry, so each byte moves at most once */
+	memmove(&__sysconf_buffer[6 + index * 2], &__sysconf_buffer[6 + (index + 1) * 2], (count - index) * 2);
+	__SYSCONF_Store16(&__sysconf_buffer[4], --count);
+	__SYSCONF_MoveRange(tableEnd, start, -2);
+	__SYSCONF_MoveRange(start + size, end, -2 - size);
+	__SYSCONF_SetOffset(count, end - 2 - size);
+	memset(&__sysconf_buffer[end - 2 - size], 0, 2 + size);
+
+	__SYSCONF_MarkDirty(4, end);
+	return 0;
+}
 
-	entry = __SYSCONF_Find(name);
-	if (!entry)
-		return SYSCONF_ENOENT;
+s32 SYSCONF_Remove(const char *name)
+{
+	s32 ret;
 
-	return *entry >> 5;
+	__SYSCONF_Lock();
+	__SYSCONF_BeginWrite();
+	ret = __SYSCONF_Remove(name);
+	__SYSCONF_EndWrite();
+	__SYSCONF_Unlock();
+	return ret;
 }
 
-s32 SYSCONF_Get(const char *name, void *buffer, u32 length)
+/*
+ * Deltas, see sysconf.h for the format. Records name their entries, so a delta made from one
+ * console's images applies to any other whatever its layout, as long as every guard holds.
+ */
+#define SYSCONF_DELTA_HEADER 14
+
+typedef struct _sysconf_delta_record
 {
-	u8 *entry;
+	u8 op;
+	u8 type;
+	char name[17];
+	const u8 *old;
+	u16 old_length;
+	const u8 *value;
+	u16 value_length;
+} sysconf_delta_record;
+
+/* Any entry's payload as it is stored, numbers big-endian, and its length */
+int __SYSCONF_FindValue(const char *name, u8 **data, u8 *type)
+{
+	u8 *entry = __SYSCONF_Find(name);
+	u32 start = strlen(name) + 1;
 	s32 len;
-	if (!__sysconf_inited)
-		return SYSCONF_ENOTINIT;
 
-	entry = __SYSCONF_Find(name);
 	if (!entry)
 		return SYSCONF_ENOENT;
 
-	len = SYSCONF_GetLength(name);
+	len = __SYSCONF_GetLength(name);
 	if (len < 0)
 		return len;
-	if (len > length)
-		return SYSCONF_ETOOBIG;
 
-	switch (*entry >> 5)
+	*type = *entry >> 5;
+	if (*type == SYSCONF_BIGARRAY)
+		start += 2;
+	else if (*type == SYSCONF_SMALLARRAY)
+		start++;
+	if ((entry - __sysconf_buffer) + start + len > 0x4000)
+		return SYSCONF_EBADFILE;
+
+	*data = &entry[start];
+	return len;
+}
+
+/* Reads the record at pos and returns where the next one starts */
+int __SYSCONF_DeltaRecord(const u8 *delta, u32 length, u32 pos, sysconf_delta_record *record)
+{
+	u32 nlen;
+
+	if (pos + 3 > length)
+		return SYSCONF_EBADDELTA;
+	record->op = delta[pos];
+	record->type = delta[pos + 1];
+	nlen = delta[pos + 2];
+	pos += 3;
+
+	if (nlen < 1 || nlen > 16 || pos + nlen + 2 > length)
+		return SYSCONF_EBADDELTA;
+	memcpy(record->name, &delta[pos], nlen);
+	record->name[nlen] = '\0';
+	pos += nlen;
+	if (strlen(record->name) != nlen)
+		return SYSCONF_EBADDELTA;
+
+	record->old_length = __SYSCONF_Load16(&delta[pos]);
+	record->old = &delta[pos + 2];
+	pos += 2 + record->old_length;
+	if (pos + 2 > length)
+		return SYSCONF_EBADDELTA;
+
+	record->value_length = __SYSCONF_Load16(&delta[pos]);
+	record->value = &delta[pos + 2];
+	pos += 2 + record->value_length;
+	if (pos > length)
+		return SYSCONF_EBADDELTA;
+
+	/* No entry is empty, so a length of 0 is a side the operation doesn't have */
+	switch (record->op)
 	{
-	case SYSCONF_BIGARRAY:
-		memcpy(buffer, &entry[strlen(name) + 3], len);
+	case SYSCONF_DELTA_SET:
+		if (!record->old_length || !record->value_length)
+			return SYSCONF_EBADDELTA;
 		break;
-	case SYSCONF_SMALLARRAY:
-		memcpy(buffer, &entry[strlen(name) + 2], len);
+	case SYSCONF_DELTA_ADD:
+		if (record->old_length || !record->value_length)
+			return SYSCONF_EBADDELTA;
 		break;
-	case SYSCONF_BYTE:
-	case SYSCONF_SHORT:
-	case SYSCONF_LONG:
-	case SYSCONF_BOOL:
-		memset(buffer, 0, length);
-		memcpy(buffer, &entry[strlen(name) + 1], len);
+	case SYSCONF_DELTA_REMOVE:
+		if (!record->old_length || record->value_length)
+			return SYSCONF_EBADDELTA;
 		break;
 	default:
-		return SYSCONF_ENOTIMPL;
+		return SYSCONF_EBADDELTA;
 	}
-	return len;
+	return pos;
 }
 
-s32 SYSCONF_Set(const char *name, const void *value, u32 length)
+int __SYSCONF_ApplyDeltaRecord(const sysconf_delta_record *record)
 {
-	u8 *entry;
-	s32 len;
-	if (!__sysconf_inited)
-		return SYSCONF_ENOTINIT;
+	u8 *data;
+	u8 type;
+	int len, ret = 0;
 
-	entry = __SYSCONF_Find(name);
-	if (!entry)
-		return SYSCONF_ENOENT;
+	len = __SYSCONF_FindValue(record->name, &data, &type);
+	if (len < 0 && len != SYSCONF_ENOENT)
+		return len;
+
+	/* The guard: the entry has to be just as it was in the image the delta was made from */
+	if (record->op == SYSCONF_DELTA_ADD)
+	{
+		if (len >= 0)
+			return SYSCONF_EGUARD;
+		ret = __SYSCONF_Add(record->name, record->type, NULL, record->value_length);
+	}
+	else
+	{
+		if (len < 0 || type != record->type || len != record->old_length || memcmp(data, record->old, len))
+			return SYSCONF_EGUARD;
+		if (record->op == SYSCONF_DELTA_REMOVE)
+			return __SYSCONF_Remove(record->name);
+		if (record->value_length != len)
+			ret = __SYSCONF_Resize(record->name, record->value_length);
+	}
+	if (ret < 0)
+		return ret;
 
-	len = SYSCONF_GetLength(name);
+	/* Adding and resizing move entries about, so look it up again */
+	len = __SYSCONF_FindValue(record->name, &data, &type);
 	if (len < 0)
 		return len;
-	if (length != len)
-		return SYSCONF_EBADVALUE;
+	if (len != record->value_length)
+		return SYSCONF_EBADDELTA;
 
-	switch (*entry >> 5)
+	memcpy(data, record->value, len);
+	__SYSCONF_MarkDirty(data - __sysconf_buffer, data - __sysconf_buffer + len);
+	return 0;
+}
+
+/* Hashes what the entries a delta names hold now, the way the generator hashed what they should */
+int __SYSCONF_DeltaResult(const u8 *delta, u32 length, u32 count, u32 *hash)
+{
+	sysconf_delta_record record;
+	u32 i, pos = SYSCONF_DELTA_HEADER;
+	u8 *data;
+	u8 type;
+	int ret, len;
+
+	*hash = 0x811C9DC5;
+	for (i = 0; i < count; i++)
 	{
-	case SYSCONF_BIGARRAY:
-		memcpy(&entry[strlen(name) + 3], value, len);
-		break;
-	case SYSCONF_SMALLARRAY:
-		memcpy(&entry[strlen(name) + 2], value, len);
-		break;
-	case SYSCONF_BYTE:
-	case SYSCONF_SHORT:
-	case SYSCONF_LONG:
-	case SYSCONF_BOOL:
-		// memset(buffer, 0, length);
-		memcpy(&entry[strlen(name) + 1], value, len);
-		break;
-	default:
-		return SYSCONF_ENOTIMPL;
+		ret = __SYSCONF_DeltaRecord(delta, length, pos, &record);
+		if (ret < 0)
+			return ret;
+		pos = ret;
+
+		*hash = __SYSCONF_HashMore(*hash, record.name, strlen(record.name));
+		len = __SYSCONF_FindValue(record.name, &data, &type);
+		if (record.op == SYSCONF_DELTA_REMOVE)
+		{
+			if (len != SYSCONF_ENOENT)
+				return SYSCONF_EBADDELTA;
+			continue;
+		}
+		if (len < 0)
+			return len;
+		*hash = __SYSCONF_HashMore(*hash, &type, 1);
+		*hash = __SYSCONF_HashMore(*hash, data, len);
 	}
-	__sysconf_buffer_updated = 1;
 	return 0;
 }
 
+s32 SYSCONF_ApplyDelta(const void *delta, u32 length)
+{
+	const u8 *p = delta;
+	sysconf_delta_record record;
+	sysconf_snapshot *snapshot;
+	u32 count, i, pos = SYSCONF_DELTA_HEADER, hash;
+	int ret = 0;
+
+	if (!__sysconf_inited)
+		return SYSCONF_ENOTINIT;
+	if (__sysconf_partial)
+		return SYSCONF_EPARTIAL;
+
+	/* Before anything changes: the records are whole, as the generator wrote them */
+	if (length < SYSCONF_DELTA_HEADER || memcmp(p, "SCdl", 4))
+		return SYSCONF_EBADDELTA;
+	count = __SYSCONF_Load16(&p[4]);
+	if (__SYSCONF_Hash(&p[SYSCONF_DELTA_HEADER], length - SYSCONF_DELTA_HEADER) != __SYSCONF_Load32(&p[6]))
+		return SYSCONF_EBADDELTA;
+
+	__SYSCONF_Lock();
+	snapshot = __SYSCONF_TakeSnapshot();
+	if (!snapshot)
+	{
+		__SYSCONF_Unlock();
+		return SYSCONF_ENOMEM;
+	}
+
+	/* One pass: each record is checked against its guard and applied, and the first that fails
+	   puts everything back */
+	__SYSCONF_BeginWrite();
+	for (i = 0; i < count && ret >= 0; i++)
+	{
+		ret = __SYSCONF_DeltaRecord(p, length, pos, &record);
+		if (ret < 0)
+			break;
+		pos = ret;
+		ret = __SYSCONF_ApplyDeltaRecord(&record);
+	}
+	if (ret >= 0 && pos != length)
+		ret = SYSCONF_EBADDELTA;
+
+	/* After: the entries hold exactly what the delta was meant to leave in them */
+	if (ret >= 0)
+		ret = __SYSCONF_DeltaResult(p, length, count, &hash);
+	if (ret >= 0 && hash != __SYSCONF_Load32(&p[10]))
+		ret = SYSCONF_EBADDELTA;
+
+	if (ret < 0)
+		__SYSCONF_RestoreSnapshot(snapshot);
+	else
+		free(snapshot);
+	__SYSCONF_EndWrite();
+	__SYSCONF_Unlock();
+	return ret < 0 ? ret : count;
+}
+
 s32 SYSCONF_GetShutdownMode(void)
 {
 	u8 idlesysconf[2] = {0, 0};
@@ -740,44 +3114,61 @@ s32 SYSCONF_GetDisplayOffsetH(s8 *offset)
 	return 0;
 }
 
+/* The array getters copy straight out of the buffer, retrying if a set moved it meanwhile */
 s32 SYSCONF_GetPadDevices(sysconf_pad_device *devs, int count)
 {
+	u8 *data;
+	u32 seq;
 	int res;
-	u8 buf[0x461];
-
-	res = SYSCONF_Get("BT.DINF", buf, 0x461);
-	if (res < 0)
-		return res;
-	if ((res < 1) || (buf[0] > 0x10))
-		return SYSCONF_EBADVALUE;
 
-	if (count && devs)
+	do
 	{
-		memset(devs, 0, count * sizeof(sysconf_pad_device));
-		if (count < buf[0])
-			memcpy(devs, &buf[1], count * sizeof(sysconf_pad_device));
-		else
-			memcpy(devs, &buf[1], buf[0] * sizeof(sysconf_pad_device));
-	}
+		seq = __SYSCONF_ReadBegin();
+		res = __SYSCONF_FindArray("BT.DINF", &data);
+		if (res < 0)
+			continue;
+		if ((res < 1) || (data[0] > 0x10) || (1 + data[0] * sizeof(sysconf_pad_device) > res))
+		{
+			res = SYSCONF_EBADVALUE;
+			continue;
+		}
+
+		if (count && devs)
+		{
+			memset(devs, 0, count * sizeof(sysconf_pad_device));
+			if (count < data[0])
+				memcpy(devs, &data[1], count * sizeof(sysconf_pad_device));
+			else
+				memcpy(devs, &data[1], data[0] * sizeof(sysconf_pad_device));
+		}
+		res = data[0];
+	} while (__SYSCONF_ReadRetry(seq));
 
-	res = buf[0];
 	return res;
 }
 
 s32 SYSCONF_GetNickName(u8 *nickname)
 {
 	int i, res;
-	u16 buf[11];
+	u8 *data;
+	u32 seq;
 
-	res = SYSCONF_Get("IPL.NIK", buf, 0x16);
-	if (res < 0)
-		return res;
-	if ((res != 0x16) || (!buf[0]))
-		return SYSCONF_EBADVALUE;
+	do
+	{
+		seq = __SYSCONF_ReadBegin();
+		res = __SYSCONF_FindArray("IPL.NIK", &data);
+		if (res < 0)
+			continue;
+		if ((res != 0x16) || (!__SYSCONF_Load16(data)))
+		{
+			res = SYSCONF_EBADVALUE;
+			continue;
+		}
 
-	for (i = 0; i < 10; i++)
-		nickname[i] = buf[i];
-	nickname[10] = 0;
+		for (i = 0; i < 10; i++)
+			nickname[i] = __SYSCONF_Load16(&data[i * 2]);
+		nickname[10] = 0;
+	} while (__SYSCONF_ReadRetry(seq));
 
 	return res;
 }
@@ -808,38 +3199,40 @@ s32 SYSCONF_GetEULA(void)
 	return val;
 }
 
-s32 SYSCONF_GetParentalPassword(s8 *password)
+/* IPL.PC holds the 4-digit password at 3 and the secret answer at 8 */
+int __SYSCONF_GetParental(void *out, u32 offset, u32 length)
 {
+	u8 *data;
+	u32 seq;
 	int res;
-	u8 buf[0x4A];
 
-	res = SYSCONF_Get("IPL.PC", buf, 0x4A);
-	if (res < 0)
-		return res;
-	if (res != 1)
-		return SYSCONF_EBADVALUE;
+	do
+	{
+		seq = __SYSCONF_ReadBegin();
+		res = __SYSCONF_FindArray("IPL.PC", &data);
+		if (res < 0)
+			continue;
+		if (res != 0x4A)
+		{
+			res = SYSCONF_EBADVALUE;
+			continue;
+		}
 
-	memcpy(password, buf + 3, 4);
-	password[4] = 0;
+		memcpy(out, data + offset, length);
+		((u8 *)out)[length] = 0;
+	} while (__SYSCONF_ReadRetry(seq));
 
 	return res;
 }
 
-s32 SYSCONF_GetParentalAnswer(s8 *answer)
+s32 SYSCONF_GetParentalPassword(s8 *password)
 {
-	int res;
-	u8 buf[0x4A];
-
-	res = SYSCONF_Get("IPL.PC", buf, 0x4A);
-	if (res < 0)
-		return res;
-	if (res != 1)
-		return SYSCONF_EBADVALUE;
-
-	memcpy(answer, buf + 8, 32);
-	answer[32] = 0;
+	return __SYSCONF_GetParental(password, 3, 4);
+}
 
-	return res;
+s32 SYSCONF_GetParentalAnswer(s8 *answer)
+{
+	return __SYSCONF_GetParental(answer, 8, 32);
 }
 
 s32 SYSCONF_GetWiiConnect24(void)
@@ -860,7 +3253,7 @@ s32 SYSCONF_GetRegion(void)
 	int res;
 	char buf[3];
 
-	res = __SYSCONF_GetTxt("GAME", buf, 3);
+	res = SYSCONF_GetTxt("GAME", buf, 3);
 	if (res < 0)
 		return res;
 	if (!strcmp(buf, "JP"))
@@ -881,7 +3274,7 @@ s32 SYSCONF_GetArea(void)
 	int res;
 	char buf[4];
 
-	res = __SYSCONF_GetTxt("AREA", buf, 4);
+	res = SYSCONF_GetTxt("AREA", buf, 4);
 	if (res < 0)
 		return res;
 	if (!strcmp(buf, "JPN"))
@@ -916,7 +3309,7 @@ s32 SYSCONF_GetVideo(void)
 	int res;
 	char buf[5];
 
-	res = __SYSCONF_GetTxt("VIDEO", buf, 5);
+	res = SYSCONF_GetTxt("VIDEO", buf, 5);
 	if (res < 0)
 		return res;
 	if (!strcmp(buf, "NTSC"))
@@ -928,34 +3321,33 @@ s32 SYSCONF_GetVideo(void)
 	return SYSCONF_EBADVALUE;
 }
 
-s32 SYSCONF_SetShutdownMode(u8 value)
+/* IPL.IDL holds both idle settings, so each is changed in place with the other left as it is */
+static s32 __SYSCONF_SetIdle(u32 offset, u8 value)
 {
-	u8 idlesysconf[2] = {0, 0};
+	u8 *data;
 	int res;
-	res = SYSCONF_Get("IPL.IDL", idlesysconf, 2);
+
+	res = SYSCONF_GetWriteView("IPL.IDL", &data);
 	if (res < 0)
 		return res;
 	if (res != 2)
+	{
+		SYSCONF_ReleaseWriteView(0, 0);
 		return SYSCONF_EBADVALUE;
+	}
 
-	idlesysconf[0] = value;
+	data[offset] = value;
+	return SYSCONF_ReleaseWriteView(offset, 1);
+}
 
-	return SYSCONF_Set("IPL.IDL", idlesysconf, 2);
+s32 SYSCONF_SetShutdownMode(u8 value)
+{
+	return __SYSCONF_SetIdle(0, value);
 }
 
 s32 SYSCONF_SetIdleLedMode(u8 value)
 {
-	u8 idlesysconf[2] = {0, 0};
-	int res;
-	res = SYSCONF_Get("IPL.IDL", idlesysconf, 2);
-	if (res < 0)
-		return res;
-	if (res != 2)
-		return SYSCONF_EBADVALUE;
-
-	idlesysconf[1] = value;
-
-	return SYSCONF_Set("IPL.IDL", idlesysconf, 2);
+	return __SYSCONF_SetIdle(1, value);
 }
 
 s32 SYSCONF_SetProgressiveScan(u8 value)
@@ -1013,32 +3405,55 @@ s32 SYSCONF_SetDisplayOffsetH(s8 offset)
 	return SYSCONF_Set("IPL.DH", &offset, 1);
 }
 
+/* The array setters write in place through a write view, and only mark what they change */
 s32 SYSCONF_SetPadDevices(const sysconf_pad_device *devs, u8 count)
 {
-	u8 buf[0x461] = {0};
+	u8 *data;
+	int res;
 
 	if (count > 0x10)
 		return SYSCONF_EBADVALUE;
-	buf[0] = count;
 
+	res = SYSCONF_GetWriteView("BT.DINF", &data);
+	if (res < 0)
+		return res;
+	if (res != 0x461)
+	{
+		SYSCONF_ReleaseWriteView(0, 0);
+		return SYSCONF_EBADVALUE;
+	}
+
+	memset(data, 0, 0x461);
+	data[0] = count;
 	if (devs)
-		memcpy(&buf[1], devs, count * sizeof(sysconf_pad_device));
+		memcpy(&data[1], devs, count * sizeof(sysconf_pad_device));
 
-	return SYSCONF_Set("BT.DINF", buf, 0x461);
+	return SYSCONF_ReleaseWriteView(0, 0x461);
 }
 
 s32 SYSCONF_SetNickName(const u8 *nickname, u16 length)
 {
-	int i;
-	u16 buf[11] = {0};
+	int i, res;
+	u8 *data;
+
 	if (length > 10)
 		return SYSCONF_EBADVALUE;
 
+	res = SYSCONF_GetWriteView("IPL.NIK", &data);
+	if (res < 0)
+		return res;
+	if (res != 0x16)
+	{
+		SYSCONF_ReleaseWriteView(0, 0);
+		return SYSCONF_EBADVALUE;
+	}
+
+	memset(data, 0, 0x16);
 	for (i = 0; i < length; i++)
-		buf[i] = nickname[i];
-	buf[10] = length;
+		__SYSCONF_Store16(&data[i * 2], nickname[i]);
+	__SYSCONF_Store16(&data[20], length);
 
-	return SYSCONF_Set("IPL.NIK", buf, 0x16);
+	return SYSCONF_ReleaseWriteView(0, 0x16);
 }
 
 s32 SYSCONF_SetAspectRatio(u8 value)
@@ -1053,40 +3468,36 @@ s32 SYSCONF_SetEULA(u8 value)
 	return SYSCONF_Set("IPL.EULA", &value, 1);
 }
 
-s32 SYSCONF_SetParentalPassword(const s8 *password, u32 length)
+int __SYSCONF_SetParental(const void *value, u32 offset, u32 length)
 {
+	u8 *data;
 	int res;
-	u8 buf[0x4A] = {0};
-	if (length != 4)
-		return SYSCONF_EBADVALUE;
 
-	res = SYSCONF_Get("IPL.PC", buf, 0x4A);
+	res = SYSCONF_GetWriteView("IPL.PC", &data);
 	if (res < 0)
 		return res;
-	if (res != 1)
+	if (res != 0x4A)
+	{
+		SYSCONF_ReleaseWriteView(0, 0);
 		return SYSCONF_EBADVALUE;
+	}
 
-	memcpy(buf + 3, password, 4);
+	memcpy(data + offset, value, length);
+	return SYSCONF_ReleaseWriteView(offset, length);
+}
 
-	return SYSCONF_Set("IPL.PC", buf, 0x4A);
+s32 SYSCONF_SetParentalPassword(const s8 *password, u32 length)
+{
+	if (length != 4)
+		return SYSCONF_EBADVALUE;
+	return __SYSCONF_SetParental(password, 3, 4);
 }
 
 s32 SYSCONF_SetParentalAnswer(const s8 *answer, u32 length)
 {
-	int res;
-	u8 buf[0x4A] = {0};
 	if (length != 32)
 		return SYSCONF_EBADVALUE;
-
-	res = SYSCONF_Get("IPL.PC", buf, 0x4A);
-	if (res < 0)
-		return res;
-	if (res != 1)
-		return SYSCONF_EBADVALUE;
-
-	memcpy(buf + 8, answer, length);
-
-	return SYSCONF_Set("IPL.PC", buf, 0x4A);
+	return __SYSCONF_SetParental(answer, 8, 32);
 }
 
 s32 SYSCONF_SetWiiConnect24(u32 value)
@@ -1099,15 +3510,15 @@ s32 SYSCONF_SetRegion(s32 value)
 	switch (value)
 	{
 	case SYSCONF_REGION_JP:
-		return __SYSCONF_SetTxt("GAME", "JP");
+		return SYSCONF_SetTxt("GAME", "JP");
 	case SYSCONF_REGION_US:
-		return __SYSCONF_SetTxt("GAME", "US");
+		return SYSCONF_SetTxt("GAME", "US");
 	case SYSCONF_REGION_EU:
-		return __SYSCONF_SetTxt("GAME", "EU");
+		return SYSCONF_SetTxt("GAME", "EU");
 	case SYSCONF_REGION_KR:
-		return __SYSCONF_SetTxt("GAME", "KR");
+		return SYSCONF_SetTxt("GAME", "KR");
 	case SYSCONF_REGION_CN:
-		return __SYSCONF_SetTxt("GAME", "CN");
+		return SYSCONF_SetTxt("GAME", "CN");
 	default:
 		return SYSCONF_EBADVALUE;
 	}
@@ -1118,40 +3529,40 @@ s32 SYSCONF_SetArea(s32 value)
 	switch (value)
 	{
 	case SYSCONF_AREA_JPN:
-		return __SYSCONF_SetTxt("AREA", "JPN");
+		return SYSCONF_SetTxt("AREA", "JPN");
 		break;
 	case SYSCONF_AREA_USA:
-		return __SYSCONF_SetTxt("AREA", "USA");
+		return SYSCONF_SetTxt("AREA", "USA");
 		break;
 	case SYSCONF_AREA_EUR:
-		return __SYSCONF_SetTxt("AREA", "EUR");
+		return SYSCONF_SetTxt("AREA", "EUR");
 		break;
 	case SYSCONF_AREA_AUS:
-		return __SYSCONF_SetTxt("AREA", "AUS");
+		return SYSCONF_SetTxt("AREA", "AUS");
 		break;
 	case SYSCONF_AREA_BRA:
-		return __SYSCONF_SetTxt("AREA", "BRA");
+		return SYSCONF_SetTxt("AREA", "BRA");
 		break;
 	case SYSCONF_AREA_TWN:
-		return __SYSCONF_SetTxt("AREA", "TWN");
+		return SYSCONF_SetTxt("AREA", "TWN");
 		break;
 	case SYSCONF_AREA_ROC:
-		return __SYSCONF_SetTxt("AREA", "ROC");
+		return SYSCONF_SetTxt("AREA", "ROC");
 		break;
 	case SYSCONF_AREA_KOR:
-		return __SYSCONF_SetTxt("AREA", "KOR");
+		return SYSCONF_SetTxt("AREA", "KOR");
 		break;
 	case SYSCONF_AREA_HKG:
-		return __SYSCONF_SetTxt("AREA", "HKG");
+		return SYSCONF_SetTxt("AREA", "HKG");
 		break;
 	case SYSCONF_AREA_ASI:
-		return __SYSCONF_SetTxt("AREA", "ASI");
+		return SYSCONF_SetTxt("AREA", "ASI");
 		break;
 	case SYSCONF_AREA_LTN:
-		return __SYSCONF_SetTxt("AREA", "LTN");
+		return SYSCONF_SetTxt("AREA", "LTN");
 		break;
 	case SYSCONF_AREA_SAF:
-		return __SYSCONF_SetTxt("AREA", "SAF");
+		return SYSCONF_SetTxt("AREA", "SAF");
 		break;
 	default:
 		return SYSCONF_EBADVALUE;
@@ -1163,13 +3574,13 @@ s32 SYSCONF_SetVideo(s32 value)
 	switch (value)
 	{
 	case SYSCONF_VIDEO_NTSC:
-		return __SYSCONF_SetTxt("VIDEO", "NTSC");
+		return SYSCONF_SetTxt("VIDEO", "NTSC");
 		break;
 	case SYSCONF_VIDEO_PAL:
-		return __SYSCONF_SetTxt("VIDEO", "PAL");
+		return SYSCONF_SetTxt("VIDEO", "PAL");
 		break;
 	case SYSCONF_VIDEO_MPAL:
-		return __SYSCONF_SetTxt("VIDEO", "MPAL");
+		return SYSCONF_SetTxt("VIDEO", "MPAL");
 		break;
 	default:
 		return SYSCONF_EBADVALUE;
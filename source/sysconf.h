@@ -33,6 +33,7 @@ distribution.
 
 #if defined(HW_RVL)
 
+#include <stdio.h>
 #include <gctypes.h>
 #include <gcutil.h>
 
@@ -45,7 +46,15 @@ distribution.
 #define SYSCONF_ENOMEM -0x6007
 #define SYSCONF_EPERMS -0x6008
 #define SYSCONF_EBADWRITE -0x6009
+#define SYSCONF_EMODIFIED -0x600A
+#define SYSCONF_EBADDELTA -0x600B
+#define SYSCONF_EGUARD -0x600C
+#define SYSCONF_EPARTIAL -0x600D
+#define SYSCONF_ECOMMITTED -0x600E
 #define SYSCONF_ERR_OK 0
+#define SYSCONF_SAVE_BUSY 1
+
+#define SYSCONF_PARTIAL_MAX 8 /* Entries SYSCONF_InitPartial loads at most */
 
 //#define DEBUG_SYSCONF
 
@@ -64,6 +73,13 @@ extern "C"
 		SYSCONF_BOOL = 7
 	};
 
+	enum
+	{
+		SYSCONF_DELTA_SET = 0,
+		SYSCONF_DELTA_ADD,
+		SYSCONF_DELTA_REMOVE
+	};
+
 	enum
 	{
 		SYSCONF_VIDEO_NTSC = 0,
@@ -147,6 +163,34 @@ extern "C"
 		char name[0x40];
 	} ATTRIBUTE_PACKED;
 
+	typedef void (*sysconf_save_cb)(s32 result, void *usrdata);
+
+	/* One SYSCONF entry as the iterator hands it out; name and data point into the image */
+	typedef struct _sysconf_entry
+	{
+		const char *name; /* Not NUL-terminated */
+		u8 name_length;
+		u8 type;
+		const u8 *data;
+		u16 length;
+		u16 offset; /* Where the entry starts in the image */
+	} sysconf_entry;
+
+	typedef struct _sysconf_iter
+	{
+		const u8 *image; /* The copy of SYSCONF being walked */
+		u16 index;
+		u16 count;
+	} sysconf_iter;
+
+	typedef struct _sysconf_buffer
+	{
+		const char *name;
+		const void *data;
+		u32 size;
+		BOOL heap; /* malloc'd rather than static */
+	} sysconf_buffer;
+
 #ifdef DEBUG_SYSCONF
 	void SYSCONF_DumpBuffer(void);
 	void SYSCONF_DumpTxtBuffer(void);
@@ -154,11 +198,47 @@ extern "C"
 	void SYSCONF_PrintAllSettings(void);
 #endif /* DEBUG_SYSCONF */
 
+	/* Any thread may call these once Init has returned: gets never lock, sets and saves take turns */
 	s32 SYSCONF_Init(void);
+	/* SYSCONF_Init in two halves: Begin sends the reads of both files to IOS and returns,
+	   Finish waits for them. Anything done in between overlaps the NAND access. */
+	s32 SYSCONF_InitBegin(void);
+	s32 SYSCONF_InitFinish(void);
+	/* Loads only SYSCONF's header, its offset table and the named entries, with seeks and small reads
+	   instead of the whole file, and no setting.txt. Gets and sets of those entries work as usual and a
+	   save writes each one back in place. Anything that needs the rest (other entries read as missing;
+	   setting.txt, layout changes, deltas, iteration and exports return SYSCONF_EPARTIAL) needs SYSCONF_Init. */
+	s32 SYSCONF_InitPartial(const char *const *names, u32 count);
+	/* Work on images already in memory (0x4000 bytes of SYSCONF, 0x100 of encrypted setting.txt), either may be NULL */
+	s32 SYSCONF_InitFromMemory(const void *sysconf, const void *txt);
+	s32 SYSCONF_ExportToMemory(void *sysconf, void *txt);
+	void SYSCONF_DumpSettings(FILE *fp);
+	/* Walk every entry in one pass over the offset table. Next returns 1 for each entry, then 0 at the end.
+	   Begin copies SYSCONF to the heap and takes no lock, so sets carry on during the walk and it sees
+	   none of them; entries point into the copy, which End frees. */
+	s32 SYSCONF_IterBegin(sysconf_iter *iter);
+	s32 SYSCONF_IterNext(sysconf_iter *iter, sysconf_entry *entry);
+	void SYSCONF_IterEnd(sysconf_iter *iter);
+	/* Every SYSCONF entry and setting.txt line, as one JSON object with no line break, or in the packed form
+	   ("SCpk", entry count, the entries as stored in SYSCONF, setting.txt length and text).
+	   Both return the number of SYSCONF entries written. */
+	s32 SYSCONF_ExportJSON(FILE *fp);
+	s32 SYSCONF_ExportPacked(FILE *fp);
+	/* The memory sysconf.c holds right now, for footprint reports. Fills in up to count and returns how many there are. */
+	s32 SYSCONF_GetBuffers(sysconf_buffer *buffers, u32 count);
 	/* SYSCONF configuation */
 	s32 SYSCONF_GetLength(const char *name);
 	s32 SYSCONF_GetType(const char *name);
 	s32 SYSCONF_Get(const char *name, void *buffer, u32 length);
+	/* Array entries (BT.DINF, IPL.NIK) in place: a pointer to the payload in the loaded image and its length.
+	   Sets wait until the view is released. A write view is changed in place; releasing it marks the
+	   offset and length of the payload that changed for saving. Gets on other threads wait for the
+	   release, while gets on the thread holding the view see its changes so far. Open only one at a time.
+	   Only the thread that opened a write view can release it; any other gets SYSCONF_EPERMS. */
+	s32 SYSCONF_GetView(const char *name, const u8 **data);
+	void SYSCONF_ReleaseView(void);
+	s32 SYSCONF_GetWriteView(const char *name, u8 **data);
+	s32 SYSCONF_ReleaseWriteView(u32 offset, u32 length);
 	s32 SYSCONF_GetShutdownMode(void);
 	s32 SYSCONF_GetIdleLedMode(void);
 	s32 SYSCONF_GetProgressiveScan(void);
@@ -180,13 +260,58 @@ extern "C"
 	s32 SYSCONF_GetParentalAnswer(s8 *answer);
 	s32 SYSCONF_GetWiiConnect24(void);
 	/* setting.txt configuration */
+	s32 SYSCONF_GetTxt(const char *name, char *buffer, u32 length);
+	/* The whole of setting.txt as plain text, at most 0x100 bytes */
+	s32 SYSCONF_GetTxtPlain(char *buffer, u32 length);
 	s32 SYSCONF_GetRegion(void);
 	s32 SYSCONF_GetArea(void);
 	s32 SYSCONF_GetVideo(void);
 
 	/* Set functions */
 	s32 SYSCONF_SaveChanges(void);
+	/* Queue a save for a background thread and return at once. Saves queued while one is being
+	   written are merged into one. The status is SYSCONF_SAVE_BUSY until it completes, then its result;
+	   the callback, if set, gets the same result on the saver thread. */
+	s32 SYSCONF_SaveChangesAsync(void);
+	void SYSCONF_SetSaveCallback(sysconf_save_cb cb, void *usrdata);
+	s32 SYSCONF_GetSaveStatus(void);
+	s32 SYSCONF_WaitSave(void);
+	/* Read back from NAND what the saves since the last verify wrote, and nothing else, and check it
+	   came out as written. Returns the number of bytes read. A save refuses with SYSCONF_EMODIFIED
+	   to overwrite blocks that something else changed since SYSCONF_Init. */
+	s32 SYSCONF_VerifySaved(void);
 	s32 SYSCONF_Set(const char *name, const void *value, u32 length);
+	s32 SYSCONF_SetTxt(const char *name, const char *value);
+	s32 SYSCONF_SetTxtPlain(const char *text, u32 length);
+	/* Change the layout of the SYSCONF image itself */
+	s32 SYSCONF_Add(const char *name, u8 type, const void *value, u32 length);
+	s32 SYSCONF_Resize(const char *name, u32 length);
+	s32 SYSCONF_Remove(const char *name);
+
+	/*
+	 * Deltas carry SYSCONF changes by entry name, so one made from two images of one console
+	 * applies to another whose entries sit elsewhere. Everything is big-endian:
+	 *
+	 *   "SCdl", u16 record count, u32 FNV-1a of the records, u32 FNV-1a of the result
+	 *   each record: u8 SYSCONF_DELTA_* operation, u8 entry type, u8 name length, name,
+	 *                u16 old length, old value, u16 new length, new value
+	 *
+	 * Values are as SYSCONF stores them. A set has both, an add only the new value and a remove
+	 * only the old; a set that changes an array's length resizes it. The result hash runs over each
+	 * record's name followed, unless it is a remove, by the type byte and new value.
+	 * Applying checks the records hash, then each record's old value (an add's entry must not be
+	 * there yet) as it goes, then the result hash. If anything fails, SYSCONF is left as it was.
+	 * Returns the number of records applied; save as after any set.
+	 */
+	s32 SYSCONF_ApplyDelta(const void *delta, u32 length);
+
+	/* Transactions: stage any number of sets, then write each file once and verify it.
+	   Other threads' sets wait until the transaction is committed or aborted.
+	   A commit that fails after writing a file ends the transaction with SYSCONF_ECOMMITTED instead
+	   of leaving it to abort; memory then matches NAND, with only the files that were written changed. */
+	s32 SYSCONF_BeginTransaction(void);
+	s32 SYSCONF_AbortTransaction(void);
+	s32 SYSCONF_CommitTransaction(void);
 
 	s32 SYSCONF_SetShutdownMode(u8 value);
 	s32 SYSCONF_SetIdleLedMode(u8 value);
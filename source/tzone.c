@@ -0,0 +1,100 @@
+#include "tzone.h"
+
+// Unix time of 2000-01-01 00:00 UTC, which the table's times count from
+#define TZONE_TABLE_EPOCH 946684800ll
+// No zone is further than this from UTC, so a local time is within it of its UTC time
+#define TZONE_MAX_OFFSET (16 * 3600)
+
+// Generated by tzgen into tzdata.c
+extern const u32 __tzone_count;
+extern const char *const __tzone_names[];
+extern const u16 __tzone_first[];  // Each zone's first entry; one more than there are zones
+extern const u32 __tzone_times[];  // When each entry takes effect, in seconds from TZONE_TABLE_EPOCH
+extern const u8 __tzone_info[];    // Quarter hours from UTC in the low 7 bits, bit 7 set for DST
+
+static s32 __TZONE_Offset(u32 entry)
+{
+	return ((s8)(__tzone_info[entry] << 1) >> 1) * 900;
+}
+
+// The entry in effect at t; each zone's first starts at 0, so anything earlier gets that one too
+static u32 __TZONE_Find(u32 zone, s64 t)
+{
+	u32 lo = __tzone_first[zone], hi = __tzone_first[zone + 1];
+
+	while (hi - lo > 1)
+	{
+		u32 mid = lo + (hi - lo) / 2;
+		if (__tzone_times[mid] <= t)
+			lo = mid;
+		else
+			hi = mid;
+	}
+	return lo;
+}
+
+// Whether t falls within the entry's time, up to the next one in the zone
+static BOOL __TZONE_Covers(u32 zone, u32 entry, s64 t)
+{
+	if (entry > __tzone_first[zone] && t < __tzone_times[entry])
+		return FALSE;
+	return entry + 1 == __tzone_first[zone + 1] || t < __tzone_times[entry + 1];
+}
+
+u32 TZONE_GetCount(void)
+{
+	return __tzone_count;
+}
+
+const char *TZONE_GetName(u32 zone)
+{
+	if (zone >= __tzone_count)
+		return NULL;
+	return __tzone_names[zone];
+}
+
+s32 TZONE_GetOffset(u32 zone, s64 utc, s32 *offset, BOOL *dst)
+{
+	u32 entry;
+
+	if (zone >= __tzone_count)
+		return TZONE_EZONE;
+
+	entry = __TZONE_Find(zone, utc - TZONE_TABLE_EPOCH);
+	if (offset)
+		*offset = __TZONE_Offset(entry);
+	if (dst)
+		*dst = (__tzone_info[entry] & 0x80) != 0;
+	return TZONE_ERR_OK;
+}
+
+s32 TZONE_ToUTC(u32 zone, s64 local, s64 *utc)
+{
+	s64 t = local - TZONE_TABLE_EPOCH;
+	u32 entry, last;
+	s64 skipped = t;
+
+	if (zone >= __tzone_count)
+		return TZONE_EZONE;
+
+	// Every entry whose offset could turn local into a time it covers, in order, so the first match
+	// is the earlier one when the clocks go back
+	entry = __TZONE_Find(zone, t - TZONE_MAX_OFFSET);
+	last = __TZONE_Find(zone, t + TZONE_MAX_OFFSET);
+	for (; entry <= last; entry++)
+	{
+		s64 candidate = t - __TZONE_Offset(entry);
+
+		if (__TZONE_Covers(zone, entry, candidate))
+		{
+			*utc = candidate + TZONE_TABLE_EPOCH;
+			return TZONE_ERR_OK;
+		}
+		// None covers a time the clocks skip; carry on from the offset before the skip
+		if (entry == __tzone_first[zone] || candidate >= __tzone_times[entry])
+			skipped = candidate;
+	}
+
+	*utc = skipped + TZONE_TABLE_EPOCH;
+	return TZONE_ERR_OK;
+}
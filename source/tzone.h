@@ -0,0 +1,34 @@
+#ifndef __TZONE_H__
+#define __TZONE_H__
+
+#include <gctypes.h>
+
+#define TZONE_EZONE -0x6301
+#define TZONE_ERR_OK 0
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif /* __cplusplus */
+
+	/*
+	 * Time zones from the table tzgen builds out of tzdata (zones listed in tzzones.txt).
+	 * It covers 2000 to 2035; before that the first offset applies and after it the last.
+	 * Times are Unix seconds. The console itself has no time zone: its clock is whatever IPL.CB makes it.
+	 */
+
+	/* Number of zones in the table */
+	u32 TZONE_GetCount(void);
+	/* tzdata name of a zone, such as "Europe/Berlin"; NULL past the end of the table */
+	const char *TZONE_GetName(u32 zone);
+	/* Offset from UTC in seconds in effect at utc, and whether that is daylight saving time */
+	s32 TZONE_GetOffset(u32 zone, s64 utc, s32 *offset, BOOL *dst);
+	/* The UTC time the zone's clocks show local at. A local time skipped by a change to DST is
+	   taken as the same distance past the change; one repeated by the change back is taken the first time */
+	s32 TZONE_ToUTC(u32 zone, s64 local, s64 *utc);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif
@@ -1,47 +1,127 @@
 #include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <time.h>
 
+#include <fat.h>
+#include <ogc/lwp_watchdog.h>
 #include <wiiuse/wpad.h>
 
+#include "footprint.h"
+#include "platbench.h"
+#include "profile.h"
+#include "provision.h"
+#include "rtcclock.h"
+#include "sntp.h"
 #include "sysconf.h"
+#include "tzone.h"
 
 // Unix Epoch 1970-01-01 00:00
 // Gamecube Epoch 2000-01-01 00:00
 #define UNIX_EPOCH_TO_GC_EPOCH_DELTA 946684800ull
+// 2035-12-31 23:59:59 in Gamecube Epoch seconds, the latest the System Menu accepts
+#define GC_EPOCH_LATEST 1136073599ll
 
-extern u32 __SYS_GetRTC(u32 *gctime);
+#define PROVISION_PROFILE_PATH "sd:/wiirtc/profile.txt"
+#define EXPORT_JSON_PATH "sd:/wiirtc/sysconf.json"
+#define EXPORT_PACKED_PATH "sd:/wiirtc/sysconf.bin"
+#define MEMORY_REPORT_PATH "sd:/wiirtc/memory.txt"
+#define PLATBENCH_HISTOGRAM_PATH "sd:/wiirtc/platform.csv"
+#define PLATBENCH_SUMMARY_PATH "sd:/wiirtc/platform-summary.csv"
 
 void *initialise();
 int daysInMonth(int month, int year);
+s32 exportSettings(const char *path, s32 (*export)(FILE *fp), long *size);
+void printZone(s32 zone);
+void writeMemoryReport(void);
+void formatShift(char *buf, size_t size, s32 shift, int unit);
+s32 queueBiasSave(u32 newBias, u32 rtc, u64 edgeTicks, u32 windowUs);
+void syncClock(const char *server, u32 *bias);
+void applyDelta(const char *path);
+void runPlatformBench(BOOL sdAvailable);
 
 static void *xfb = NULL;
 GXRModeObj *rmode = NULL;
+static provision_report provisionReport;
+
+// Filled in on the saver thread once a queued save has gone out
+static volatile BOOL saveDone = FALSE;
+static volatile s32 saveResult;
+static volatile u64 saveDoneTicks;
+
+// What the last queued save wrote, for reporting once it completes
+static u32 savedRTC = 0;
+static u32 savedBias = 0;
+static u64 savedEdgeTicks = 0;
+static u32 savedEdgeWindowUs = 0;
+
+static void saveFinished(s32 result, void *usrdata) {
+	saveResult = result;
+	saveDoneTicks = gettime();
+	saveDone = TRUE;
+}
 
 int main(int argc, char **argv) {
 	int retVal;
 
+	// --partial reads IPL.CB alone out of SYSCONF rather than all 16 KiB of it, and no setting.txt,
+	// for when the clock is all that is being set; the profile, exports and deltas need the rest
+	BOOL partialLoad = FALSE;
+	for (int i = 1; i < argc; i++) if (!strcmp(argv[i], "--partial")) partialLoad = TRUE;
+
+	u64 loadStart = gettime();
+	if (partialLoad) {
+		static const char *const clockKeys[] = { "IPL.CB" };
+		retVal = SYSCONF_InitPartial(clockKeys, 1);
+	} else {
+		// Start reading SYSCONF and setting.txt now; IOS works on them while the video comes up
+		retVal = SYSCONF_InitBegin();
+	}
+	u32 loadUs = ticks_to_microsecs(diff_ticks(loadStart, gettime()));
+
 	xfb = initialise();
 
 	printf ("\nRTC time setter\n");
+	if (partialLoad && retVal >= 0) printf("Read IPL.CB alone from SYSCONF in %u us\n", loadUs);
 
-	retVal = SYSCONF_Init();
+	if (retVal >= 0) retVal = SYSCONF_InitFinish();
 	if (retVal < 0) {
 		printf("Failed to init sysconf and settings.txt. Err: %d\n", retVal);
 		exit(1);
 	}
+	SYSCONF_SetSaveCallback(saveFinished, NULL);
+
+	BOOL sdAvailable = fatInitDefault();
+	BOOL allSettings = sdAvailable && !partialLoad;
+
+	// --memory (an <arg> in meta.xml) writes what wiirtc held in memory to SD on the way out;
+	// --platform-bench times the console itself, --delta <file> applies a SYSCONF delta and
+	// --sntp <server> sets the clock from that time server, in that order, before anything else
+	const char *sntpServer = NULL, *deltaPath = NULL;
+	BOOL platformBench = FALSE;
+	for (int i = 1; i < argc; i++) {
+		if (!strcmp(argv[i], "--memory") && sdAvailable) atexit(writeMemoryReport);
+		else if (!strcmp(argv[i], "--platform-bench")) platformBench = TRUE;
+		else if (!strcmp(argv[i], "--sntp") && i + 1 < argc) sntpServer = argv[++i];
+		else if (!strcmp(argv[i], "--delta") && i + 1 < argc) deltaPath = argv[++i];
+	}
+	if (platformBench) runPlatformBench(sdAvailable);
+	if (deltaPath && partialLoad) printf("Not applying %s: --partial loads too little of SYSCONF for a delta\n", deltaPath);
+	else if (deltaPath) applyDelta(deltaPath);
 
 	printf("\n");
 
-	uint32_t systemRTC;
-
-	retVal = __SYS_GetRTC(&systemRTC);
-	if (retVal == 0) {
+	// Anchor the RTC to the timebase once; the preview below ticks from the timebase alone after this
+	retVal = RTCCLOCK_Init();
+	if (retVal < 0) {
 		printf("Failed to get RTC. Err: %d. Aborting!\n", retVal);
 		exit(1);
 	}
 
+	uint32_t systemRTC;
+	uint32_t shownRTC = 0;
+
 	u32 bias;
 
 	retVal = SYSCONF_GetCounterBias(&bias);
@@ -50,19 +130,38 @@ int main(int argc, char **argv) {
 		exit(1);
 	}
 
-	uint64_t localTime = systemRTC + bias + UNIX_EPOCH_TO_GC_EPOCH_DELTA;
+	if (sntpServer) syncClock(sntpServer, &bias);
+
+	// The proposed time is kept relative to the RTC, so it keeps ticking while the user edits it
+	u32 proposedBias = bias;
+	uint64_t localTime;
+	s32 zone = -1; // Time zone the time is entered in, or -1 to take the console's clock as it is
+	s32 zoneOffset = 0;
+	BOOL zoneDst = FALSE;
+	char zoneStr[24] = "";
 	s32 selectedField = 0; // 0-5 -- hour, minute, second, month, day, year
+	// Shift mode adds a signed number of seconds straight to IPL.CB instead of editing a date
+	BOOL shiftMode = FALSE;
+	s32 shift = 0;
+	int shiftUnit = 1; // 0-3 -- days, hours, minutes, seconds
+	static const s32 shiftSteps[4] = { 86400, 3600, 60, 1 };
+	char shiftStr[48];
 	uint32_t buttonsDown;
 	u32 buttonsDownGC;
 	BOOL timeDirty = TRUE;
 	char timeStr[80];
-	struct tm *cTime = localtime((time_t *) &localTime);
+	struct tm *cTime = NULL;
 
 	printf("Use left and right button to select field, up and down to adjust field\nPress A to write time to system config\n");
+	printf("Press + or - (R or L) to enter the time in another time zone\n");
+	printf("Press 1 (X) to shift the clock by days, hours, minutes or seconds instead\n");
+	if (allSettings) printf("Press B to apply the provisioning profile at %s\n", PROVISION_PROFILE_PATH);
+	if (allSettings) printf("Press 2 (Y) to export every setting to %s and .bin\n", EXPORT_JSON_PATH);
 
 	while (TRUE) {
 		VIDEO_WaitVSync();
 
+		PROFILE_Enter(PROFILE_INPUT);
 		WPAD_ScanPads();
 		buttonsDown = WPAD_ButtonsDown(0);
 		PAD_ScanPads();
@@ -71,16 +170,43 @@ int main(int argc, char **argv) {
 		// Separate checks just to make the text nicer
 		if (buttonsDown & WPAD_BUTTON_HOME) {
 			printf("\nHome button pressed. Exiting...\n");
+			SYSCONF_WaitSave(); // Don't cut a background save short
 			exit(0);
 		}
 		else if (buttonsDownGC & PAD_BUTTON_START) {
 			printf("\nStart button pressed. Exiting...\n");
+			SYSCONF_WaitSave();
 			exit(0);
 		}
 
+		PROFILE_Enter(PROFILE_FORMAT);
+		retVal = RTCCLOCK_Now(&systemRTC, NULL);
+		if (retVal < 0) {
+			printf("\nFailed to get RTC. Err: %d. Aborting!\n", retVal);
+			exit(1);
+		}
+
+		// The RTC moved on a second, so the preview does too
+		if (systemRTC != shownRTC) timeDirty = TRUE;
+
 		if (timeDirty) {
+			localTime = systemRTC + proposedBias + UNIX_EPOCH_TO_GC_EPOCH_DELTA;
+
+			// With a zone picked, the console's clock is UTC and what is shown and edited is that zone's time.
+			// localtime does no conversion of its own on the console, it just splits the seconds up
+			if (zone >= 0) {
+				TZONE_GetOffset(zone, localTime, &zoneOffset, &zoneDst);
+				localTime += zoneOffset;
+				sprintf(zoneStr, " UTC%c%02d:%02d%s", zoneOffset < 0 ? '-' : '+', abs(zoneOffset) / 3600, abs(zoneOffset) / 60 % 60, zoneDst ? " DST" : "");
+			}
+			cTime = localtime((time_t *) &localTime);
+			shownRTC = systemRTC;
+
 			// Hour (24) : Minute : Second Month Day Year
-			switch (selectedField) {
+			if (shiftMode) {
+				formatShift(shiftStr, sizeof(shiftStr), shift, shiftUnit);
+				strftime(timeStr, sizeof(timeStr), "%H:%M:%S %B %d %Y", cTime);
+			} else switch (selectedField) {
 				case 0: // Hour
 					strftime(timeStr, sizeof(timeStr), "\e[0;32m%H\e[0m:%M:%S %B %d %Y", cTime);
 					break;
@@ -100,12 +226,47 @@ int main(int argc, char **argv) {
 					strftime(timeStr, sizeof(timeStr), "%H:%M:%S %B %d \e[0;32m%Y\e[0m", cTime);
 			}
 
-			printf("\rProposed RTC system time: %s   ", timeStr);
+			PROFILE_Enter(PROFILE_RENDER);
+			if (shiftMode) printf("\rShift by %s to: %s%s   ", shiftStr, timeStr, zoneStr);
+			else printf("\rProposed RTC system time: %s%s   ", timeStr, zoneStr);
 			fflush(stdout);
 
 			timeDirty = FALSE;
 		}
 
+		// The save runs on its own thread while this loop keeps drawing; report it when it lands
+		if (saveDone) {
+			saveDone = FALSE;
+			PROFILE_Enter(PROFILE_SAVE);
+
+			// Only what the save wrote is read back from NAND, not the whole file
+			if (saveResult >= 0) {
+				retVal = SYSCONF_VerifySaved();
+				if (retVal >= 0) printf("\nRead back %d bytes from NAND and they match what was written\n", retVal);
+				else saveResult = retVal;
+			}
+
+			if (saveResult == SYSCONF_EMODIFIED) {
+				printf("\nSYSCONF was changed by something else since this program started; not overwriting it\n");
+			} else if (saveResult < 0) {
+				printf("\nFailed to save updated counter bias. Err: %d\n", saveResult);
+			} else {
+				printf("Successfully saved counter bias change\n");
+
+				// The bias is whole seconds, so the new time is exact from the tick onward; what is left is
+				// how precisely the anchor located the tick and how long after it the NAND write finished
+				printf("New time counts from the RTC tick (within %u us), saved %u ms after it\n",
+					savedEdgeWindowUs, (u32) ticks_to_millisecs(diff_ticks(savedEdgeTicks, saveDoneTicks)));
+
+				localTime = savedRTC + savedBias + UNIX_EPOCH_TO_GC_EPOCH_DELTA;
+				strftime(timeStr, sizeof(timeStr), "%H:%M:%S %B %d %Y", localtime((time_t *) &localTime));
+
+				printf("Time successfully updated to: %s\n", timeStr);
+				printf("You may now terminate this program by pressing home or start\n(or continue to adjust the time)\n");
+			}
+			timeDirty = TRUE;
+		}
+
 		// Don't proceed if no buttons are being held
 		if (!buttonsDown && !buttonsDownGC) {
 			continue;
@@ -113,19 +274,37 @@ int main(int argc, char **argv) {
 
 		// Something was pressed, so update the time preview at the next opportunity
 		timeDirty = TRUE;
+		PROFILE_Enter(PROFILE_INPUT);
 
 		// Left/right just change options
 		if (buttonsDown & WPAD_BUTTON_LEFT || buttonsDownGC & PAD_BUTTON_LEFT) {
-			if (selectedField > 0) selectedField--;
+			if (shiftMode) { if (shiftUnit > 0) shiftUnit--; }
+			else if (selectedField > 0) selectedField--;
 
 		} else if (buttonsDown & WPAD_BUTTON_RIGHT || buttonsDownGC & PAD_BUTTON_RIGHT) {
-			if (selectedField < 5) selectedField++;
+			if (shiftMode) { if (shiftUnit < 3) shiftUnit++; }
+			else if (selectedField < 5) selectedField++;
 
 		// Up/down set the current option
 		} else if (buttonsDown & WPAD_BUTTON_UP || buttonsDownGC & PAD_BUTTON_UP || buttonsDown & WPAD_BUTTON_DOWN || buttonsDownGC & PAD_BUTTON_DOWN) {
 			BOOL isIncrement = (buttonsDown & WPAD_BUTTON_UP || buttonsDownGC & PAD_BUTTON_UP); // Store whether this is up or down for repeated use
 			int *field; // Pointer to the exact part of tm we are manipulating
 
+			// A shift is plain arithmetic on IPL.CB. The console adds it to the RTC modulo 2^32, so what
+			// can overflow is the time that makes, which has to stay within what the System Menu takes
+			if (shiftMode) {
+				s64 step = isIncrement ? shiftSteps[shiftUnit] : -shiftSteps[shiftUnit];
+				s64 shifted = (s64) (u32) (shownRTC + bias) + shift + step;
+
+				if (shifted < 0 || shifted > GC_EPOCH_LATEST) {
+					printf("\nThat would take the clock past %s\n", shifted < 0 ? "the start of 2000" : "the end of 2035");
+					continue;
+				}
+				shift += step;
+				proposedBias = bias + (u32) shift;
+				continue;
+			}
+
 			// Set the pointer, then check to make sure we are not trying something invalid
 			switch (selectedField) {
 				case 0: // Hour
@@ -166,49 +345,102 @@ int main(int argc, char **argv) {
 				if (cTime->tm_mday > maxDays) cTime->tm_mday = maxDays;
 			}
 
+			s64 enteredTime = mktime(cTime);
+			if (zone >= 0) TZONE_ToUTC(zone, enteredTime, &enteredTime);
+
+			proposedBias = enteredTime - shownRTC - UNIX_EPOCH_TO_GC_EPOCH_DELTA;
+
+		// +/- step through the time zones; the time itself stays put and is just shown in the new zone
+		} else if (buttonsDown & (WPAD_BUTTON_PLUS | WPAD_BUTTON_MINUS) || buttonsDownGC & (PAD_TRIGGER_R | PAD_TRIGGER_L)) {
+			if (buttonsDown & WPAD_BUTTON_PLUS || buttonsDownGC & PAD_TRIGGER_R) {
+				if (++zone >= (s32) TZONE_GetCount()) zone = -1;
+			} else {
+				if (--zone < -1) zone = TZONE_GetCount() - 1;
+			}
+
+			if (zone < 0) zoneStr[0] = '\0';
+			printZone(zone);
+
 		} else if (buttonsDown & WPAD_BUTTON_A || buttonsDownGC & PAD_BUTTON_A) {
+			PROFILE_Enter(PROFILE_SAVE);
 			printf("\nWriting new time (bias) to sysconf\n");
 
-			retVal = __SYS_GetRTC(&systemRTC);
-			if (retVal == 0) {
-				printf("Failed to get RTC. Err: %d. Aborting!\n", retVal);
+			// The proposed bias is relative to the RTC, so it is exact from the tick that began the
+			// shown second and there's no waiting for the next one; the anchor says where that tick was
+			u64 edgeTicks;
+			u32 edgeWindowUs;
+			retVal = RTCCLOCK_TickEdge(systemRTC, &edgeTicks, &edgeWindowUs);
+			if (retVal < 0) {
+				printf("Failed to find the RTC second boundary. Err: %d. Aborting!\n", retVal);
 				exit(1);
 			}
 
-			bias = mktime(cTime) - systemRTC - UNIX_EPOCH_TO_GC_EPOCH_DELTA;
+			bias = proposedBias;
+			shift = 0; // Further shifts start from what was just written
+			queueBiasSave(bias, systemRTC, edgeTicks, edgeWindowUs);
 
-			retVal = SYSCONF_SetCounterBias(bias);
-			if (retVal < 0) {
-				printf("Failed to set counter bias. Err: %d. Aborting!\n", retVal);
-				exit(1);
+		} else if (allSettings && (buttonsDown & WPAD_BUTTON_B || buttonsDownGC & PAD_BUTTON_B)) {
+			PROFILE_Enter(PROFILE_SAVE);
+			printf("\nApplying provisioning profile %s\n", PROVISION_PROFILE_PATH);
+
+			retVal = PROVISION_Apply(PROVISION_PROFILE_PATH, &provisionReport);
+
+			for (int i = 0; i < provisionReport.count; i++) {
+				provision_key *key = &provisionReport.keys[i];
+
+				if (key->result < 0) printf("  %-8s = %-24s failed. Err: %d\n", key->name, key->value, key->result);
+				else printf("  %-8s = %-24s %s\n", key->name, key->value, retVal < 0 && retVal != SYSCONF_ECOMMITTED ? "not written" : "ok");
 			}
 
-			retVal = SYSCONF_SaveChanges();
-			if (retVal != 0) {
-				printf("Failed to save updated counter bias. Err: %d\n", retVal);
+			if (retVal == SYSCONF_ECOMMITTED) {
+				printf("Profile partly applied; only the keys marked ok are saved. Err: %d\n", retVal);
+			} else if (retVal < 0) {
+				printf("Profile not applied. Err: %d\n", retVal);
+			} else {
+				printf("Profile applied and verified in %u ms\n", provisionReport.elapsedMs);
 			}
-			printf("Successfully saved counter bias change\n");
 
-			printf("Checking time written (counter bias) value\n");
-			u32 biasCheck = 0;
-			retVal = SYSCONF_GetCounterBias(&biasCheck);
+			// The profile may have set IPL.CB, so pick up whatever is there now
+			retVal = SYSCONF_GetCounterBias(&bias);
 			if (retVal < 0) {
 				printf("Failed to get counter bias. Err: %d. Aborting!\n", retVal);
 				exit(1);
 			}
-
-			if (bias != biasCheck) {
-				printf("Failed to verify written bias value. Got %u, expected %u\n", biasCheck, bias);
-				exit(1);
+			proposedBias = bias;
+			shift = 0;
+
+		// 1/X switches between editing the date and shifting IPL.CB; a shift starts from what is saved
+		} else if (buttonsDown & WPAD_BUTTON_1 || buttonsDownGC & PAD_BUTTON_X) {
+			shiftMode = !shiftMode;
+			if (shiftMode) {
+				retVal = SYSCONF_GetCounterBias(&bias);
+				if (retVal < 0) {
+					printf("\nFailed to get counter bias. Err: %d. Aborting!\n", retVal);
+					exit(1);
+				}
+				shift = 0;
+				proposedBias = bias;
+				printf("\nShifting the clock: left and right pick the unit, up and down add or take one\n");
+				printf("Press A to write it, or 1 (X) to go back to setting the date and time\n");
+			} else {
+				printf("\nSetting the date and time\n");
 			}
 
-			// Technically redundant to recalculate, but affirms to the user that the time is set as expected
-			localTime = systemRTC + bias + UNIX_EPOCH_TO_GC_EPOCH_DELTA;
-			cTime = localtime((time_t *) &localTime);
-			strftime(timeStr, sizeof(timeStr), "%H:%M:%S %B %d %Y", cTime);
+		} else if (allSettings && (buttonsDown & WPAD_BUTTON_2 || buttonsDownGC & PAD_BUTTON_Y)) {
+			PROFILE_Enter(PROFILE_SAVE);
+			printf("\nExporting settings to SD\n");
+
+			u64 exportStart = gettime();
+			long jsonSize = 0, packedSize = 0;
+			retVal = exportSettings(EXPORT_JSON_PATH, SYSCONF_ExportJSON, &jsonSize);
+			if (retVal >= 0) retVal = exportSettings(EXPORT_PACKED_PATH, SYSCONF_ExportPacked, &packedSize);
 
-			printf("Time successfully updated to: %s\n", timeStr);
-			printf("You may now terminate this program by pressing home or start\n(or continue to adjust the time)\n");
+			if (retVal < 0) {
+				printf("Failed to export settings. Err: %d\n", retVal);
+			} else {
+				printf("Exported %d settings in %u ms: %ld bytes of JSON, %ld packed\n", retVal,
+					(u32) ticks_to_millisecs(diff_ticks(exportStart, gettime())), jsonSize, packedSize);
+			}
 		}
 	}
 
@@ -228,6 +460,8 @@ void *initialise() {
 
 	rmode = VIDEO_GetPreferredMode(NULL);
 	framebuffer = MEM_K0_TO_K1(SYS_AllocateFramebuffer(rmode));
+	FOOTPRINT_Register("wiirtc", "framebuffer", framebuffer, VIDEO_GetFrameBufferSize(rmode), TRUE);
+	FOOTPRINT_Register("wiirtc", "provisioning report", &provisionReport, sizeof(provisionReport), FALSE);
 	console_init(framebuffer,20,20,rmode->fbWidth,rmode->xfbHeight,rmode->fbWidth*VI_DISPLAY_PIX_SZ);
 
 	VIDEO_Configure(rmode);
@@ -242,6 +476,185 @@ void *initialise() {
 	return framebuffer;
 }
 //---------------------------------------------------------------------------------
+void printZone(s32 zone) {
+//---------------------------------------------------------------------------------
+
+	if (zone < 0) printf("\nEntering the console's own time\n");
+	else printf("\nEntering %s time, the console is set to UTC\n", TZONE_GetName(zone));
+}
+//---------------------------------------------------------------------------------
+s32 exportSettings(const char *path, s32 (*export)(FILE *fp), long *size) {
+//---------------------------------------------------------------------------------
+
+	FILE *fp = fopen(path, "wb");
+	if (!fp) return SYSCONF_EBADWRITE;
+
+	s32 ret = export(fp);
+	*size = ftell(fp);
+	if (fclose(fp) != 0 && ret >= 0) ret = SYSCONF_EBADWRITE;
+	return ret;
+}
+//---------------------------------------------------------------------------------
+void formatShift(char *buf, size_t size, s32 shift, int unit) {
+//---------------------------------------------------------------------------------
+
+	u32 left = abs(shift);
+	u32 parts[4] = { left / 86400, left / 3600 % 24, left / 60 % 60, left % 60 };
+	const char *on[4] = { "", "", "", "" }, *off[4] = { "", "", "", "" };
+
+	// The unit up and down change is highlighted, like the selected field of the date
+	on[unit] = "\e[0;32m";
+	off[unit] = "\e[0m";
+	snprintf(buf, size, "%c%s%ud%s %s%02u%s:%s%02u%s:%s%02u%s", shift < 0 ? '-' : '+',
+		on[0], parts[0], off[0], on[1], parts[1], off[1], on[2], parts[2], off[2], on[3], parts[3], off[3]);
+}
+//---------------------------------------------------------------------------------
+s32 queueBiasSave(u32 newBias, u32 rtc, u64 edgeTicks, u32 windowUs) {
+//---------------------------------------------------------------------------------
+
+	s32 ret = SYSCONF_SetCounterBias(newBias);
+	if (ret < 0) {
+		printf("Failed to set counter bias. Err: %d. Aborting!\n", ret);
+		exit(1);
+	}
+
+	// The NAND write goes out on the saver thread; the confirmation shows up in a later frame
+	ret = SYSCONF_SaveChangesAsync();
+	if (ret < 0) {
+		printf("Failed to save updated counter bias. Err: %d\n", ret);
+		return ret;
+	}
+
+	printf("Saving counter bias change...\n");
+	savedRTC = rtc;
+	savedBias = newBias;
+	savedEdgeTicks = edgeTicks;
+	savedEdgeWindowUs = windowUs;
+	return ret;
+}
+//---------------------------------------------------------------------------------
+void syncClock(const char *server, u32 *bias) {
+//---------------------------------------------------------------------------------
+
+	sntp_result result;
+	u64 start = gettime();
+
+	printf("Setting the clock from %s\n", server);
+
+	s32 ret = SNTP_Init();
+	if (ret >= 0) ret = SNTP_Query(server, &result);
+	if (ret < 0) {
+		printf("Failed to get the time from %s. Err: %d\n", server, ret);
+		return;
+	}
+	printf("Kept the %u fastest of %u replies to %u requests: round trip %u us, offsets %u us apart, stratum %u\n",
+		result.kept, result.received, result.sent, result.delayUs, result.spreadUs, result.stratum);
+
+	// Like A, the bias is worked out for the RTC second under way. The anchor puts the tick that began
+	// it within the window before edgeTicks, so the middle of that is taken as the moment it began
+	u32 rtc, windowUs;
+	u64 edgeTicks;
+	ret = RTCCLOCK_Now(&rtc, NULL);
+	if (ret >= 0) ret = RTCCLOCK_TickEdge(rtc, &edgeTicks, &windowUs);
+	if (ret < 0) {
+		printf("Failed to find the RTC second boundary. Err: %d. Aborting!\n", ret);
+		exit(1);
+	}
+
+	s64 tickUs = (s64) ticks_to_microsecs(edgeTicks - microsecs_to_ticks(windowUs / 2)) + result.offsetUs
+		- (s64) UNIX_EPOCH_TO_GC_EPOCH_DELTA * 1000000;
+	s64 secs = (tickUs + 500000) / 1000000;
+	if (tickUs < 0 || secs > GC_EPOCH_LATEST) {
+		printf("The server's time is outside 2000 to 2035; not setting it\n");
+		return;
+	}
+
+	// IPL.CB only holds whole seconds, so the RTC's own phase is as close as the clock can get.
+	// The server's time is rounded to the nearest second at the tick, leaving at most half of one
+	u32 elapsedMs = ticks_to_millisecs(diff_ticks(start, gettime()));
+	*bias = (u32) secs - rtc;
+	printf("Clock will be %+.1f ms off the server, give or take %u us; synchronised in %u ms\n",
+		(secs * 1000000 - tickUs) / 1000.0, windowUs / 2 + result.spreadUs + result.delayUs / 2, elapsedMs);
+	PROFILE_Sync(result.offsetUs, elapsedMs);
+	queueBiasSave(*bias, rtc, edgeTicks, windowUs);
+}
+//---------------------------------------------------------------------------------
+void applyDelta(const char *path) {
+//---------------------------------------------------------------------------------
+
+	u8 delta[1024]; // Deltas of a few settings are tens of bytes; 1 KiB is a lot of changes
+	size_t size;
+	FILE *fp = fopen(path, "rb");
+	if (!fp) {
+		printf("Can't open %s\n", path);
+		return;
+	}
+	size = fread(delta, 1, sizeof(delta), fp);
+	if (!feof(fp)) size = 0;
+	fclose(fp);
+	if (!size) {
+		printf("%s is empty or bigger than %u bytes\n", path, (u32) sizeof(delta));
+		return;
+	}
+
+	u64 start = gettime();
+	s32 ret = SYSCONF_ApplyDelta(delta, size);
+	u64 applied = gettime();
+	if (ret == SYSCONF_EGUARD) {
+		printf("Delta %s not applied: this console's settings aren't the ones it was made from\n", path);
+		return;
+	} else if (ret < 0) {
+		printf("Delta %s not applied. Err: %d\n", path, ret);
+		return;
+	}
+	printf("Applied %d changes from a %u byte delta in %u us\n", ret, (u32) size, (u32) ticks_to_microsecs(diff_ticks(start, applied)));
+
+	// Straight to NAND and back, before anything else can touch SYSCONF
+	ret = SYSCONF_SaveChanges();
+	if (ret >= 0) ret = SYSCONF_VerifySaved();
+	if (ret < 0) {
+		printf("Failed to save the delta. Err: %d\n", ret);
+		return;
+	}
+	printf("Saved and read back %d bytes in %u ms\n", ret, (u32) ticks_to_millisecs(diff_ticks(applied, gettime())));
+}
+//---------------------------------------------------------------------------------
+void runPlatformBench(BOOL sdAvailable) {
+//---------------------------------------------------------------------------------
+
+	platbench_report report;
+
+	printf("Timing IPC, RTC, vsync, controllers and text for a few seconds\n");
+	s32 ret = PLATBENCH_Run(sdAvailable ? PLATBENCH_HISTOGRAM_PATH : NULL, sdAvailable ? PLATBENCH_SUMMARY_PATH : NULL, &report);
+	if (ret < 0 && !report.results[0].name) {
+		printf("Platform benchmark failed. Err: %d\n", ret);
+		return;
+	}
+
+	printf("%-12s %10s %10s %10s\n", "ns", "median", "p99", "max");
+	for (int i = 0; i < PLATBENCH_TESTS; i++) {
+		platbench_result *result = &report.results[i];
+
+		printf("%-12s %10u %10u %10u", result->name, result->medianNs, result->p99Ns, result->maxNs);
+		if (result->detailName) printf("  %s %u", result->detailName, result->detail);
+		printf("\n");
+	}
+
+	if (ret < 0) printf("Couldn't write the results to SD. Err: %d\n", ret);
+	else if (sdAvailable) printf("Histograms in %s, summary in %s (%u ms)\n", PLATBENCH_HISTOGRAM_PATH, PLATBENCH_SUMMARY_PATH, report.elapsedMs);
+	else printf("No SD card, so the histograms weren't saved (%u ms)\n", report.elapsedMs);
+}
+//---------------------------------------------------------------------------------
+void writeMemoryReport(void) {
+//---------------------------------------------------------------------------------
+
+	FILE *fp = fopen(MEMORY_REPORT_PATH, "w");
+	if (!fp) return;
+
+	FOOTPRINT_Report(fp);
+	fclose(fp);
+}
+//---------------------------------------------------------------------------------
 int daysInMonth(int month, int year) {
 //---------------------------------------------------------------------------------
 